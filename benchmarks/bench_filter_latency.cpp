@@ -0,0 +1,180 @@
+/*
+ * бенчмарк задержки от публикации отсчета потоком приема до выхода
+ * фильтра: FilterThread, который спит в waitForData(), против старого
+ * цикла с опросом и sleep 10 мс.
+ *
+ * писатель публикует по одному отсчету с заданным интервалом в
+ * BroadcastRingBuffer, как поток приема. фильтр-зонд в потоке фильтра
+ * записывает, сколько прошло с публикации. затем меряется процессорное
+ * время простаивающего потока фильтра.
+ *
+ * запуск: bench_filter_latency [отсчетов] [интервал, мкс]
+ */
+
+#include "../include/core/broadcastringbuffer.h"
+#include "../include/core/datapoint.h"
+#include "../include/filters/ifilter.h"
+#include "../include/processing/filterthread.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// фильтр-зонд: пропускает отсчет как есть и запоминает его задержку.
+// в timestamp писатель кладет номер отсчета
+class LatencyProbeFilter : public IFilter {
+public:
+  explicit LatencyProbeFilter(const std::vector<Clock::time_point> &sendTimes)
+      : m_sendTimes(sendTimes) {
+    m_latencies.reserve(sendTimes.size());
+  }
+
+  DataPoint filter(const DataPoint &input) override {
+    auto now = Clock::now();
+    m_latencies.push_back(
+        std::chrono::duration<double, std::micro>(now -
+                                                  m_sendTimes[input.timestamp])
+            .count());
+    return input;
+  }
+
+  size_t processBlock(const DataPoint *input, size_t count,
+                      DataPoint *output) override {
+    for (size_t i = 0; i < count; ++i) {
+      output[i] = filter(input[i]);
+    }
+    return count;
+  }
+
+  void reset() override { m_latencies.clear(); }
+  bool isReady() const override { return true; }
+  std::string getName() const override { return "LatencyProbe"; }
+  size_t getMemoryUsage() const override { return 0; }
+
+  std::vector<double> &latencies() { return m_latencies; }
+
+private:
+  const std::vector<Clock::time_point> &m_sendTimes;
+  std::vector<double> m_latencies;
+};
+
+// прежний цикл FilterThread: опрос и сон 10 мс, когда данных нет
+class PollingConsumer {
+public:
+  PollingConsumer(IFilter *filter, IBufferReader<DataPoint> *input,
+                  BroadcastRingBuffer<DataPoint> *output)
+      : m_filter(filter), m_input(input), m_output(output), m_running(false) {}
+
+  void start() {
+    m_running = true;
+    m_thread = std::thread([this] {
+      std::vector<DataPoint> block(256);
+      while (m_running.load()) {
+        size_t n = m_input->popBulk(block.data(), block.size());
+        if (n == 0) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+          continue;
+        }
+        for (size_t i = 0; i < n; ++i) {
+          m_output->push(m_filter->filter(block[i]));
+        }
+      }
+    });
+  }
+
+  void stop() {
+    m_running = false;
+    if (m_thread.joinable()) {
+      m_thread.join();
+    }
+  }
+
+private:
+  IFilter *m_filter;
+  IBufferReader<DataPoint> *m_input;
+  BroadcastRingBuffer<DataPoint> *m_output;
+  std::atomic<bool> m_running;
+  std::thread m_thread;
+};
+
+double processCpuMs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return static_cast<double>(ts.tv_sec) * 1e3 +
+         static_cast<double>(ts.tv_nsec) / 1e6;
+}
+
+double percentile(std::vector<double> &sorted, double p) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  size_t index =
+      static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+  return sorted[index];
+}
+
+template <typename Consumer>
+void run(const char *name, size_t samples,
+         std::chrono::microseconds interval) {
+  BroadcastRingBuffer<DataPoint> input(Constants::RAW_STREAM_CAPACITY);
+  BroadcastRingBuffer<DataPoint> output(Constants::FILTER_OUTPUT_CAPACITY);
+  std::vector<Clock::time_point> sendTimes(samples);
+  LatencyProbeFilter probe(sendTimes);
+
+  Consumer consumer(&probe, input.createReader(), &output);
+  consumer.start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  auto next = Clock::now();
+  for (size_t i = 0; i < samples; ++i) {
+    next += interval;
+    std::this_thread::sleep_until(next);
+    sendTimes[i] = Clock::now();
+    input.push(DataPoint(static_cast<uint32_t>(i), 0.0f));
+  }
+
+  // даем дочитать хвост, потом меряем простой без данных
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  double cpuBegin = processCpuMs();
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  double idleCpuMs = processCpuMs() - cpuBegin;
+
+  auto stopBegin = Clock::now();
+  consumer.stop();
+  double stopMs =
+      std::chrono::duration<double, std::milli>(Clock::now() - stopBegin)
+          .count();
+
+  std::vector<double> &latencies = probe.latencies();
+  std::sort(latencies.begin(), latencies.end());
+  std::printf("%-8s %8zu %10.1f %10.1f %10.1f %10.1f %12.2f %10.2f\n", name,
+              latencies.size(), percentile(latencies, 0.5),
+              percentile(latencies, 0.9), percentile(latencies, 0.99),
+              latencies.empty() ? 0.0 : latencies.back(), idleCpuMs, stopMs);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t samples = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+  long intervalUs = argc > 2 ? std::atol(argv[2]) : 1000;
+
+  std::printf("%zu samples, one every %ld us; latency in us\n", samples,
+              intervalUs);
+  std::printf("%-8s %8s %10s %10s %10s %10s %12s %10s\n", "mode", "samples",
+              "p50", "p90", "p99", "max", "idle cpu ms", "stop ms");
+  run<PollingConsumer>("polling", samples,
+                       std::chrono::microseconds(intervalUs));
+  run<FilterThread>("wait", samples, std::chrono::microseconds(intervalUs));
+  return 0;
+}
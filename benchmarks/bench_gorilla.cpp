@@ -0,0 +1,199 @@
+/*
+ * бенчмарк сжатия GorillaEncoder на трассах PID: степень сжатия, бит на
+ * отсчет и скорость кодирования/декодирования в МБ/с несжатых отсчетов
+ * (8 байт на отсчет).
+ *
+ * серии режутся на блоки по SessionRecorder::CHUNK_SAMPLES отсчетов, как
+ * в записи сессии. для скорости каждая серия кодируется и декодируется
+ * несколько раз, берется лучший проход.
+ *
+ * без файла записи трассы моделируются: объект первого порядка под
+ * PID-регулятором с прямоугольным заданием, 1 кГц, отсчеты с шумом и
+ * выбросами (как у PIDemulator), чистый выход объекта и сглаженный
+ * экспоненциальным фильтром.
+ *
+ * запуск: bench_gorilla [файл.pidrec | отсчетов]
+ */
+
+#include "../include/core/datapoint.h"
+#include "../include/storage/gorillacodec.h"
+#include "../include/storage/sessionreader.h"
+#include "../include/storage/sessionrecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int PASSES = 5;
+
+struct Trace {
+  std::string name;
+  std::vector<DataPoint> points;
+};
+
+// трассы замкнутого контура PID с шагом 1 мс
+std::vector<Trace> simulateTraces(size_t samples) {
+  std::mt19937 rng(42);
+  std::normal_distribution<float> noise(0.0f, 1.2f);
+  std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+  std::uniform_int_distribution<int> jitter(-1, 1);
+
+  Trace raw{"Raw", {}};
+  Trace plant{"Plant", {}};
+  Trace smoothed{"Exponential", {}};
+  raw.points.reserve(samples);
+  plant.points.reserve(samples);
+  smoothed.points.reserve(samples);
+
+  const float dt = 0.001f;
+  const float kp = 1.5f, ki = 1.5f, kd = 0.01f;
+  float value = 0.0f, integral = 0.0f, previousError = 0.0f;
+  float filtered = 0.0f;
+  size_t outlierLeft = 0;
+  float outlier = 0.0f;
+
+  for (size_t i = 0; i < samples; ++i) {
+    // задание меняется каждые 5 с
+    const float setpoint = (i / 5000) % 2 == 0 ? 10.0f : -5.0f;
+    const float error = setpoint - value;
+    integral = std::max(-10.0f, std::min(10.0f, integral + error * dt));
+    const float control =
+        kp * error + ki * integral + kd * (error - previousError) / dt;
+    previousError = error;
+    value += (control - value) * dt;
+
+    // выбросы: раз в секунду в среднем, до 500 мс
+    if (outlierLeft == 0 && chance(rng) < 0.001f) {
+      outlierLeft = static_cast<size_t>(chance(rng) * 500.0f);
+      outlier = chance(rng) < 0.5f ? 5.0f : -5.0f;
+    }
+    float measured = value + noise(rng);
+    if (outlierLeft > 0) {
+      measured += outlier;
+      --outlierLeft;
+    }
+    filtered += 0.1f * (measured - filtered);
+
+    // отправитель ставит время в мс, иногда с дрожанием
+    uint32_t timestamp = static_cast<uint32_t>(i);
+    if (i > 0 && chance(rng) < 0.01f) {
+      timestamp += static_cast<uint32_t>(jitter(rng));
+    }
+    raw.points.emplace_back(timestamp, measured);
+    plant.points.emplace_back(timestamp, value);
+    smoothed.points.emplace_back(timestamp, filtered);
+  }
+
+  return {raw, plant, smoothed};
+}
+
+std::vector<Trace> loadTraces(const std::string &path) {
+  SessionReader reader;
+  reader.open(path);
+
+  std::vector<Trace> traces;
+  std::vector<DataPoint> chunk;
+  for (size_t series = 0; series < reader.seriesCount(); ++series) {
+    Trace trace{reader.seriesName(series), {}};
+    for (size_t c = 0; c < reader.chunks(series).size(); ++c) {
+      reader.readChunk(series, c, chunk);
+      trace.points.insert(trace.points.end(), chunk.begin(), chunk.end());
+    }
+    if (!trace.points.empty()) {
+      traces.push_back(std::move(trace));
+    }
+  }
+  return traces;
+}
+
+void measure(const Trace &trace) {
+  using Clock = std::chrono::steady_clock;
+  const size_t block = SessionRecorder::CHUNK_SAMPLES;
+  const size_t count = trace.points.size();
+  const size_t blocks = (count + block - 1) / block;
+
+  std::vector<std::vector<uint8_t>> encoded(blocks);
+  std::vector<DataPoint> decoded(count);
+  double encodeSeconds = 1e30;
+  double decodeSeconds = 1e30;
+
+  for (int pass = 0; pass < PASSES; ++pass) {
+    Clock::time_point started = Clock::now();
+    for (size_t b = 0; b < blocks; ++b) {
+      const size_t first = b * block;
+      GorillaEncoder::encode(trace.points.data() + first,
+                             std::min(block, count - first), encoded[b]);
+    }
+    encodeSeconds = std::min(
+        encodeSeconds,
+        std::chrono::duration<double>(Clock::now() - started).count());
+
+    started = Clock::now();
+    for (size_t b = 0; b < blocks; ++b) {
+      const size_t first = b * block;
+      GorillaDecoder::decode(encoded[b].data(), encoded[b].size(),
+                             std::min(block, count - first),
+                             decoded.data() + first);
+    }
+    decodeSeconds = std::min(
+        decodeSeconds,
+        std::chrono::duration<double>(Clock::now() - started).count());
+  }
+
+  size_t bytes = 0;
+  for (const std::vector<uint8_t> &data : encoded) {
+    bytes += data.size();
+  }
+  const bool exact = std::memcmp(decoded.data(), trace.points.data(),
+                                 count * sizeof(DataPoint)) == 0;
+
+  const double rawBytes = static_cast<double>(count * sizeof(DataPoint));
+  std::printf("%-14s %10zu %10.2f %8.2f %8.2f %10.0f %10.0f%s\n",
+              trace.name.c_str(), count, bytes / 1e6, rawBytes / bytes,
+              8.0 * bytes / count, rawBytes / encodeSeconds / 1e6,
+              rawBytes / decodeSeconds / 1e6, exact ? "" : "  MISMATCH");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string path;
+  size_t samples = 3600000; // час при 1 кГц
+  if (argc > 1) {
+    char *end = nullptr;
+    unsigned long long value = std::strtoull(argv[1], &end, 10);
+    if (end && *end == '\0' && value > 0) {
+      samples = static_cast<size_t>(value);
+    } else {
+      path = argv[1];
+    }
+  }
+
+  std::vector<Trace> traces;
+  try {
+    if (path.empty()) {
+      std::printf("simulated PID traces: %zu samples each\n", samples);
+      traces = simulateTraces(samples);
+    } else {
+      std::printf("recording %s\n", path.c_str());
+      traces = loadTraces(path);
+    }
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+
+  std::printf("%-14s %10s %10s %8s %8s %10s %10s\n", "series", "samples",
+              "MB", "ratio", "bits/pt", "enc MB/s", "dec MB/s");
+  for (const Trace &trace : traces) {
+    measure(trace);
+  }
+  return 0;
+}
@@ -0,0 +1,433 @@
+/*
+ * микробенчмарки горячих мест с результатом в JSON, чтобы сравнивать
+ * релизы между собой:
+ *
+ *   filter/... - каждый IFilter на окнах разного размера: по отсчету
+ *     через IFilter (виртуальный вызов) и через конкретный тип (то, что
+ *     дает "девиртуализация"), блоком processBlock() по 64 и 1024
+ *   ring/...   - ThreadSafeRingBuffer: 1, 2 и 4 писателя push() против
+ *     читателя, который забирает popAll()
+ *   fft/...    - FFT::computeAmplitudeSpectrum от 64 до 65536 точек
+ *   parser/... - ProtocolParser::parseDataPacket (старый пакет) и
+ *     parseDataPacketBatch (полный пакет v2)
+ *
+ * каждый замер калибруется на ~MEASURE_TIME и повторяется REPEATS раз,
+ * в отчет идут лучший и медианный результат в нс на операцию (операция -
+ * отсчет, точка БПФ или пакет, см. unit).
+ *
+ * запуск: bench_micro [файл.json] [подстрока имени]
+ *   по умолчанию пишется bench_micro.json; с подстрокой меряется только
+ *   то, в имени чего она есть (например, "filter/Median")
+ */
+
+#include "../include/core/Constants.h"
+#include "../include/core/datapoint.h"
+#include "../include/core/fft.h"
+#include "../include/core/threadsaferingbuffer.h"
+#include "../include/filters/exponentialfilter.h"
+#include "../include/filters/ifilter.h"
+#include "../include/filters/kalmanfilter.h"
+#include "../include/filters/medianfilter.h"
+#include "../include/filters/movingaveragefilter.h"
+#include "../include/network/protocolparser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int REPEATS = 5;
+constexpr double MEASURE_TIME = 0.1;   // секунд на один повтор
+constexpr double CALIBRATE_TIME = 0.01;
+constexpr size_t SIGNAL_SIZE = 65536;
+constexpr size_t RING_CAPACITY = 4096;
+constexpr size_t RING_PUSHES = 1 << 21; // всего на всех писателей
+
+// результаты складываются сюда, чтобы компилятор не выкинул работу
+volatile double g_sink = 0.0;
+
+struct Result {
+  std::string name;
+  std::string unit;
+  uint64_t iterations; // операций в одном повторе
+  double best;         // нс на операцию
+  double median;
+  std::string extra;   // дополнительные поля JSON, уже готовые
+};
+
+/**
+ * @brief сколько секунд занимают calls вызовов body
+ */
+template <typename Body> double timeCalls(Body &body, uint64_t calls) {
+  const Clock::time_point start = Clock::now();
+  for (uint64_t i = 0; i < calls; ++i) {
+    body();
+  }
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * @brief замерить body, который за вызов делает opsPerCall операций
+ *
+ * число вызовов подбирается так, чтобы повтор шел ~MEASURE_TIME
+ */
+template <typename Body>
+Result measure(const std::string &name, const std::string &unit,
+               uint64_t opsPerCall, Body body) {
+  uint64_t calls = 1;
+  double elapsed = timeCalls(body, calls);
+  while (elapsed < CALIBRATE_TIME) {
+    calls *= 2;
+    elapsed = timeCalls(body, calls);
+  }
+  calls = std::max<uint64_t>(
+      1, static_cast<uint64_t>(calls * MEASURE_TIME / elapsed));
+
+  std::vector<double> perOp;
+  for (int i = 0; i < REPEATS; ++i) {
+    perOp.push_back(timeCalls(body, calls) * 1e9 / (calls * opsPerCall));
+  }
+  std::sort(perOp.begin(), perOp.end());
+  return {name, unit, calls * opsPerCall, perOp.front(),
+          perOp[perOp.size() / 2], ""};
+}
+
+// зашумленная ступенчатая трасса с выбросами, как у PIDemulator
+std::vector<DataPoint> makeSignal(size_t size) {
+  std::mt19937 rng(42);
+  std::normal_distribution<float> noise(0.0f, 1.2f);
+  std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+  std::vector<DataPoint> signal(size);
+  float value = 0.0f;
+  for (size_t i = 0; i < size; ++i) {
+    const float setpoint = (i / 5000) % 2 == 0 ? 10.0f : -5.0f;
+    value += (setpoint - value) * 0.01f;
+    float sample = value + noise(rng);
+    if (chance(rng) < 0.005f) {
+      sample += 50.0f;
+    }
+    signal[i] = {static_cast<uint32_t>(i), sample};
+  }
+  return signal;
+}
+
+/**
+ * @brief по отсчету: filter() + isReady(), как FilterThread до блоков
+ *
+ * Filter - IFilter (вызов через vtable) или конкретный класс
+ */
+template <typename Filter>
+void runPerSample(Filter &filter, const std::vector<DataPoint> &signal) {
+  double sum = 0.0;
+  for (const DataPoint &point : signal) {
+    DataPoint result = filter.filter(point);
+    if (filter.isReady()) {
+      sum += result.value;
+    }
+  }
+  g_sink = g_sink + sum;
+}
+
+void runBlocks(IFilter &filter, const std::vector<DataPoint> &signal,
+               size_t blockSize, std::vector<DataPoint> &output) {
+  double sum = 0.0;
+  for (size_t offset = 0; offset < signal.size(); offset += blockSize) {
+    size_t count = std::min(blockSize, signal.size() - offset);
+    size_t produced =
+        filter.processBlock(signal.data() + offset, count, output.data());
+    if (produced > 0) {
+      sum += output[produced - 1].value;
+    }
+  }
+  g_sink = g_sink + sum;
+}
+
+/**
+ * @brief все варианты замера для одного фильтра
+ *
+ * make() создает свежий фильтр конкретного типа: у каждого варианта свое
+ * состояние, прогретое первым проходом калибровки
+ */
+template <typename Make>
+void benchFilter(const std::string &prefix, Make make,
+                 const std::vector<DataPoint> &signal,
+                 std::vector<Result> &results, const std::string &only) {
+  const std::string names[] = {prefix + "/per_sample_virtual",
+                               prefix + "/per_sample_direct",
+                               prefix + "/block_64", prefix + "/block_1024"};
+  std::vector<DataPoint> output(signal.size());
+
+  if (names[0].find(only) != std::string::npos) {
+    auto filter = make();
+    // через volatile компилятор не знает тип и не может девиртуализировать
+    IFilter *volatile base = &filter;
+    results.push_back(measure(names[0], "sample", signal.size(),
+                              [&] { runPerSample(*base, signal); }));
+  }
+  if (names[1].find(only) != std::string::npos) {
+    auto filter = make();
+    results.push_back(measure(names[1], "sample", signal.size(),
+                              [&] { runPerSample(filter, signal); }));
+  }
+  const size_t blockSizes[] = {64, 1024};
+  for (size_t i = 0; i < 2; ++i) {
+    if (names[2 + i].find(only) == std::string::npos) {
+      continue;
+    }
+    auto filter = make();
+    results.push_back(measure(names[2 + i], "sample", signal.size(), [&] {
+      runBlocks(filter, signal, blockSizes[i], output);
+    }));
+  }
+}
+
+void benchFilters(std::vector<Result> &results, const std::string &only) {
+  const std::vector<DataPoint> signal = makeSignal(SIGNAL_SIZE);
+
+  for (size_t window : {5, 50, 500, 5000, 50000}) {
+    benchFilter(
+        "filter/MovingAverage/window=" + std::to_string(window),
+        [window] { return MovingAverageFilter(window); }, signal, results,
+        only);
+  }
+  for (size_t window : {5, 51, 501, 5001}) {
+    benchFilter(
+        "filter/Median/window=" + std::to_string(window),
+        [window] { return MedianFilter(window); }, signal, results, only);
+  }
+  benchFilter(
+      "filter/Exponential", [] { return ExponentialFilter(); }, signal,
+      results, only);
+  benchFilter(
+      "filter/Kalman", [] { return KalmanFilter(); }, signal, results, only);
+}
+
+/**
+ * @brief producers писателей push() по одному отсчету, один читатель
+ * забирает popAll(), пока писатели не закончат и буфер не опустеет
+ *
+ * буфер при переполнении затирает старое, поэтому кроме времени на
+ * отсчет считается и доля затертых: рост доли значит, что читатель с
+ * popAll() не успевает за писателями
+ */
+void benchRing(size_t producers, std::vector<Result> &results,
+               const std::string &only) {
+  const std::string name = "ring/ThreadSafeRingBuffer/producers=" +
+                           std::to_string(producers) + "/push_pop_all";
+  if (name.find(only) == std::string::npos) {
+    return;
+  }
+  const size_t perProducer = RING_PUSHES / producers;
+  const size_t total = perProducer * producers;
+
+  std::vector<double> perOp;
+  double lostShare = 0.0;
+  uint64_t popCalls = 0;
+  for (int repeat = 0; repeat < REPEATS; ++repeat) {
+    ThreadSafeRingBuffer<DataPoint> buffer(RING_CAPACITY);
+    std::atomic<size_t> running(producers);
+    std::atomic<bool> go(false);
+    size_t received = 0;
+    uint64_t calls = 0;
+
+    std::thread consumer([&] {
+      while (!go.load(std::memory_order_acquire)) {
+      }
+      for (;;) {
+        bool done = running.load(std::memory_order_acquire) == 0;
+        std::vector<DataPoint> points = buffer.popAll();
+        ++calls;
+        received += points.size();
+        if (points.empty()) {
+          if (done) {
+            break;
+          }
+          std::this_thread::yield();
+        }
+      }
+    });
+    std::vector<std::thread> writers;
+    for (size_t p = 0; p < producers; ++p) {
+      writers.emplace_back([&, p] {
+        while (!go.load(std::memory_order_acquire)) {
+        }
+        for (size_t i = 0; i < perProducer; ++i) {
+          buffer.push({static_cast<uint32_t>(p * perProducer + i), 1.0f});
+        }
+        running.fetch_sub(1, std::memory_order_release);
+      });
+    }
+
+    const Clock::time_point start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread &writer : writers) {
+      writer.join();
+    }
+    consumer.join();
+    const double elapsed =
+        std::chrono::duration<double>(Clock::now() - start).count();
+
+    perOp.push_back(elapsed * 1e9 / total);
+    if (perOp.back() == *std::min_element(perOp.begin(), perOp.end())) {
+      lostShare = static_cast<double>(total - received) / total;
+      popCalls = calls;
+    }
+  }
+  std::sort(perOp.begin(), perOp.end());
+
+  char extra[128];
+  std::snprintf(extra, sizeof(extra),
+                ", \"overwritten_share\": %.4f, \"pop_all_calls\": %llu",
+                lostShare, static_cast<unsigned long long>(popCalls));
+  results.push_back(
+      {name, "sample", total, perOp.front(), perOp[perOp.size() / 2], extra});
+}
+
+void benchFft(std::vector<Result> &results, const std::string &only) {
+  const std::vector<DataPoint> signal = makeSignal(65536);
+  for (size_t size = 64; size <= 65536; size *= 2) {
+    const std::string name =
+        "fft/computeAmplitudeSpectrum/size=" + std::to_string(size);
+    if (name.find(only) == std::string::npos) {
+      continue;
+    }
+    std::vector<float> input(size);
+    for (size_t i = 0; i < size; ++i) {
+      input[i] = signal[i].value;
+    }
+    results.push_back(measure(name, "point", size, [&] {
+      std::vector<double> spectrum = FFT::computeAmplitudeSpectrum(input);
+      g_sink = g_sink + spectrum[1];
+    }));
+  }
+}
+
+void benchParser(std::vector<Result> &results, const std::string &only) {
+  constexpr size_t PACKETS = 1024;
+  const std::vector<DataPoint> signal = makeSignal(
+      PACKETS * Constants::Network::MAX_SAMPLES_PER_PACKET);
+
+  // старый пакет: uint32 timestamp + float value
+  std::vector<uint8_t> legacy(PACKETS * 8);
+  for (size_t i = 0; i < PACKETS; ++i) {
+    std::memcpy(&legacy[i * 8], &signal[i].timestamp, 4);
+    std::memcpy(&legacy[i * 8 + 4], &signal[i].value, 4);
+  }
+  const std::string legacyName = "parser/parseDataPacket/legacy";
+  if (legacyName.find(only) != std::string::npos) {
+    results.push_back(measure(legacyName, "packet", PACKETS, [&] {
+      double sum = 0.0;
+      for (size_t i = 0; i < PACKETS; ++i) {
+        sum += ProtocolParser::parseDataPacket(&legacy[i * 8], 8).value;
+      }
+      g_sink = g_sink + sum;
+    }));
+  }
+
+  // полные пакеты v2
+  std::vector<std::vector<uint8_t>> packets;
+  for (size_t i = 0; i < PACKETS; ++i) {
+    packets.push_back(ProtocolParser::createDataPacket(
+        0, static_cast<uint32_t>(i),
+        &signal[i * Constants::Network::MAX_SAMPLES_PER_PACKET],
+        Constants::Network::MAX_SAMPLES_PER_PACKET));
+  }
+  const std::string batchName = "parser/parseDataPacketBatch/v2_full";
+  if (batchName.find(only) != std::string::npos) {
+    std::vector<DataPoint> out(Constants::Network::MAX_SAMPLES_PER_PACKET);
+    results.push_back(measure(
+        batchName, "sample",
+        PACKETS * Constants::Network::MAX_SAMPLES_PER_PACKET, [&] {
+          double sum = 0.0;
+          for (const std::vector<uint8_t> &packet : packets) {
+            size_t count = ProtocolParser::parseDataPacketBatch(
+                packet.data(), packet.size(), out.data(), out.size());
+            sum += out[count - 1].value;
+          }
+          g_sink = g_sink + sum;
+        }));
+  }
+}
+
+bool writeJson(const std::string &path, const std::vector<Result> &results) {
+  std::FILE *file = std::fopen(path.c_str(), "w");
+  if (!file) {
+    return false;
+  }
+
+  char date[32];
+  std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+#ifdef __VERSION__
+  const char *compiler = __VERSION__;
+#else
+  const char *compiler = "unknown";
+#endif
+#ifdef NDEBUG
+  const char *build = "release";
+#else
+  const char *build = "debug";
+#endif
+
+  std::fprintf(file, "{\n  \"context\": {\n");
+  std::fprintf(file, "    \"date\": \"%s\",\n", date);
+  std::fprintf(file, "    \"compiler\": \"%s\",\n", compiler);
+  std::fprintf(file, "    \"build\": \"%s\",\n", build);
+  std::fprintf(file, "    \"hardware_threads\": %u,\n",
+               std::thread::hardware_concurrency());
+  std::fprintf(file, "    \"repeats\": %d\n  },\n", REPEATS);
+  std::fprintf(file, "  \"results\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result &r = results[i];
+    std::fprintf(file,
+                 "    {\"name\": \"%s\", \"unit\": \"%s\", "
+                 "\"iterations\": %llu, \"ns_per_op\": %.4f, "
+                 "\"ns_per_op_median\": %.4f, \"ops_per_second\": %.0f%s}%s\n",
+                 r.name.c_str(), r.unit.c_str(),
+                 static_cast<unsigned long long>(r.iterations), r.best,
+                 r.median, 1e9 / r.best, r.extra.c_str(),
+                 i + 1 < results.size() ? "," : "");
+  }
+  std::fprintf(file, "  ]\n}\n");
+  return std::fclose(file) == 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::string path = argc > 1 ? argv[1] : "bench_micro.json";
+  const std::string only = argc > 2 ? argv[2] : "";
+
+  std::vector<Result> results;
+  benchFilters(results, only);
+  for (size_t producers : {1, 2, 4}) {
+    benchRing(producers, results, only);
+  }
+  benchFft(results, only);
+  benchParser(results, only);
+
+  std::printf("%-58s %12s %12s\n", "benchmark", "ns/op", "median");
+  for (const Result &r : results) {
+    std::printf("%-58s %12.3f %12.3f  per %s\n", r.name.c_str(), r.best,
+                r.median, r.unit.c_str());
+  }
+
+  if (!writeJson(path, results)) {
+    std::fprintf(stderr, "failed to write %s\n", path.c_str());
+    return 1;
+  }
+  std::printf("results: %s\n", path.c_str());
+  return 0;
+}
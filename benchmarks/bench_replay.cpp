@@ -0,0 +1,154 @@
+/*
+ * бенчмарк пропускной способности конвейера фильтров на записанной
+ * сессии: ReplaySource публикует сырые отсчеты записи так быстро, как
+ * успевают потоки фильтров DataProcessor, и для каждого фильтра выводится,
+ * сколько отсчетов в секунду он обработал.
+ *
+ * без файла записи бенчмарк сначала записывает синтетическую сессию
+ * (синусоида с шумом) через SessionRecorder.
+ *
+ * запуск: bench_replay [файл.pidrec | отсчетов]
+ */
+
+#include "../include/core/Constants.h"
+#include "../include/core/broadcastringbuffer.h"
+#include "../include/core/datapoint.h"
+#include "../include/filters/exponentialfilter.h"
+#include "../include/filters/kalmanfilter.h"
+#include "../include/filters/medianfilter.h"
+#include "../include/filters/movingaveragefilter.h"
+#include "../include/processing/dataprocessor.h"
+#include "../include/storage/replaysource.h"
+#include "../include/storage/sessionrecorder.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// записать синтетическую сессию из samples отсчетов с шагом 1 мс
+void writeSyntheticSession(const std::string &path, size_t samples) {
+  BroadcastRingBuffer<DataPoint> stream(1 << 20);
+  BroadcastRingBuffer<DataPoint>::Reader *reader = stream.createReader();
+
+  SessionRecorder recorder(std::chrono::milliseconds(5));
+  recorder.addSeries("Raw", reader);
+  recorder.start(path);
+
+  std::mt19937 rng(42);
+  std::normal_distribution<float> noise(0.0f, 0.3f);
+  std::vector<DataPoint> block(65536);
+  for (size_t first = 0; first < samples; first += block.size()) {
+    size_t count = std::min(block.size(), samples - first);
+    for (size_t i = 0; i < count; ++i) {
+      uint32_t t = static_cast<uint32_t>(first + i);
+      block[i] = DataPoint(t, 10.0f * std::sin(0.01f * t) + noise(rng));
+    }
+    // писатель записи не должен отстать больше чем на журнал
+    while (reader->size() > stream.capacity() - count) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    stream.pushBulk(block.data(), count);
+  }
+  while (!reader->empty()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  recorder.stop();
+}
+
+struct Stage {
+  const char *name;
+  IFilter *filter;
+};
+
+// воспроизвести запись через DataProcessor с фильтрами stages
+void replay(const std::string &path, const std::vector<Stage> &stages,
+            const char *label) {
+  BroadcastRingBuffer<DataPoint> rawStream(Constants::RAW_STREAM_CAPACITY);
+  DataProcessor processor;
+  ReplaySource source(&rawStream);
+  source.open(path);
+
+  for (const Stage &stage : stages) {
+    stage.filter->reset();
+    BroadcastRingBuffer<DataPoint>::Reader *input = rawStream.createReader();
+    processor.addFilter(stage.filter, input, stage.name);
+    source.addConsumer(stage.name, input);
+  }
+  processor.start();
+
+  source.start(ReplaySource::Pacing::AsFastAsPossible);
+  while (!source.isFinished()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  source.stop();
+  processor.stop();
+  if (!source.getError().empty()) {
+    std::fprintf(stderr, "%s: replay stopped early: %s\n", label,
+                 source.getError().c_str());
+  }
+
+  for (const ReplaySource::ConsumerReport &report :
+       source.getConsumerReports()) {
+    std::printf("%-10s %-14s %12llu %10.3f %14.0f %10zu%s\n", label,
+                report.name.c_str(),
+                static_cast<unsigned long long>(report.samples),
+                report.seconds, report.samplesPerSecond,
+                processor.getFilterProcessedCount(report.name),
+                report.stalled ? "  (stalled)" : "");
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string path;
+  size_t samples = 5000000;
+  if (argc > 1) {
+    char *end = nullptr;
+    unsigned long long value = std::strtoull(argv[1], &end, 10);
+    if (end && *end == '\0' && value > 0) {
+      samples = static_cast<size_t>(value);
+    } else {
+      path = argv[1];
+    }
+  }
+  if (path.empty()) {
+    path = "bench_replay.pidrec";
+    std::printf("writing synthetic session: %zu samples -> %s\n", samples,
+                path.c_str());
+    writeSyntheticSession(path, samples);
+  }
+  std::printf("replaying %s as fast as possible\n", path.c_str());
+
+  MovingAverageFilter movingAverage(
+      Constants::Filters::DEFAULT_MOVING_AVERAGE_WINDOW);
+  MedianFilter median(Constants::Filters::DEFAULT_MEDIAN_WINDOW);
+  ExponentialFilter exponential(Constants::Filters::DEFAULT_EXPONENTIAL_ALPHA);
+  KalmanFilter kalman;
+  std::vector<Stage> stages = {{"MovingAverage", &movingAverage},
+                               {"Median", &median},
+                               {"Exponential", &exponential},
+                               {"Kalman", &kalman}};
+
+  std::printf("%-10s %-14s %12s %10s %14s %10s\n", "run", "filter",
+              "samples", "seconds", "samples/s", "processed");
+  try {
+    // все фильтры вместе, как в приложении: темп задает самый медленный
+    replay(path, stages, "together");
+    // каждый фильтр отдельно: предел самого фильтра
+    for (const Stage &stage : stages) {
+      replay(path, {stage}, "alone");
+    }
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
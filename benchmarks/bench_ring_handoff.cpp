@@ -0,0 +1,193 @@
+/*
+ * бенчмарк передачи отсчетов от потока приема потокам фильтров:
+ * ThreadSafeRingBuffer (мьютекс) и SpscRingBuffer (lock-free) с копией
+ * на каждого читателя против одного BroadcastRingBuffer на всех.
+ *
+ * в режимах с копиями один писатель раздает каждый блок во все буферы,
+ * на каждый буфер - свой читатель. в broadcast-режиме блок пишется один
+ * раз, читатели идут по нему своими курсорами. писатель ждет, если у
+ * самого медленного читателя нет места под блок, поэтому отсчеты не
+ * теряются и меряется чистая пропускная способность.
+ *
+ * запуск: bench_ring_handoff [отсчетов на читателя] [размер блока]
+ */
+
+#include "../include/core/broadcastringbuffer.h"
+#include "../include/core/datapoint.h"
+#include "../include/core/ibufferreader.h"
+#include "../include/core/spscringbuffer.h"
+#include "../include/core/threadsaferingbuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t BUFFER_CAPACITY = 4096;
+
+enum class Mode { MutexPerPoint, MutexBulk, SpscBulk, Broadcast };
+
+const char *modeName(Mode mode) {
+  switch (mode) {
+  case Mode::MutexPerPoint:
+    return "mutex/point";
+  case Mode::MutexBulk:
+    return "mutex/bulk";
+  case Mode::SpscBulk:
+    return "spsc/bulk";
+  case Mode::Broadcast:
+    return "broadcast";
+  }
+  return "";
+}
+
+// читатель: забирает блоками, пока писатель не закончит и буфер не опустеет
+void consumerLoop(IBufferReader<DataPoint> *buffer,
+                  const std::atomic<bool> &producerDone, size_t &received,
+                  double &checksum) {
+  std::vector<DataPoint> block(256);
+  size_t count = 0;
+  double sum = 0.0;
+  for (;;) {
+    size_t n = buffer->popBulk(block.data(), block.size());
+    if (n == 0) {
+      if (producerDone.load(std::memory_order_acquire) && buffer->empty()) {
+        break;
+      }
+      std::this_thread::yield();
+      continue;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      sum += block[i].value;
+    }
+    count += n;
+  }
+  received = count;
+  checksum = sum;
+}
+
+double run(Mode mode, size_t consumers, size_t pointsPerConsumer,
+           size_t blockSize) {
+  std::vector<std::unique_ptr<ThreadSafeRingBuffer<DataPoint>>> mutexBuffers;
+  std::vector<std::unique_ptr<SpscRingBuffer<DataPoint>>> spscBuffers;
+  BroadcastRingBuffer<DataPoint> broadcast(BUFFER_CAPACITY);
+  std::vector<IBufferReader<DataPoint> *> readers;
+
+  for (size_t i = 0; i < consumers; ++i) {
+    if (mode == Mode::Broadcast) {
+      readers.push_back(broadcast.createReader());
+    } else if (mode == Mode::SpscBulk) {
+      spscBuffers.push_back(
+          std::make_unique<SpscRingBuffer<DataPoint>>(BUFFER_CAPACITY));
+      readers.push_back(spscBuffers.back().get());
+    } else {
+      mutexBuffers.push_back(
+          std::make_unique<ThreadSafeRingBuffer<DataPoint>>(BUFFER_CAPACITY));
+      readers.push_back(mutexBuffers.back().get());
+    }
+  }
+
+  std::atomic<bool> producerDone(false);
+  std::vector<size_t> received(consumers, 0);
+  std::vector<double> checksums(consumers, 0.0);
+  std::vector<std::thread> threads;
+
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < consumers; ++i) {
+    threads.emplace_back(consumerLoop, readers[i], std::cref(producerDone),
+                         std::ref(received[i]), std::ref(checksums[i]));
+  }
+
+  std::vector<DataPoint> block(blockSize);
+  uint32_t timestamp = 0;
+  for (size_t sent = 0; sent < pointsPerConsumer; sent += blockSize) {
+    size_t n = std::min(blockSize, pointsPerConsumer - sent);
+    for (size_t k = 0; k < n; ++k) {
+      block[k] = DataPoint(timestamp, static_cast<float>(timestamp % 100));
+      ++timestamp;
+    }
+
+    if (mode == Mode::Broadcast) {
+      for (size_t i = 0; i < consumers; ++i) {
+        while (readers[i]->size() + n > BUFFER_CAPACITY) {
+          std::this_thread::yield();
+        }
+      }
+      broadcast.pushBulk(block.data(), n);
+      continue;
+    }
+
+    for (size_t i = 0; i < consumers; ++i) {
+      // ждем места под весь блок, чтобы ничего не затереть и не потерять
+      while (readers[i]->size() + n > BUFFER_CAPACITY) {
+        std::this_thread::yield();
+      }
+
+      switch (mode) {
+      case Mode::MutexPerPoint:
+        for (size_t k = 0; k < n; ++k) {
+          mutexBuffers[i]->push(block[k]);
+        }
+        break;
+      case Mode::MutexBulk:
+        mutexBuffers[i]->pushBulk(block.data(), n);
+        break;
+      case Mode::SpscBulk:
+        spscBuffers[i]->pushBulk(block.data(), n);
+        break;
+      case Mode::Broadcast:
+        break;
+      }
+    }
+  }
+  producerDone.store(true, std::memory_order_release);
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  size_t total = 0;
+  for (size_t i = 0; i < consumers; ++i) {
+    if (received[i] != pointsPerConsumer) {
+      std::fprintf(stderr, "%s: consumer %zu received %zu of %zu\n",
+                   modeName(mode), i, received[i], pointsPerConsumer);
+    }
+    total += received[i];
+  }
+
+  double seconds = std::chrono::duration<double>(end - begin).count();
+  return static_cast<double>(total) / seconds;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t points = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+  size_t blockSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 64;
+  if (blockSize == 0 || blockSize > BUFFER_CAPACITY) {
+    std::fprintf(stderr, "block size must be in 1..%zu\n", BUFFER_CAPACITY);
+    return 1;
+  }
+
+  std::printf("%zu points per consumer, block %zu, %u hardware threads\n",
+              points, blockSize, std::thread::hardware_concurrency());
+  std::printf("%-12s %10s %16s\n", "mode", "consumers", "points/s");
+
+  const size_t consumerCounts[] = {1, 4, 16};
+  const Mode modes[] = {Mode::MutexPerPoint, Mode::MutexBulk, Mode::SpscBulk,
+                        Mode::Broadcast};
+  for (size_t consumers : consumerCounts) {
+    for (Mode mode : modes) {
+      std::printf("%-12s %10zu %16.0f\n", modeName(mode), consumers,
+                  run(mode, consumers, points, blockSize));
+    }
+  }
+  return 0;
+}
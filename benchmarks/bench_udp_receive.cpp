@@ -0,0 +1,209 @@
+/*
+ * бенчмарк приема UdpReceiver: поштучный recvfrom против пачек recvmmsg.
+ *
+ * отправитель в отдельном потоке шлет в loopback 8-байтные пакеты: с
+ * заданным темпом (пачкой раз в миллисекунду, как pidsim) или, при темпе
+ * 0, так быстро, как может. кроме принятых пакетов печатается, сколько
+ * датаграмм ядро выбросило из-за полной очереди сокета (RcvbufErrors из
+ * /proc/net/snmp), и сколько процессорного времени поток приема тратит на
+ * пакет - при перегрузке на одном ядре прием ограничен долей процессора,
+ * а не системными вызовами, и сравнивать режимы надо по этой цифре
+ *
+ * запуск: bench_udp_receive [секунд на режим] [порт] [пакетов/с, 0 - без
+ * ограничения]
+ */
+
+#include "../include/core/datapoint.h"
+#include "../include/core/broadcastringbuffer.h"
+#include "../include/network/udpreceiver.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct RunResult {
+  size_t sent;
+  size_t received;
+  double seconds;
+  uint64_t bufferDrops;      // выброшено ядром: очередь сокета полна
+  double receiverCpuSeconds; // процессорное время потока приема
+};
+
+double cpuSeconds(clockid_t clock) {
+  struct timespec time;
+  clock_gettime(clock, &time);
+  return static_cast<double>(time.tv_sec) +
+         static_cast<double>(time.tv_nsec) * 1e-9;
+}
+
+// счетчик Udp RcvbufErrors: общий для всех сокетов, поэтому на машине
+// без другого udp-трафика
+uint64_t udpReceiveBufferErrors() {
+  std::ifstream snmp("/proc/net/snmp");
+  std::string names;
+  std::string values;
+  while (std::getline(snmp, names) && std::getline(snmp, values)) {
+    if (names.compare(0, 4, "Udp:") != 0) {
+      continue;
+    }
+    std::istringstream nameStream(names);
+    std::istringstream valueStream(values);
+    std::string name;
+    std::string value;
+    while (nameStream >> name && valueStream >> value) {
+      if (name == "RcvbufErrors") {
+        return std::strtoull(value.c_str(), nullptr, 10);
+      }
+    }
+  }
+  return 0;
+}
+
+// отправка пакетов пачками sendmmsg, чтобы отправитель не был узким местом.
+// rate > 0: rate / 1000 пакетов раз в миллисекунду
+void senderLoop(uint16_t port, double rate, std::atomic<bool> &running,
+                std::atomic<size_t> &sent, double &cpu) {
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock < 0) {
+    return;
+  }
+
+  struct sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+  constexpr size_t batch = 64;
+  std::vector<uint8_t> payload(batch * 8);
+  std::vector<struct iovec> iov(batch);
+  std::vector<struct mmsghdr> msgs(batch);
+  for (size_t i = 0; i < batch; ++i) {
+    iov[i].iov_base = payload.data() + i * 8;
+    iov[i].iov_len = 8;
+    std::memset(&msgs[i], 0, sizeof(msgs[i]));
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_name = &addr;
+    msgs[i].msg_hdr.msg_namelen = sizeof(addr);
+  }
+
+  const auto begin = std::chrono::steady_clock::now();
+  uint64_t ticks = 0;
+  size_t due = 0; // сколько пакетов пора было отправить
+  size_t total = 0;
+  uint32_t timestamp = 0;
+  while (running.load(std::memory_order_relaxed)) {
+    size_t count = batch;
+    if (rate > 0) {
+      if (total == due) {
+        ++ticks;
+        std::this_thread::sleep_until(begin + std::chrono::milliseconds(ticks));
+        due = static_cast<size_t>(rate * static_cast<double>(ticks) / 1000);
+      }
+      count = std::min(batch, due - total);
+      if (count == 0) {
+        continue;
+      }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      float value = static_cast<float>(timestamp % 100);
+      std::memcpy(payload.data() + i * 8, &timestamp, 4);
+      std::memcpy(payload.data() + i * 8 + 4, &value, 4);
+      ++timestamp;
+    }
+    int n = sendmmsg(sock, msgs.data(), static_cast<unsigned int>(count), 0);
+    if (n > 0) {
+      total += static_cast<size_t>(n);
+      sent.fetch_add(static_cast<size_t>(n), std::memory_order_relaxed);
+    }
+  }
+
+  cpu = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+  close(sock);
+}
+
+RunResult runMode(bool batched, double seconds, uint16_t port, double rate) {
+  BroadcastRingBuffer<DataPoint> buffer(Constants::RAW_STREAM_CAPACITY);
+  UdpReceiver receiver(&buffer);
+  receiver.setBatchReceiveEnabled(batched);
+
+  if (!receiver.start("127.0.0.1", port)) {
+    std::fprintf(stderr, "cannot bind 127.0.0.1:%u\n", port);
+    std::exit(1);
+  }
+
+  std::atomic<bool> running(true);
+  std::atomic<size_t> sent(0);
+  double senderCpu = 0.0;
+  const uint64_t dropsBefore = udpReceiveBufferErrors();
+  // главный поток только спит: процессорное время процесса за вычетом
+  // отправителя - это поток приема
+  const double cpuBefore = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID);
+  std::thread sender(senderLoop, port, rate, std::ref(running),
+                     std::ref(sent), std::ref(senderCpu));
+
+  auto begin = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  running = false;
+  sender.join();
+  // даем приемнику дочитать очередь сокета
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  auto end = std::chrono::steady_clock::now();
+  const double cpuAfter = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID);
+  receiver.stop();
+
+  RunResult result;
+  result.sent = sent.load();
+  result.received = receiver.getPacketsReceived();
+  result.seconds = std::chrono::duration<double>(end - begin).count();
+  result.bufferDrops = udpReceiveBufferErrors() - dropsBefore;
+  result.receiverCpuSeconds = cpuAfter - cpuBefore - senderCpu;
+  return result;
+}
+
+void printResult(const char *name, const RunResult &r) {
+  double loss =
+      r.sent > 0 ? 100.0 * (1.0 - static_cast<double>(r.received) /
+                                      static_cast<double>(r.sent))
+                 : 0.0;
+  double cpuPerPacket =
+      r.received > 0
+          ? r.receiverCpuSeconds * 1e9 / static_cast<double>(r.received)
+          : 0.0;
+  std::printf("%-10s sent %10zu  received %10zu  %9.0f pkt/s  loss %5.1f%%"
+              "  rcvbuf drops %9llu  cpu %6.0f ns/pkt\n",
+              name, r.sent, r.received,
+              static_cast<double>(r.received) / r.seconds, loss,
+              static_cast<unsigned long long>(r.bufferDrops), cpuPerPacket);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  double seconds = argc > 1 ? std::atof(argv[1]) : 2.0;
+  uint16_t port =
+      argc > 2 ? static_cast<uint16_t>(std::atoi(argv[2])) : uint16_t(50100);
+  double rate = argc > 3 ? std::atof(argv[3]) : 0.0;
+
+  printResult("recvfrom", runMode(false, seconds, port, rate));
+  printResult("recvmmsg", runMode(true, seconds, port, rate));
+  return 0;
+}
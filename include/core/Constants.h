@@ -16,13 +16,53 @@ namespace Constants {
 constexpr size_t DEFAULT_BUFFER_SIZE = 1000;
 constexpr size_t MAX_BUFFER_SIZE = 10000;
 
+/**
+ * @brief вместимость общего журнала сырых отсчетов (степень двойки).
+ * читатели, отставшие больше чем на нее, теряют старые отсчеты
+ */
+constexpr size_t RAW_STREAM_CAPACITY = 65536;
+
+/**
+ * @brief вместимость журнала результатов одного фильтра (степень двойки).
+ * его читают график и расчет спектра
+ */
+constexpr size_t FILTER_OUTPUT_CAPACITY = 16384;
+
+/**
+ * @brief скачок timestamp назад больше этого (мс) - не опоздание, а
+ * перезапуск источника: история начинается заново
+ */
+constexpr uint32_t RESTART_GAP_MS = 10000;
+
 /**
  * @brief количество отсчетов для отображения на графике
  */
 constexpr size_t MIN_DISPLAY_SAMPLES = 50;
-constexpr size_t MAX_DISPLAY_SAMPLES = 1000;
+constexpr size_t MAX_DISPLAY_SAMPLES = 1000000;
 constexpr size_t DEFAULT_DISPLAY_SAMPLES = 500;
 
+/**
+ * @brief сколько последних отсчетов каждой серии хранится для просмотра
+ * истории графика (час при 1 кГц)
+ */
+constexpr size_t DISPLAY_HISTORY_SAMPLES = 3600000;
+
+/**
+ * @brief размер строки кэша, по нему разносятся индексы lock-free буферов
+ */
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief сколько отсчетов поток фильтра забирает из входного буфера за раз
+ */
+constexpr size_t FILTER_INPUT_BLOCK_SIZE = 256;
+
+/**
+ * @brief сколько поток фильтра спит в ожидании данных, прежде чем
+ * перепроверить флаг работы (обычно его будят раньше)
+ */
+constexpr int FILTER_WAIT_TIMEOUT_MS = 100;
+
 /**
  * @brief настройки сети по умолчанию
  */
@@ -38,7 +78,29 @@ constexpr uint16_t DEFAULT_SEND_PORT = 50006;
 // размеры буферов для UDP
 constexpr size_t UDP_BUFFER_SIZE = 1024;
 constexpr int SOCKET_TIMEOUT_MS = 100;
+// очередь приема сокета (байт). датаграмма в ней стоит несколько сотен
+// байт служебных данных ядра, и очередь по умолчанию (~200 КБ) вмещает
+// лишь сотни пакетов: их не хватает, пока поток приема ждет процессор.
+// ядро ограничивает размер net.core.rmem_max
+constexpr int SOCKET_RECEIVE_BUFFER_SIZE = 4 * 1024 * 1024;
 constexpr size_t DATA_PACKET_SIZE = 8;
+
+// пакет данных v2: заголовок + упакованный массив отсчетов
+constexpr uint16_t DATA_PACKET_V2_MAGIC = 0x4450; // "PD" в little-endian
+constexpr uint8_t DATA_PACKET_V2_VERSION = 2;
+constexpr size_t DATA_PACKET_V2_HEADER_SIZE = 12;
+constexpr size_t DATA_PACKET_V2_SAMPLE_SIZE = 8;
+constexpr size_t MAX_SAMPLES_PER_PACKET =
+    (UDP_BUFFER_SIZE - DATA_PACKET_V2_HEADER_SIZE) / DATA_PACKET_V2_SAMPLE_SIZE;
+
+// сколько датаграмм забираем за один вызов recvmmsg (только linux)
+constexpr size_t RECEIVE_BATCH_SIZE = 64;
+
+// окно переупорядочивания по timestamp (мс), 0 - выключено
+constexpr uint32_t DEFAULT_REORDER_WINDOW_MS = 10;
+constexpr uint32_t MAX_REORDER_WINDOW_MS = 1000;
+// сколько отсчетов максимум держим в окне переупорядочивания
+constexpr size_t MAX_REORDER_PENDING = 4096;
 } // namespace Network
 
 /**
@@ -50,14 +112,14 @@ namespace Filters {
  */
 constexpr size_t DEFAULT_MOVING_AVERAGE_WINDOW = 10;
 constexpr size_t MIN_MOVING_AVERAGE_WINDOW = 2;
-constexpr size_t MAX_MOVING_AVERAGE_WINDOW = 100;
+constexpr size_t MAX_MOVING_AVERAGE_WINDOW = 50000;
 
 /**
  * @brief размер окна для медианного фильтра
  */
 constexpr size_t DEFAULT_MEDIAN_WINDOW = 5;
-constexpr size_t MIN_MEDIAN_WINDOW = 3;  // минимум
-constexpr size_t MAX_MEDIAN_WINDOW = 51; // максимум
+constexpr size_t MIN_MEDIAN_WINDOW = 3;     // минимум
+constexpr size_t MAX_MEDIAN_WINDOW = 10001; // максимум
 
 /**
  * @brief коэффициент сглаживания (alpha)
@@ -102,8 +164,18 @@ namespace Performance {
 constexpr size_t MONITORING_WINDOW_SIZE = 1000;
 constexpr int UPDATE_INTERVAL_MS = 100;
 constexpr int SPECTRUM_UPDATE_INTERVAL = 5;
+// за какой интервал статусная строка показывает p50/p99/max задержек
+constexpr int LATENCY_REPORT_INTERVAL_MS = 1000;
 }
 
+/**
+ * @brief параметры расчета спектра
+ */
+namespace Spectrum {
+constexpr size_t MIN_FFT_SIZE = 64;   // меньше отсчетов - спектр не считаем
+constexpr size_t MAX_FFT_SIZE = 1024; // сколько последних отсчетов берем
+} // namespace Spectrum
+
 /**
  * @brief настройки для автоматического циклического задания целевого значения
  */
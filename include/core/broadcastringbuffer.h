@@ -0,0 +1,313 @@
+#ifndef BROADCASTRINGBUFFER_H
+#define BROADCASTRINGBUFFER_H
+
+#include "Constants.h"
+#include "datawaiter.h"
+#include "ibufferreader.h"
+#include "latency.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief кольцевой журнал на одного писателя и много читателей
+ *
+ * писатель один раз кладет отсчет в общий массив и сдвигает курсор, у каждого
+ * читателя (дисплей, поток фильтра) свой курсор чтения. стоимость записи не
+ * зависит от числа читателей: писатель их не ждет и не трогает
+ *
+ * отставший больше чем на вместимость читатель теряет самые старые отсчеты,
+ * они считаются в Reader::getSkipped(). чтобы не отдать отсчет, который
+ * писатель затер прямо во время копирования, писатель перед записью
+ * объявляет claim-курсор, а читатель после копирования сверяется с ним
+ * (как в seqlock)
+ *
+ * рядом с каждым элементом лежит SampleStamp: время приема (передает
+ * писатель) и время публикации в этот журнал (ставит сам журнал, одно
+ * чтение часов на блок). читатели, которым метки не нужны, их не копируют
+ *
+ * @tparam T тип данных, должен быть тривиально копируемым
+ */
+template <typename T> class BroadcastRingBuffer {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "BroadcastRingBuffer requires a trivially copyable type");
+
+public:
+  /**
+   * @brief курсор чтения одного потребителя
+   *
+   * методы чтения вызываются только из потока этого потребителя
+   */
+  class Reader : public IBufferReader<T> {
+  public:
+    /**
+     * @brief забрать до maxCount непрочитанных элементов
+     * @param out куда писать
+     * @param maxCount сколько максимум забрать
+     * @return сколько забрано
+     */
+    size_t popBulk(T *out, size_t maxCount) override {
+      return m_ring->read(m_position, m_skipped, out, maxCount, nullptr);
+    }
+
+    /**
+     * @brief забрать до maxCount элементов вместе с их метками времени
+     */
+    size_t popBulkStamped(T *out, SampleStamp *stamps,
+                          size_t maxCount) override {
+      return m_ring->read(m_position, m_skipped, out, maxCount, stamps);
+    }
+
+    /**
+     * @brief забрать все непрочитанные элементы
+     * @return вектор с элементами в порядке от старого к новому
+     */
+    std::vector<T> popAll() override {
+      std::vector<T> result(size());
+      result.resize(popBulk(result.data(), result.size()));
+      return result;
+    }
+
+    /**
+     * @brief сколько элементов еще не прочитано (не больше вместимости)
+     */
+    size_t size() const override {
+      uint64_t cursor = m_ring->m_cursor.load(std::memory_order_acquire);
+      uint64_t position = m_position.load(std::memory_order_relaxed);
+      return static_cast<size_t>(
+          std::min<uint64_t>(cursor - position, m_ring->m_capacity));
+    }
+
+    /**
+     * @brief все ли прочитано
+     */
+    bool empty() const override { return size() == 0; }
+
+    /**
+     * @brief вместимость общего журнала
+     */
+    size_t capacity() const override { return m_ring->m_capacity; }
+
+    /**
+     * @brief сколько элементов пропущено из-за отставания
+     */
+    uint64_t getSkipped() const { return m_skipped.load(); }
+
+    /**
+     * @brief ждать новых данных для этого читателя
+     * @param timeout максимальное время ожидания
+     * @return true если есть что читать
+     */
+    bool waitForData(std::chrono::milliseconds timeout) override {
+      return m_ring->m_waiter.wait([this] { return !empty(); }, timeout);
+    }
+
+    /**
+     * @brief разбудить всех ждущих читателей журнала
+     */
+    void wakeWaiters() override { m_ring->m_waiter.wakeAll(); }
+
+    /**
+     * @brief пропустить все непрочитанное, читать только новые данные
+     */
+    void skipToEnd() {
+      m_position.store(m_ring->m_cursor.load(std::memory_order_acquire),
+                       std::memory_order_relaxed);
+    }
+
+  private:
+    friend class BroadcastRingBuffer;
+
+    explicit Reader(BroadcastRingBuffer *ring)
+        : m_ring(ring),
+          m_position(ring->m_cursor.load(std::memory_order_acquire)),
+          m_skipped(0) {}
+
+    BroadcastRingBuffer *m_ring;
+    // курсоры разных читателей не должны делить строку кэша
+    alignas(Constants::CACHE_LINE_SIZE) std::atomic<uint64_t> m_position;
+    std::atomic<uint64_t> m_skipped;
+  };
+
+  /**
+   * @brief конструктор
+   * @param capacity минимальная вместимость, округляется до степени двойки
+   */
+  explicit BroadcastRingBuffer(size_t capacity)
+      : m_capacity(roundUpToPowerOfTwo(capacity)), m_mask(m_capacity - 1),
+        m_buffer(new T[m_capacity]), m_stamps(new SampleStamp[m_capacity]),
+        m_claim(0), m_cursor(0) {}
+
+  BroadcastRingBuffer(const BroadcastRingBuffer &) = delete;
+  BroadcastRingBuffer &operator=(const BroadcastRingBuffer &) = delete;
+
+  /**
+   * @brief создать нового читателя
+   *
+   * читатель видит только данные, записанные после его создания, и живет
+   * столько же, сколько журнал
+   *
+   * @return указатель на читателя (владеет журнал)
+   */
+  Reader *createReader() {
+    std::unique_lock<std::mutex> lock(m_readersMutex);
+    m_readers.push_back(std::unique_ptr<Reader>(new Reader(this)));
+    return m_readers.back().get();
+  }
+
+  /**
+   * @brief добавить элемент (только поток писателя)
+   */
+  void push(const T &item) { pushBulk(&item, 1); }
+
+  /**
+   * @brief добавить блок элементов (только поток писателя)
+   *
+   * если блок больше вместимости, сохраняется только его хвост
+   *
+   * @param items указатель на первый элемент блока
+   * @param count количество элементов
+   * @param receivedNs время приема каждого элемента (monotonicNs), 0 или
+   * nullptr - считать временем приема момент публикации
+   */
+  void pushBulk(const T *items, size_t count,
+                const uint64_t *receivedNs = nullptr) {
+    if (count == 0) {
+      return;
+    }
+    if (count > m_capacity) {
+      items += count - m_capacity;
+      if (receivedNs) {
+        receivedNs += count - m_capacity;
+      }
+      count = m_capacity;
+    }
+    const uint64_t publishedNs = monotonicNs();
+
+    const uint64_t head = m_cursor.load(std::memory_order_relaxed);
+    const uint64_t next = head + count;
+
+    // объявляем, какие слоты сейчас будут затерты, до самой записи
+    m_claim.store(next, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const size_t start = static_cast<size_t>(head & m_mask);
+    const size_t first = std::min(count, m_capacity - start);
+    std::copy(items, items + first, m_buffer.get() + start);
+    std::copy(items + first, items + count, m_buffer.get());
+    for (size_t i = 0; i < count; ++i) {
+      SampleStamp &stamp = m_stamps[(head + i) & m_mask];
+      stamp.publishedNs = publishedNs;
+      stamp.receivedNs =
+          receivedNs && receivedNs[i] != 0 ? receivedNs[i] : publishedNs;
+    }
+
+    m_cursor.store(next, std::memory_order_release);
+
+    // одно пробуждение на блок, и только если кто-то спит
+    m_waiter.notify();
+  }
+
+  /**
+   * @brief сколько элементов записано за все время
+   */
+  uint64_t getWritten() const { return m_cursor.load(); }
+
+  /**
+   * @brief вместимость (степень двойки)
+   */
+  size_t capacity() const { return m_capacity; }
+
+  /**
+   * @brief получить размер памяти, используемой журналом
+   * @return размер памяти в байтах
+   */
+  size_t getMemoryUsage() const {
+    return sizeof(*this) + m_capacity * (sizeof(T) + sizeof(SampleStamp));
+  }
+
+private:
+  size_t read(std::atomic<uint64_t> &positionRef,
+              std::atomic<uint64_t> &skipped, T *out, size_t maxCount,
+              SampleStamp *stamps) {
+    uint64_t position = positionRef.load(std::memory_order_relaxed);
+    const uint64_t cursor = m_cursor.load(std::memory_order_acquire);
+
+    // отстали больше чем на кольцо: старое уже затерто
+    if (cursor - position > m_capacity) {
+      skipped.fetch_add(cursor - m_capacity - position,
+                        std::memory_order_relaxed);
+      position = cursor - m_capacity;
+    }
+
+    size_t count = static_cast<size_t>(
+        std::min<uint64_t>(maxCount, cursor - position));
+    if (count == 0) {
+      positionRef.store(position, std::memory_order_relaxed);
+      return 0;
+    }
+
+    const size_t start = static_cast<size_t>(position & m_mask);
+    const size_t first = std::min(count, m_capacity - start);
+    std::copy(m_buffer.get() + start, m_buffer.get() + start + first, out);
+    std::copy(m_buffer.get(), m_buffer.get() + (count - first), out + first);
+    if (stamps) {
+      std::copy(m_stamps.get() + start, m_stamps.get() + start + first,
+                stamps);
+      std::copy(m_stamps.get(), m_stamps.get() + (count - first),
+                stamps + first);
+    }
+
+    // писатель мог успеть затереть начало скопированного куска
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t claim = m_claim.load(std::memory_order_relaxed);
+    size_t torn = 0;
+    if (claim > m_capacity && claim - m_capacity > position) {
+      torn = static_cast<size_t>(
+          std::min<uint64_t>(count, claim - m_capacity - position));
+    }
+    if (torn > 0) {
+      std::copy(out + torn, out + count, out);
+      if (stamps) {
+        std::copy(stamps + torn, stamps + count, stamps);
+      }
+      skipped.fetch_add(torn, std::memory_order_relaxed);
+    }
+
+    positionRef.store(position + count, std::memory_order_relaxed);
+    return count - torn;
+  }
+
+  static size_t roundUpToPowerOfTwo(size_t value) {
+    if (value == 0) {
+      throw std::invalid_argument("Capacity must be greater than 0");
+    }
+    size_t result = 1;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  const size_t m_capacity;
+  const size_t m_mask;
+  std::unique_ptr<T[]> m_buffer;
+  std::unique_ptr<SampleStamp[]> m_stamps; // метки элементов m_buffer
+
+  // курсоры писателя: до какого номера слоты затираются и до какого готовы
+  alignas(Constants::CACHE_LINE_SIZE) std::atomic<uint64_t> m_claim;
+  std::atomic<uint64_t> m_cursor;
+
+  alignas(Constants::CACHE_LINE_SIZE) DataWaiter m_waiter;
+
+  std::mutex m_readersMutex;
+  std::vector<std::unique_ptr<Reader>> m_readers;
+};
+
+#endif // BROADCASTRINGBUFFER_H
@@ -0,0 +1,84 @@
+#ifndef DATAWAITER_H
+#define DATAWAITER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief ожидание данных читателем буфера без опроса со sleep
+ *
+ * читатель засыпает на condition variable, писатель будит его после
+ * публикации блока. пока никто не ждет, notify() стоит одну атомарную
+ * загрузку и не трогает мьютекс, так что писатель не тормозит
+ *
+ * порядок важен: писатель сначала публикует данные, потом вызывает
+ * notify(); читатель проверяет наличие данных под мьютексом после того,
+ * как записался в ждущие
+ */
+class DataWaiter {
+public:
+  DataWaiter() : m_waiters(0), m_generation(0) {}
+
+  DataWaiter(const DataWaiter &) = delete;
+  DataWaiter &operator=(const DataWaiter &) = delete;
+
+  /**
+   * @brief ждать, пока ready() не вернет true
+   *
+   * @param ready проверка наличия данных, вызывается под мьютексом
+   * @param timeout максимальное время ожидания
+   * @return true если данные есть, false по таймауту или после wakeAll()
+   */
+  template <typename Predicate>
+  bool wait(Predicate ready, std::chrono::milliseconds timeout) {
+    if (ready()) {
+      return true;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const uint64_t generation = m_generation;
+    m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    m_condition.wait_for(lock, timeout, [&] {
+      return ready() || m_generation != generation;
+    });
+    m_waiters.fetch_sub(1, std::memory_order_relaxed);
+    return ready();
+  }
+
+  /**
+   * @brief разбудить ждущих после публикации данных (поток писателя)
+   */
+  void notify() {
+    // публикация данных не должна переупорядочиться с чтением m_waiters
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiters.load(std::memory_order_relaxed) == 0) {
+      return;
+    }
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+    }
+    m_condition.notify_all();
+  }
+
+  /**
+   * @brief разбудить всех ждущих даже без данных (например, при остановке)
+   */
+  void wakeAll() {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      ++m_generation;
+    }
+    m_condition.notify_all();
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::atomic<int> m_waiters; // сколько читателей сейчас спит
+  uint64_t m_generation;      // счетчик wakeAll(), под m_mutex
+};
+
+#endif // DATAWAITER_H
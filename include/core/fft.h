@@ -3,6 +3,9 @@
 
 #include <cmath>
 #include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 /**
@@ -10,6 +13,84 @@
  */
 namespace FFT {
 
+/**
+ * @brief план БПФ вещественного сигнала фиксированного размера
+ *
+ * хранит заранее посчитанные поворотные множители и таблицу
+ * бит-реверса. вещественный сигнал из n точек упаковывается в n/2
+ * комплексных (четные - в вещественную часть, нечетные - в мнимую),
+ * преобразуется БПФ половинной длины и раскладывается обратно в n/2+1
+ * бинов спектра. план неизменяем и может использоваться из нескольких
+ * потоков одновременно
+ */
+class RealFftPlan {
+public:
+  /**
+   * @brief конструктор
+   * @param size размер БПФ, степень двойки не меньше 4
+   */
+  explicit RealFftPlan(size_t size);
+
+  /**
+   * @brief размер БПФ
+   */
+  size_t size() const { return m_size; }
+
+  /**
+   * @brief сколько бинов дает forward(): size/2 + 1 (от 0 до Найквиста)
+   */
+  size_t binCount() const { return m_size / 2 + 1; }
+
+  /**
+   * @brief прямое БПФ без выделения памяти
+   *
+   * @param input отсчеты сигнала
+   * @param count количество отсчетов, не больше size(); недостающие
+   * дополняются нулями
+   * @param output буфер вызывающего минимум на binCount() элементов
+   */
+  void forward(const float *input, size_t count,
+               std::complex<double> *output) const;
+
+private:
+  size_t m_size;
+  size_t m_half;
+  std::vector<uint32_t> m_bitReverse;             // для БПФ длины n/2
+  std::vector<std::complex<double>> m_twiddles;   // exp(-2pi*i*j/(n/2))
+  std::vector<std::complex<double>> m_realSplit;  // exp(-2pi*i*k/n)
+};
+
+/**
+ * @brief получить план нужного размера из общего кэша
+ *
+ * планы создаются один раз на размер, потокобезопасно
+ *
+ * @param size размер БПФ, степень двойки не меньше 4
+ * @return разделяемый план
+ */
+std::shared_ptr<const RealFftPlan> getPlan(size_t size);
+
+/**
+ * @brief модули комплексного спектра
+ *
+ * @param spectrum спектр
+ * @param count количество бинов
+ * @param amplitudes куда писать, минимум count элементов
+ */
+void computeAmplitudes(const std::complex<double> *spectrum, size_t count,
+                       double *amplitudes);
+
+/**
+ * @brief частоты бинов БПФ в гц
+ *
+ * @param fftSize размер БПФ
+ * @param sampleRate частота дискретизации гц
+ * @param frequencies куда писать
+ * @param count сколько бинов заполнить
+ */
+void computeFrequencies(size_t fftSize, double sampleRate,
+                        double *frequencies, size_t count);
+
 /**
  * @brief вычислить FFT для вещественного сигнала
  *
@@ -0,0 +1,82 @@
+#ifndef IBUFFERREADER_H
+#define IBUFFERREADER_H
+
+#include "latency.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief интерфейс читающей стороны буфера
+ * @details через него FilterThread и DataProcessor читают входные данные,
+ * не зная, мьютексный это буфер или lock-free
+ * @tparam T тип данных
+ */
+template <typename T> class IBufferReader {
+public:
+  virtual ~IBufferReader() = default;
+
+  /**
+   * @brief забрать до maxCount элементов в массив вызывающего
+   * @param out куда писать
+   * @param maxCount сколько максимум забрать
+   * @return сколько забрано
+   */
+  virtual size_t popBulk(T *out, size_t maxCount) = 0;
+
+  /**
+   * @brief то же, что popBulk, плюс метки времени каждого элемента
+   *
+   * метки хранит только BroadcastRingBuffer, остальные буферы отдают
+   * пустые метки (0)
+   *
+   * @param stamps куда писать метки, не меньше maxCount
+   */
+  virtual size_t popBulkStamped(T *out, SampleStamp *stamps,
+                                size_t maxCount) {
+    size_t count = popBulk(out, maxCount);
+    std::fill(stamps, stamps + count, SampleStamp());
+    return count;
+  }
+
+  /**
+   * @brief забрать все элементы
+   * @return вектор с элементами в порядке от старого к новому
+   */
+  virtual std::vector<T> popAll() = 0;
+
+  /**
+   * @brief сколько элементов можно прочитать
+   */
+  virtual size_t size() const = 0;
+
+  /**
+   * @brief пуст ли буфер
+   */
+  virtual bool empty() const = 0;
+
+  /**
+   * @brief вместимость буфера
+   */
+  virtual size_t capacity() const = 0;
+
+  /**
+   * @brief ждать появления данных
+   *
+   * писатель будит ждущих один раз на опубликованный блок
+   *
+   * @param timeout максимальное время ожидания
+   * @return true если есть что читать, false по таймауту или после
+   * wakeWaiters()
+   */
+  virtual bool waitForData(std::chrono::milliseconds timeout) = 0;
+
+  /**
+   * @brief разбудить всех, кто ждет в waitForData (например, при остановке
+   * потока-читателя)
+   */
+  virtual void wakeWaiters() = 0;
+};
+
+#endif // IBUFFERREADER_H
@@ -0,0 +1,66 @@
+#ifndef KEYVALUE_H
+#define KEYVALUE_H
+
+#include <functional>
+#include <string>
+
+/**
+ * @brief файлы настроек "ключ = значение" и разбор значений
+ *
+ * общие для pidheadless, pidsim и pidscenario. ошибки значения
+ * сообщаются std::invalid_argument с именем ключа
+ */
+namespace KeyValue {
+
+/**
+ * @brief строка без пробелов по краям
+ */
+std::string trim(const std::string &text);
+
+/**
+ * @brief прочитать файл строк "ключ = значение"
+ *
+ * пустые строки и комментарии с '#' пропускаются, ключ и значение
+ * передаются без пробелов по краям
+ *
+ * @param path путь к файлу
+ * @param set обработчик пары, может бросить std::invalid_argument
+ * @throws std::runtime_error если файл не открылся, в строке нет '=' или
+ * обработчик отверг пару (с именем файла и номером строки)
+ */
+void readFile(
+    const std::string &path,
+    const std::function<void(const std::string &key, const std::string &value)>
+        &set);
+
+/**
+ * @brief число
+ * @throws std::invalid_argument если это не число
+ */
+double parseNumber(const std::string &key, const std::string &value);
+
+/**
+ * @brief число в [min, max]
+ * @throws std::invalid_argument если это не число или оно вне диапазона
+ */
+double parseNumber(const std::string &key, const std::string &value,
+                   double min, double max);
+
+/**
+ * @brief целое без знака в [min, max]
+ * @throws std::invalid_argument если это не целое или оно вне диапазона
+ */
+unsigned long long parseUnsigned(const std::string &key,
+                                 const std::string &value,
+                                 unsigned long long min,
+                                 unsigned long long max);
+
+/**
+ * @brief true/false, 1/0 или yes/no
+ * @throws std::invalid_argument если значение другое
+ */
+bool parseBool(const std::string &key, const std::string &value);
+
+} // namespace KeyValue
+
+#endif // KEYVALUE_H
@@ -0,0 +1,152 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief монотонное время в нс (steady_clock), общее для всех потоков
+ */
+inline uint64_t monotonicNs() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+/**
+ * @brief метки времени одного отсчета в журнале
+ *
+ * receivedNs - когда датаграмма с отсчетом вышла из сокета, переносится
+ * через все стадии. publishedNs - когда отсчет опубликован в журнал, из
+ * которого его прочитали. 0 - метки нет (буфер без меток)
+ */
+struct SampleStamp {
+  uint64_t receivedNs = 0;
+  uint64_t publishedNs = 0;
+};
+
+/**
+ * @brief сводка гистограммы задержек, мкс
+ */
+struct LatencySummary {
+  uint64_t count = 0;
+  double p50Us = 0.0;
+  double p99Us = 0.0;
+  double maxUs = 0.0;
+};
+
+/**
+ * @brief гистограмма задержек в духе HDR Histogram
+ *
+ * корзины log-linear: до 128 нс - по одной на наносекунду, дальше в
+ * каждой степени двойки 64 корзины, то есть ошибка значения не больше
+ * 1/64 (~1.6%) на всем диапазоне от 1 нс до ~18 минут. больше - в
+ * последнюю корзину
+ *
+ * record() - один relaxed fetch_add без блокировок, писать можно из
+ * нескольких потоков сразу. summarize()/takeInterval() читают из
+ * любого потока; отсчет, записанный во время чтения, может попасть в
+ * этот интервал или в следующий
+ */
+class LatencyHistogram {
+public:
+  LatencyHistogram();
+
+  LatencyHistogram(const LatencyHistogram &) = delete;
+  LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+  /**
+   * @brief учесть одну задержку
+   * @param ns задержка в нс
+   */
+  void record(uint64_t ns) {
+    m_counts[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (ns > max && !m_max.compare_exchange_weak(
+                           max, ns, std::memory_order_relaxed)) {
+    }
+  }
+
+  /**
+   * @brief учесть разницу now - since, если since известен (не 0)
+   */
+  void recordSince(uint64_t since, uint64_t now) {
+    if (since != 0 && now >= since) {
+      record(now - since);
+    }
+  }
+
+  /**
+   * @brief p50/p99/max за все время с последнего сброса
+   */
+  LatencySummary summarize() const;
+
+  /**
+   * @brief p50/p99/max с прошлого вызова, гистограмма сбрасывается
+   */
+  LatencySummary takeInterval();
+
+  /**
+   * @brief сбросить все корзины
+   */
+  void reset();
+
+private:
+  static constexpr unsigned SUB_BUCKET_BITS = 7;
+  static constexpr uint64_t SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+  static constexpr uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+  static constexpr unsigned MAX_VALUE_BITS = 40;
+  static constexpr size_t BUCKET_COUNT =
+      (MAX_VALUE_BITS - SUB_BUCKET_BITS + 2) * SUB_BUCKET_HALF;
+
+  static size_t bucketIndex(uint64_t ns) {
+    if (ns < SUB_BUCKET_COUNT) {
+      return static_cast<size_t>(ns);
+    }
+    const uint64_t limit = (1ull << MAX_VALUE_BITS) - 1;
+    if (ns > limit) {
+      ns = limit;
+    }
+    unsigned highest = 63;
+    while (!(ns >> highest)) {
+      --highest;
+    }
+    // сдвиг, после которого в значении остается SUB_BUCKET_BITS бит
+    const unsigned shift = highest - (SUB_BUCKET_BITS - 1);
+    return static_cast<size_t>(shift * SUB_BUCKET_HALF + (ns >> shift));
+  }
+
+  /**
+   * @brief наибольшее значение, попадающее в корзину
+   */
+  static uint64_t bucketUpperBound(size_t index);
+
+  static LatencySummary
+  summarize(const std::array<uint64_t, BUCKET_COUNT> &counts, uint64_t max);
+
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_counts;
+  std::atomic<uint64_t> m_max;
+};
+
+/**
+ * @brief задержки по стадиям конвейера
+ *
+ * socketToRing - от выхода датаграммы из сокета до публикации отсчета в
+ * журнал сырых данных (включает окно переупорядочивания).
+ * ringToFilter - от публикации сырого отсчета до публикации результата
+ * фильтра. filterToPlot - от публикации в журнал, из которого читает
+ * график, до конца перерисовки (в pidheadless - до записи в вывод).
+ * endToEnd - от сокета до экрана (записи)
+ */
+struct PipelineLatency {
+  LatencyHistogram socketToRing;
+  LatencyHistogram ringToFilter;
+  LatencyHistogram filterToPlot;
+  LatencyHistogram endToEnd;
+};
+
+#endif // LATENCY_H
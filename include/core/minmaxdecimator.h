@@ -0,0 +1,166 @@
+#ifndef MINMAXDECIMATOR_H
+#define MINMAXDECIMATOR_H
+
+#include "datapoint.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief прореживание ряда для отрисовки: min/max на столбец пикселей
+ *
+ * видимый диапазон по времени делится на столбцы по ширине графика в
+ * пикселях. от каждого столбца остаются только точки с минимальным и
+ * максимальным значением (в порядке времени), поэтому линия на экране
+ * выглядит так же, как по всем отсчетам, а точек не больше 2 * столбцов
+ */
+namespace MinMaxDecimator {
+
+/**
+ * @brief сколько точек максимум вернет decimate() для columns столбцов
+ *
+ * 2 точки на столбец и по одной соседней точке за каждым краем диапазона
+ */
+constexpr size_t maxOutputSize(size_t columns) { return 2 * columns + 2; }
+
+/**
+ * @brief проредить отсчеты внутри [keyLower, keyUpper]
+ *
+ * ближайшие отсчеты слева и справа от диапазона копируются как есть,
+ * чтобы линия доходила до краев графика. если отсчетов в диапазоне не
+ * больше 2 * columns, они копируются без прореживания
+ *
+ * @param keys ключи (время), по возрастанию
+ * @param values значения
+ * @param count количество отсчетов
+ * @param keyLower начало видимого диапазона
+ * @param keyUpper конец видимого диапазона
+ * @param columns количество столбцов (ширина графика в пикселях), > 0
+ * @param outKeys куда писать ключи, не меньше maxOutputSize(columns)
+ * @param outValues куда писать значения, не меньше maxOutputSize(columns)
+ * @return сколько точек записано
+ */
+size_t decimate(const double *keys, const double *values, size_t count,
+                double keyLower, double keyUpper, size_t columns,
+                double *outKeys, double *outValues);
+
+/**
+ * @brief сводка min/max по подряд идущим отсчетам
+ *
+ * общая для хранилищ со сводками (TimeSeriesPyramid, HistoryStore):
+ * HistoryStore пишет ее в файлы как есть, поэтому раскладка не меняется
+ */
+struct MinMax {
+  uint32_t minKey;
+  uint32_t maxKey;
+  float min;
+  float max;
+};
+
+/**
+ * @brief сводка по одному отсчету
+ */
+inline MinMax makeMinMax(const DataPoint &point) {
+  return MinMax{point.timestamp, point.timestamp, point.value, point.value};
+}
+
+/**
+ * @brief добавить к сводке следующую за ней по времени
+ *
+ * при равенстве остается более ранний отсчет, как в decimate()
+ */
+inline void merge(MinMax &target, const MinMax &next) {
+  if (next.min < target.min) {
+    target.min = next.min;
+    target.minKey = next.minKey;
+  }
+  if (next.max > target.max) {
+    target.max = next.max;
+    target.maxKey = next.maxKey;
+  }
+}
+
+/**
+ * @brief проход по столбцам, общий для decimate() и хранилищ со сводками
+ *
+ * отсчеты адресуются сквозным номером, хранилище дает три операции:
+ * sampleAt(index) - отсчет (поля timestamp и value), lowerBound(key,
+ * first, last) - первый номер в [first, last) с ключом >= key и
+ * aggregate(first, last) - сводка (поля minKey, maxKey, min, max) по
+ * отсчетам [first, last). хранилище со сводками собирает ее из готовых
+ * сводок, поэтому столбец стоит не больше пары двоичных поисков
+ *
+ * @param first номер первого хранимого отсчета
+ * @param total номер за последним хранимым отсчетом
+ * @param begin первый отсчет с ключом >= keyLower
+ * @param end первый отсчет с ключом > keyUpper
+ * @return сколько точек записано, не больше maxOutputSize(columns)
+ */
+template <typename SampleAt, typename LowerBound, typename Aggregate>
+size_t decimateColumns(uint64_t first, uint64_t total, uint64_t begin,
+                       uint64_t end, double keyLower, double keyUpper,
+                       size_t columns, SampleAt sampleAt,
+                       LowerBound lowerBound, Aggregate aggregate,
+                       double *outKeys, double *outValues) {
+  size_t written = 0;
+  auto emit = [&](double key, double value) {
+    outKeys[written] = key;
+    outValues[written] = value;
+    ++written;
+  };
+  auto emitSample = [&](uint64_t index) {
+    const auto point = sampleAt(index);
+    emit(point.timestamp, point.value);
+  };
+
+  // соседняя точка слева - линия должна входить в график с края
+  if (begin > first) {
+    emitSample(begin - 1);
+  }
+
+  if (end - begin <= 2 * columns) {
+    // прореживать нечего, отдаем точки как есть
+    for (uint64_t i = begin; i < end; ++i) {
+      emitSample(i);
+    }
+  } else {
+    // границы столбцов ищем двоичным поиском, min/max столбца отдает
+    // хранилище
+    const double width = keyUpper - keyLower;
+    uint64_t from = begin;
+    for (size_t column = 0; column < columns && from < end; ++column) {
+      uint64_t last = end;
+      if (column + 1 < columns) {
+        double boundary = keyLower + width * static_cast<double>(column + 1) /
+                                         static_cast<double>(columns);
+        last = lowerBound(boundary, from, end);
+      }
+      if (last == from) {
+        continue;
+      }
+
+      // одна точка, если min и max совпали, иначе обе в порядке времени
+      const auto summary = aggregate(from, last);
+      if (summary.minKey == summary.maxKey && summary.min == summary.max) {
+        emit(summary.minKey, summary.min);
+      } else if (summary.minKey <= summary.maxKey) {
+        emit(summary.minKey, summary.min);
+        emit(summary.maxKey, summary.max);
+      } else {
+        emit(summary.maxKey, summary.max);
+        emit(summary.minKey, summary.min);
+      }
+      from = last;
+    }
+  }
+
+  // соседняя точка справа
+  if (end < total) {
+    emitSample(end);
+  }
+
+  return written;
+}
+
+} // namespace MinMaxDecimator
+
+#endif // MINMAXDECIMATOR_H
@@ -31,6 +31,17 @@ public:
     }
   }
 
+  /**
+   * @brief добавить сразу блок элементов
+   * @param items указатель на первый элемент блока
+   * @param count количество элементов
+   */
+  virtual void pushBulk(const T *items, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      RingBuffer<T>::push(items[i]);
+    }
+  }
+
   virtual const T &at(size_t index) const {
     assert(index < m_size && "Index out of range");
     size_t actualIndex = (m_read + index) % m_capacity;
@@ -126,6 +137,22 @@ public:
     return result;
   }
 
+  /**
+   * @brief забрать до maxCount самых старых элементов
+   * @param out куда писать
+   * @param maxCount сколько максимум забрать
+   * @return сколько забрано
+   */
+  virtual size_t popBulk(T *out, size_t maxCount) {
+    size_t count = std::min(maxCount, m_size);
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = m_buffer[(m_read + i) % m_capacity];
+    }
+    m_read = (m_read + count) % m_capacity;
+    m_size -= count;
+    return count;
+  }
+
 protected:
   std::vector<T> m_buffer;
   size_t m_capacity;
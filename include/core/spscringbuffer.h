@@ -0,0 +1,198 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include "Constants.h"
+#include "datawaiter.h"
+#include "ibufferreader.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief lock-free кольцевой буфер на одного писателя и одного читателя
+ *
+ * push/pushBulk вызываются только из одного потока, pop/popBulk/popAll -
+ * только из другого, без блокировок и ожиданий. вместимость округляется
+ * вверх до степени двойки. индексы растут монотонно, позиция в массиве -
+ * индекс & маска
+ *
+ * в отличие от ThreadSafeRingBuffer при переполнении старые данные не
+ * затираются (писатель не может трогать индекс читателя): новые отсчеты
+ * отбрасываются и считаются в getDropped()
+ *
+ * @tparam T тип данных, должен быть копируемым
+ */
+template <typename T> class SpscRingBuffer : public IBufferReader<T> {
+public:
+  /**
+   * @brief конструктор
+   * @param capacity минимальная вместимость буфера
+   */
+  explicit SpscRingBuffer(size_t capacity)
+      : m_capacity(roundUpToPowerOfTwo(capacity)), m_mask(m_capacity - 1),
+        m_buffer(new T[m_capacity]), m_head(0), m_cachedTail(0), m_tail(0),
+        m_cachedHead(0), m_dropped(0) {}
+
+  SpscRingBuffer(const SpscRingBuffer &) = delete;
+  SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+  /**
+   * @brief добавить элемент (поток писателя)
+   * @return false если буфер полон и элемент отброшен
+   */
+  bool push(const T &item) { return pushBulk(&item, 1) == 1; }
+
+  /**
+   * @brief добавить блок элементов (поток писателя)
+   * @param items указатель на первый элемент блока
+   * @param count количество элементов
+   * @return сколько элементов записано, остальные отброшены
+   */
+  size_t pushBulk(const T *items, size_t count) {
+    const size_t head = m_head.load(std::memory_order_relaxed);
+
+    // индекс читателя перечитываем, только если по кэшу места не хватает
+    size_t freeSpace = m_capacity - (head - m_cachedTail);
+    if (freeSpace < count) {
+      m_cachedTail = m_tail.load(std::memory_order_acquire);
+      freeSpace = m_capacity - (head - m_cachedTail);
+    }
+
+    const size_t written = std::min(count, freeSpace);
+    if (written < count) {
+      m_dropped.fetch_add(count - written, std::memory_order_relaxed);
+    }
+    if (written == 0) {
+      return 0;
+    }
+
+    // копируем максимум двумя кусками: до конца массива и с начала
+    const size_t start = head & m_mask;
+    const size_t first = std::min(written, m_capacity - start);
+    std::copy(items, items + first, m_buffer.get() + start);
+    std::copy(items + first, items + written, m_buffer.get());
+
+    m_head.store(head + written, std::memory_order_release);
+    m_waiter.notify();
+    return written;
+  }
+
+  /**
+   * @brief забрать до maxCount элементов (поток читателя)
+   * @param out куда писать
+   * @param maxCount сколько максимум забрать
+   * @return сколько забрано
+   */
+  size_t popBulk(T *out, size_t maxCount) override {
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+
+    size_t available = m_cachedHead - tail;
+    if (available < maxCount) {
+      m_cachedHead = m_head.load(std::memory_order_acquire);
+      available = m_cachedHead - tail;
+    }
+
+    const size_t count = std::min(maxCount, available);
+    if (count == 0) {
+      return 0;
+    }
+
+    const size_t start = tail & m_mask;
+    const size_t first = std::min(count, m_capacity - start);
+    std::copy(m_buffer.get() + start, m_buffer.get() + start + first, out);
+    std::copy(m_buffer.get(), m_buffer.get() + (count - first), out + first);
+
+    m_tail.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  /**
+   * @brief забрать все доступные элементы (поток читателя)
+   * @return вектор с элементами в порядке от старого к новому
+   */
+  std::vector<T> popAll() override {
+    std::vector<T> result(size());
+    result.resize(popBulk(result.data(), result.size()));
+    return result;
+  }
+
+  /**
+   * @brief сколько элементов можно прочитать
+   * @details из чужого потока - приблизительно
+   */
+  size_t size() const override {
+    const size_t tail = m_tail.load(std::memory_order_acquire);
+    const size_t head = m_head.load(std::memory_order_acquire);
+    return head - tail;
+  }
+
+  /**
+   * @brief пуст ли буфер
+   */
+  bool empty() const override { return size() == 0; }
+
+  /**
+   * @brief вместимость (степень двойки)
+   */
+  size_t capacity() const override { return m_capacity; }
+
+  /**
+   * @brief ждать появления данных (поток читателя)
+   * @param timeout максимальное время ожидания
+   * @return true если есть что читать
+   */
+  bool waitForData(std::chrono::milliseconds timeout) override {
+    return m_waiter.wait([this] { return !empty(); }, timeout);
+  }
+
+  /**
+   * @brief разбудить читателя, ждущего в waitForData
+   */
+  void wakeWaiters() override { m_waiter.wakeAll(); }
+
+  /**
+   * @brief сколько элементов отброшено из-за переполнения
+   */
+  size_t getDropped() const { return m_dropped.load(); }
+
+  /**
+   * @brief получить размер памяти, используемой буфером
+   * @return размер памяти в байтах
+   */
+  size_t getMemoryUsage() const {
+    return sizeof(*this) + m_capacity * sizeof(T);
+  }
+
+private:
+  static size_t roundUpToPowerOfTwo(size_t value) {
+    if (value == 0) {
+      throw std::invalid_argument("Capacity must be greater than 0");
+    }
+    size_t result = 1;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  const size_t m_capacity;
+  const size_t m_mask;
+  std::unique_ptr<T[]> m_buffer;
+
+  // данные писателя: свой индекс и последний увиденный индекс читателя.
+  // писатель и читатель не должны делить строку кэша
+  alignas(Constants::CACHE_LINE_SIZE) std::atomic<size_t> m_head;
+  size_t m_cachedTail;
+
+  // данные читателя
+  alignas(Constants::CACHE_LINE_SIZE) std::atomic<size_t> m_tail;
+  size_t m_cachedHead;
+
+  alignas(Constants::CACHE_LINE_SIZE) std::atomic<size_t> m_dropped;
+  DataWaiter m_waiter;
+};
+
+#endif // SPSCRINGBUFFER_H
@@ -1,6 +1,8 @@
 #ifndef THREADSAFERINGBUFFER_H
 #define THREADSAFERINGBUFFER_H
 
+#include "datawaiter.h"
+#include "ibufferreader.h"
 #include "ringbuffer.h"
 #include <mutex>
 #include <vector>
@@ -9,7 +11,8 @@
  * @brief потокобезопасный кольцевой буфер
  * @tparam T тип данных для хранения
  */
-template <typename T> class ThreadSafeRingBuffer : public RingBuffer<T> {
+template <typename T>
+class ThreadSafeRingBuffer : public RingBuffer<T>, public IBufferReader<T> {
 public:
   /**
    * @brief конструктор
@@ -21,8 +24,24 @@ public:
    * @brief добавить элемент потокобезопасно
    */
   void push(const T &item) override {
-    std::unique_lock<std::mutex> lock(m_mutex);
-    RingBuffer<T>::push(item);
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      RingBuffer<T>::push(item);
+    }
+    m_waiter.notify();
+  }
+
+  /**
+   * @brief добавить блок элементов под одной блокировкой
+   * @param items указатель на первый элемент блока
+   * @param count количество элементов
+   */
+  void pushBulk(const T *items, size_t count) override {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      RingBuffer<T>::pushBulk(items, count);
+    }
+    m_waiter.notify();
   }
 
   /**
@@ -133,6 +152,31 @@ public:
     return result;
   }
 
+  /**
+   * @brief забрать до maxCount элементов потокобезопасно
+   * @param out куда писать
+   * @param maxCount сколько максимум забрать
+   * @return сколько забрано
+   */
+  size_t popBulk(T *out, size_t maxCount) override {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return RingBuffer<T>::popBulk(out, maxCount);
+  }
+
+  /**
+   * @brief ждать появления данных
+   * @param timeout максимальное время ожидания
+   * @return true если буфер не пуст
+   */
+  bool waitForData(std::chrono::milliseconds timeout) override {
+    return m_waiter.wait([this] { return !empty(); }, timeout);
+  }
+
+  /**
+   * @brief разбудить всех ждущих в waitForData
+   */
+  void wakeWaiters() override { m_waiter.wakeAll(); }
+
   /**
    * @brief получить размер памяти, используемой буфером потокобезопасно
    * @return размер памяти в байтах включая мьютекс
@@ -147,6 +191,11 @@ private:
    * @brief мьютекс для синхронизации доступа
    */
   mutable std::mutex m_mutex;
+
+  /**
+   * @brief ожидание данных читателями
+   */
+  DataWaiter m_waiter;
 };
 
 #endif // THREADSAFERINGBUFFER_H
@@ -0,0 +1,184 @@
+#ifndef TIMESERIESPYRAMID_H
+#define TIMESERIESPYRAMID_H
+
+#include "datapoint.h"
+#include "minmaxdecimator.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief хранилище временного ряда с уровнями сводок (как mip-уровни)
+ *
+ * кроме самих отсчетов хранит уровни сводок min/max/сумма: сводка уровня
+ * L покрывает FANOUT^L подряд идущих отсчетов и строится из FANOUT сводок
+ * уровня L-1 в момент, когда они готовы, поэтому добавление отсчета
+ * стоит O(1) в среднем
+ *
+ * сводки выровнены по сквозному номеру отсчета. любой диапазон отсчетов
+ * собирается из O(FANOUT * LEVEL_COUNT) готовых сводок, поэтому запрос
+ * столбцов графика по любому диапазону времени стоит O(столбцов), сколько
+ * бы отсчетов в диапазон ни попало, а результат совпадает с прореживанием
+ * MinMaxDecimator по всем отсчетам
+ *
+ * отсчеты должны приходить по возрастанию timestamp: опоздавшие
+ * отбрасываются и считаются в getDropped(), скачок назад больше
+ * Constants::RESTART_GAP_MS считается перезапуском источника и очищает
+ * хранилище
+ *
+ * не потокобезопасно
+ */
+class TimeSeriesPyramid {
+public:
+  static constexpr size_t FANOUT = 16;     // отсчетов сводки на уровень
+  static constexpr size_t LEVEL_COUNT = 6; // уровень 0 - сами отсчеты
+
+  /**
+   * @brief сводка по диапазону
+   */
+  struct Summary {
+    size_t count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+  };
+
+  /**
+   * @brief конструктор
+   * @param capacity сколько последних отсчетов хранить, не меньше FANOUT
+   */
+  explicit TimeSeriesPyramid(size_t capacity);
+
+  /**
+   * @brief добавить отсчет
+   */
+  void append(const DataPoint &point);
+
+  /**
+   * @brief добавить блок отсчетов
+   */
+  void append(const DataPoint *points, size_t count);
+
+  /**
+   * @brief забыть все отсчеты и сводки
+   */
+  void clear();
+
+  /**
+   * @brief сколько отсчетов хранится
+   */
+  size_t size() const;
+
+  /**
+   * @brief пусто ли хранилище
+   */
+  bool empty() const;
+
+  /**
+   * @brief сколько последних отсчетов хранится максимум
+   */
+  size_t capacity() const;
+
+  /**
+   * @brief ключ index-го хранимого отсчета (0 - самый старый)
+   */
+  double keyAt(size_t index) const;
+
+  /**
+   * @brief ключ самого нового отсчета (хранилище не пустое)
+   */
+  double lastKey() const;
+
+  /**
+   * @brief точки для отрисовки диапазона [keyLower, keyUpper]
+   *
+   * тот же контракт, что у MinMaxDecimator::decimate: min и max на
+   * столбец в порядке времени плюс ближайшие отсчеты за краями, не больше
+   * MinMaxDecimator::maxOutputSize(columns) точек
+   *
+   * @param keyLower начало диапазона
+   * @param keyUpper конец диапазона
+   * @param columns количество столбцов (ширина графика в пикселях), > 0
+   * @param outKeys куда писать ключи
+   * @param outValues куда писать значения
+   * @return сколько точек записано
+   */
+  size_t query(double keyLower, double keyUpper, size_t columns,
+               double *outKeys, double *outValues) const;
+
+  /**
+   * @brief min/max/среднее по диапазону [keyLower, keyUpper]
+   */
+  Summary summarize(double keyLower, double keyUpper) const;
+
+  /**
+   * @brief сколько отсчетов отброшено как опоздавшие
+   */
+  uint64_t getDropped() const;
+
+  /**
+   * @brief сколько памяти занимают отсчеты и сводки (байт)
+   */
+  size_t getMemoryUsage() const;
+
+private:
+  /**
+   * @brief сводка по подряд идущим отсчетам
+   */
+  struct Bucket {
+    MinMaxDecimator::MinMax range;
+    double sum;
+    uint32_t count;
+  };
+
+  /**
+   * @brief готовые сводки одного уровня
+   *
+   * старые сводки отрезаются сдвигом begin, память сжимается пачкой
+   */
+  struct Level {
+    std::vector<Bucket> buckets;
+    size_t begin = 0;       // первая хранимая сводка в buckets
+    uint64_t firstIndex = 0; // сквозной номер сводки buckets[begin]
+  };
+
+  static Bucket makeBucket(const DataPoint &point);
+  static void merge(Bucket &target, const Bucket &next);
+
+  uint64_t totalCount() const; // сквозной номер следующего отсчета
+  const DataPoint &sampleAt(uint64_t index) const;
+  bool hasBucket(size_t level, uint64_t index) const;
+  const Bucket &bucketAt(size_t level, uint64_t index) const;
+
+  /**
+   * @brief сквозной номер первого отсчета с ключом >= key (или > key)
+   */
+  uint64_t lowerBound(double key, uint64_t first, uint64_t last) const;
+  uint64_t upperBound(double key, uint64_t first, uint64_t last) const;
+
+  /**
+   * @brief сводка по отсчетам [first, last) из самых крупных готовых сводок
+   */
+  Bucket aggregate(uint64_t first, uint64_t last) const;
+
+  /**
+   * @brief достроить сводки, готовые после добавления очередного отсчета
+   */
+  void completeBuckets();
+
+  /**
+   * @brief отрезать отсчеты старше capacity (пачкой, а не по одному)
+   */
+  void trim();
+
+  size_t m_capacity;
+
+  std::vector<DataPoint> m_samples;
+  size_t m_samplesBegin;   // первый хранимый отсчет в m_samples
+  uint64_t m_firstIndex;   // сквозной номер m_samples[m_samplesBegin]
+  Level m_levels[LEVEL_COUNT]; // m_levels[0] не используется
+
+  uint64_t m_dropped;
+};
+
+#endif // TIMESERIESPYRAMID_H
@@ -0,0 +1,108 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "latency.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief трассировка стадий конвейера в формате Chrome trace
+ *
+ * TRACE_SCOPE("имя") в начале блока отмечает его длительность. события
+ * пишутся в буфер своего потока без блокировок: у каждого потока кольцо
+ * на EVENTS_PER_THREAD событий, при переполнении затираются самые
+ * старые. буфер потока заводится при первом событии, то есть только
+ * если трассировка хоть раз включалась. поток с именем завершившегося
+ * потока продолжает его буфер, буферы завершившихся потоков
+ * освобождаются после writeChromeJson() и clear()
+ *
+ * выключенная трассировка стоит одной relaxed загрузки флага на
+ * TRACE_SCOPE. включать и выключать можно в любой момент из любого
+ * потока; writeChromeJson() можно вызывать и на ходу, события,
+ * затертые во время выгрузки, в файл не попадают
+ *
+ * имя события - строковый литерал (хранится указатель)
+ */
+namespace Trace {
+
+/**
+ * @brief сколько последних событий хранит один поток
+ */
+constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+namespace detail {
+extern std::atomic<bool> enabled;
+void record(const char *name, uint64_t startNs, uint64_t endNs);
+} // namespace detail
+
+/**
+ * @brief включена ли трассировка
+ */
+inline bool isEnabled() {
+  return detail::enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief включить/выключить запись событий
+ */
+void setEnabled(bool enabled);
+
+/**
+ * @brief имя текущего потока в трассе (вызывать в начале потока)
+ */
+void setThreadName(const std::string &name);
+
+/**
+ * @brief забыть все записанные события; буферы завершившихся потоков
+ * освобождаются
+ */
+void clear();
+
+/**
+ * @brief сколько событий сейчас хранится во всех потоках
+ */
+size_t eventCount();
+
+/**
+ * @brief записать трассу в JSON для chrome://tracing и Perfetto
+ *
+ * события "X" (начало и длительность в мкс) и имена потоков
+ * (метаданные "thread_name"). после записи события завершившихся
+ * потоков забываются
+ *
+ * @return false если файл не открылся или запись не удалась
+ */
+bool writeChromeJson(const std::string &path);
+
+} // namespace Trace
+
+/**
+ * @brief длительность блока: от конструктора до деструктора
+ */
+class TraceScope {
+public:
+  explicit TraceScope(const char *name)
+      : m_name(Trace::isEnabled() ? name : nullptr),
+        m_startNs(m_name ? monotonicNs() : 0) {}
+
+  ~TraceScope() {
+    if (m_name) {
+      Trace::detail::record(m_name, m_startNs, monotonicNs());
+    }
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *m_name; // nullptr - трассировка была выключена
+  uint64_t m_startNs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+#endif // TRACE_H
@@ -3,6 +3,7 @@
 
 #include "../core/Constants.h"
 #include "filterbase.h"
+#include <atomic>
 #include <cstddef>
 
 /**
@@ -31,7 +32,13 @@ public:
   DataPoint filter(const DataPoint &input) override;
 
   /**
-   * @brief сброс
+   * @brief блок целиком: состояние держим в регистрах, все точки готовы
+   */
+  size_t processBlock(const DataPoint *input, size_t count,
+                      DataPoint *output) override;
+
+  /**
+   * @brief сброс (можно из GUI потока, применяется на следующем блоке)
    */
   void reset() override;
 
@@ -42,6 +49,10 @@ public:
 
   /**
    * @brief установить коэффициент сглаживания
+   *
+   * можно вызывать из GUI потока: поток фильтра возьмет новый
+   * коэффициент и сбросит состояние на следующем блоке
+   *
    * @param alpha коэффициент сглаживания
    */
   void setAlpha(double alpha);
@@ -58,10 +69,25 @@ public:
   size_t getMemoryUsage() const override;
 
 private:
+  /**
+   * @brief применить сброс, заданный из GUI потока
+   */
+  void applyPendingSettings();
+
+  /**
+   * @brief привести коэффициент к допустимому
+   */
+  static double clampAlpha(double alpha);
+
   /**
    * @brief коэффициент сглаживания
    */
-  double m_alpha;
+  std::atomic<double> m_alpha;
+
+  /**
+   * @brief состояние нужно сбросить
+   */
+  std::atomic<bool> m_resetRequested;
 
   /**
    * @brief предыдущее значение
@@ -32,6 +32,13 @@ public:
    */
   std::string getName() const override;
 
+  /**
+   * @brief обработка блока по умолчанию: filter() и isReady() на каждую
+   * точку. фильтры переопределяют его более плотным циклом
+   */
+  size_t processBlock(const DataPoint *input, size_t count,
+                      DataPoint *output) override;
+
 protected:
   /**
    * @brief имя фильтра
@@ -26,6 +26,20 @@ public:
    */
   virtual DataPoint filter(const DataPoint &input) = 0;
 
+  /**
+   * @brief применить фильтр к блоку данных
+   *
+   * то же, что filter() + isReady() для каждой точки, но одним вызовом на
+   * блок. в output пишутся только результаты, на которых фильтр был готов
+   *
+   * @param input входные точки
+   * @param count количество входных точек
+   * @param output куда писать результаты, место минимум под count точек
+   * @return сколько результатов записано в output
+   */
+  virtual size_t processBlock(const DataPoint *input, size_t count,
+                              DataPoint *output) = 0;
+
   /**
    * @brief сбросить состояние фильтра
    *
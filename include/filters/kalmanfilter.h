@@ -3,11 +3,14 @@
 
 #include "../core/Constants.h"
 #include "filterbase.h"
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 
 /**
  * @brief фильтр Калмана
+ * @details параметры и сброс можно задавать из GUI потока: поток фильтра
+ * применяет их в начале следующего блока (отсчета)
  */
 class KalmanFilter final
     : public FilterBase // девиртуализирую класс -> оптимизация
@@ -27,10 +30,15 @@ public:
   virtual ~KalmanFilter() = default;
 
   DataPoint filter(const DataPoint &input) override;
+  size_t processBlock(const DataPoint *input, size_t count,
+                      DataPoint *output) override;
+  /**
+   * @brief сбросить состояние (применяется на следующем блоке)
+   */
   void reset() override;
   bool isReady() const override;
 
-  // сеттеры и геттеры для параметров
+  // сеттеры и геттеры для параметров, сеттеры сбрасывают состояние
   void setQ(double q);
   double getQ() const;
 
@@ -46,8 +54,21 @@ public:
   size_t getMemoryUsage() const override;
 
 private:
-  double m_q; // шум процесса
-  double m_r; // шум измерения
+  /**
+   * @brief применить сброс, заданный из GUI потока
+   */
+  void applyPendingSettings();
+
+  /**
+   * @brief один шаг фильтра с уже прочитанными параметрами
+   */
+  DataPoint step(const DataPoint &input, double q, double r);
+
+  std::atomic<double> m_q;            // шум процесса
+  std::atomic<double> m_r;            // шум измерения
+  std::atomic<double> m_initialP;     // начальная ковариация
+  std::atomic<bool> m_resetRequested; // состояние нужно сбросить
+
   double m_p; // ковариация (текущая)
 
   // состояние фильтра (модель с ускорением)
@@ -3,11 +3,14 @@
 
 #include "../core/Constants.h"
 #include "filterbase.h"
+#include "slidingmedian.h"
+#include <atomic>
 #include <cstddef>
-#include <deque>
 
 /**
  * @brief медианный фильтр
+ * @details окно ведет SlidingMedian: O(log W) на отсчет без выделений
+ * памяти, поэтому окно может быть в тысячи отсчетов
  */
 class MedianFilter final
     : public FilterBase // девиртуализирую класс -> оптимизация
@@ -23,20 +26,36 @@ public:
   virtual ~MedianFilter() = default;
 
   DataPoint filter(const DataPoint &input) override;
+  size_t processBlock(const DataPoint *input, size_t count,
+                      DataPoint *output) override;
+
+  /**
+   * @brief сбросить окно (можно из GUI потока, применяется на следующем
+   * отсчете)
+   */
   void reset() override;
   bool isReady() const override;
 
+  /**
+   * @brief установить размер окна (можно из GUI потока)
+   * @details применяется потоком фильтра на следующем отсчете, окно
+   * при этом очищается
+   */
   void setWindowSize(size_t windowSize);
   size_t getWindowSize() const;
 
   size_t getMemoryUsage() const override;
 
 private:
-  /** @brief возвращает медиану текущего окна без изменения окна */
-  float computeMedian() const;
+  /** @brief применить размер окна и сброс, заданные из GUI потока */
+  void applyPendingSettings();
+
+  /** @brief привести размер окна к допустимому нечетному */
+  static size_t clampWindowSize(size_t windowSize);
 
-  size_t m_windowSize;
-  std::deque<float> m_window;
+  std::atomic<size_t> m_windowSize;  // заданный размер окна
+  std::atomic<bool> m_resetRequested; // окно нужно очистить
+  SlidingMedian m_window;             // окно, размер которого уже применен
 };
 
 #endif // MEDIANFILTER_H
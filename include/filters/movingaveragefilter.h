@@ -3,12 +3,14 @@
 
 #include "../core/Constants.h"
 #include "filterbase.h"
+#include "slidingsum.h"
+#include <atomic>
 #include <cstddef>
-#include <deque> // Для хранения окна значений
 
 /**
  * @brief фильтр скользящего среднего
- * @details фильтр скользящего среднего
+ * @details окно ведет SlidingSum: O(1) на отсчет независимо от размера
+ * окна, сумма компенсированная и не уплывает на долгих прогонах
  */
 class MovingAverageFilter final
     : public FilterBase { // девиртуализирую класс -> оптимизация
@@ -27,9 +29,12 @@ public:
   virtual ~MovingAverageFilter() = default;
 
   DataPoint filter(const DataPoint &input) override;
+  size_t processBlock(const DataPoint *input, size_t count,
+                      DataPoint *output) override;
 
   /**
-   * @brief сбросить состояние фильтра
+   * @brief сбросить состояние фильтра (можно из GUI потока, применяется
+   * на следующем отсчете)
    */
   void reset() override;
   bool isReady() const override;
@@ -37,7 +42,8 @@ public:
   /**
    * @brief установить размер окна
    *
-   * изменяет размер окна. старые данные очищаются.
+   * изменяет размер окна. старые данные очищаются. можно вызывать из GUI
+   * потока: поток фильтра применит размер на следующем отсчете.
    *
    * @param windowSize новый размер окна
    */
@@ -57,15 +63,18 @@ public:
 
 private:
   /**
-   * @brief вычислить среднее арифметическое значений в окне
-   *
-   * @return среднее значение
+   * @brief применить размер окна и сброс, заданные из GUI потока
+   */
+  void applyPendingSettings();
+
+  /**
+   * @brief привести размер окна к допустимому
    */
-  float calculateAverage() const;
+  static size_t clampWindowSize(size_t windowSize);
 
-  size_t m_windowSize; // размер окна
-  std::deque<float>
-      m_window; // окно значений, deque потому что быстрее чем vector
+  std::atomic<size_t> m_windowSize;   // заданный размер окна
+  std::atomic<bool> m_resetRequested; // окно нужно очистить
+  SlidingSum m_window;                // окно значений с бегущей суммой
 };
 
 #endif // MOVINGAVERAGEFILTER_H
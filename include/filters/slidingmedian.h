@@ -0,0 +1,108 @@
+#ifndef SLIDINGMEDIAN_H
+#define SLIDINGMEDIAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief медиана скользящего окна за O(log W) на отсчет
+ *
+ * значения окна хранятся в индексируемом skiplist'е (у каждой ссылки есть
+ * ширина - сколько узлов она перепрыгивает), поэтому вставка, удаление и
+ * поиск k-го по величине стоят O(log W). узлы берутся из пула, выделенного
+ * один раз при setCapacity(), так что на отсчет нет выделений памяти.
+ * порядок поступления помнит кольцо значений: самое старое удаляется из
+ * skiplist'а по значению (какой из равных узлов удалить - неважно)
+ */
+class SlidingMedian {
+public:
+  /**
+   * @brief конструктор
+   * @param capacity размер окна
+   */
+  explicit SlidingMedian(size_t capacity);
+
+  /**
+   * @brief задать размер окна (окно очищается, пул выделяется заново)
+   */
+  void setCapacity(size_t capacity);
+
+  /**
+   * @brief размер окна
+   */
+  size_t capacity() const;
+
+  /**
+   * @brief сколько значений сейчас в окне
+   */
+  size_t size() const;
+
+  /**
+   * @brief добавить значение, при полном окне вытесняется самое старое
+   * @details NaN пропускается: он не упорядочивается и сломал бы список
+   */
+  void push(float value);
+
+  /**
+   * @brief медиана окна (для четного числа значений - нижняя), 0 если пусто
+   */
+  float median() const;
+
+  /**
+   * @brief k-е по возрастанию значение окна, k < size()
+   */
+  float at(size_t k) const;
+
+  /**
+   * @brief очистить окно, пул остается
+   */
+  void clear();
+
+  /**
+   * @brief размер памяти, занятой окном и пулом узлов
+   * @return размер в байтах
+   */
+  size_t getMemoryUsage() const;
+
+private:
+  static constexpr uint32_t HEAD = 0; // голова списка
+  static constexpr uint32_t NIL = 1;  // терминатор со значением +inf
+  static constexpr uint32_t FIRST_NODE = 2;
+
+  void insert(float value);
+  void remove(float value);
+  size_t randomLevel();
+
+  uint32_t &next(uint32_t node, size_t level) {
+    return m_next[node * m_levels + level];
+  }
+  uint32_t next(uint32_t node, size_t level) const {
+    return m_next[node * m_levels + level];
+  }
+  uint32_t &width(uint32_t node, size_t level) {
+    return m_width[node * m_levels + level];
+  }
+  uint32_t width(uint32_t node, size_t level) const {
+    return m_width[node * m_levels + level];
+  }
+
+  size_t m_capacity;
+  size_t m_levels; // число уровней, ~log2(capacity) + 1
+
+  // пул узлов: значение, высота и по m_levels ссылок/ширин на узел
+  std::vector<float> m_values;
+  std::vector<uint8_t> m_heights;
+  std::vector<uint32_t> m_next;
+  std::vector<uint32_t> m_width;
+  std::vector<uint32_t> m_freeNodes;
+
+  // значения окна в порядке поступления
+  std::vector<float> m_fifo;
+  size_t m_fifoStart;
+  size_t m_size;
+
+  uint32_t m_random; // состояние xorshift для высот узлов
+};
+
+#endif // SLIDINGMEDIAN_H
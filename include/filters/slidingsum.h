@@ -0,0 +1,85 @@
+#ifndef SLIDINGSUM_H
+#define SLIDINGSUM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief сумма и среднее скользящего окна за O(1) на отсчет
+ *
+ * окно хранится в кольце фиксированного размера, сумма ведется
+ * инкрементально: новое значение прибавляется, вытесненное вычитается.
+ * чтобы ошибка округления не накапливалась часами, сумма компенсированная
+ * (Неймайер) в double и раз в RESYNC_INTERVAL отсчетов пересчитывается
+ * по окну заново
+ */
+class SlidingSum {
+public:
+  /**
+   * @brief через сколько отсчетов сумма пересчитывается точно
+   */
+  static constexpr size_t RESYNC_INTERVAL = 65536;
+
+  /**
+   * @brief конструктор
+   * @param capacity размер окна
+   */
+  explicit SlidingSum(size_t capacity);
+
+  /**
+   * @brief задать размер окна (окно очищается)
+   */
+  void setCapacity(size_t capacity);
+
+  /**
+   * @brief размер окна
+   */
+  size_t capacity() const;
+
+  /**
+   * @brief сколько значений сейчас в окне
+   */
+  size_t size() const;
+
+  /**
+   * @brief добавить значение, при полном окне вытесняется самое старое
+   */
+  void push(float value);
+
+  /**
+   * @brief сумма значений окна
+   */
+  double sum() const;
+
+  /**
+   * @brief среднее значений окна, 0 если пусто
+   */
+  float mean() const;
+
+  /**
+   * @brief очистить окно
+   */
+  void clear();
+
+  /**
+   * @brief размер памяти, занятой окном
+   * @return размер в байтах
+   */
+  size_t getMemoryUsage() const;
+
+private:
+  void add(double value);
+  void resync();
+
+  std::vector<float> m_ring; // значения окна, m_ring.size() - размер окна
+  size_t m_start;            // индекс самого старого значения
+  size_t m_size;
+
+  double m_sum;          // сумма конечных значений
+  double m_compensation; // накопленная ошибка округления m_sum
+  size_t m_nonFinite;    // сколько в окне NaN/inf, их в m_sum нет
+  size_t m_sinceResync;  // отсчетов с последнего точного пересчета
+};
+
+#endif // SLIDINGSUM_H
@@ -0,0 +1,66 @@
+#ifndef HEADLESSCONFIG_H
+#define HEADLESSCONFIG_H
+
+#include "../core/Constants.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief настройки конвейера без GUI
+ *
+ * файл - строки "ключ = значение", пустые строки и комментарии с '#'
+ * пропускаются. незаданные ключи остаются по умолчанию (как в GUI):
+ *
+ *   receive_ip, receive_port, reorder_window_ms - прием
+ *   filters - фильтры через запятую: moving_average, median,
+ *     exponential, kalman (или none)
+ *   moving_average_window, median_window, exponential_alpha, kalman_q,
+ *     kalman_r - параметры фильтров
+ *   output - файл для отфильтрованных отсчетов, "-" - stdout, пусто -
+ *     никуда (только статистика)
+ *   output_raw - писать ли в output и сырые отсчеты
+ *   stats_interval_ms - как часто печатать статистику в stderr
+ *   duration_s - сколько работать, 0 - до Ctrl+C
+ *   trace - файл для трассы стадий (Chrome trace JSON), пишется при
+ *     завершении; пусто - трассировка выключена
+ */
+struct HeadlessConfig {
+  std::string receiveIp = Constants::Network::DEFAULT_RECEIVE_IP;
+  // GUI слушает DEFAULT_SEND_PORT: имена портов - со стороны модели
+  uint16_t receivePort = Constants::Network::DEFAULT_SEND_PORT;
+  uint32_t reorderWindowMs = Constants::Network::DEFAULT_REORDER_WINDOW_MS;
+
+  bool movingAverage = true;
+  bool median = true;
+  bool exponential = true;
+  bool kalman = true;
+  size_t movingAverageWindow =
+      Constants::Filters::DEFAULT_MOVING_AVERAGE_WINDOW;
+  size_t medianWindow = Constants::Filters::DEFAULT_MEDIAN_WINDOW;
+  double exponentialAlpha = Constants::Filters::DEFAULT_EXPONENTIAL_ALPHA;
+  double kalmanQ = Constants::Filters::DEFAULT_KALMAN_Q;
+  double kalmanR = Constants::Filters::DEFAULT_KALMAN_R;
+
+  std::string output;
+  bool outputRaw = false;
+  uint32_t statsIntervalMs = 1000;
+  double durationSeconds = 0.0;
+  std::string trace;
+
+  /**
+   * @brief прочитать настройки из файла
+   * @throws std::runtime_error если файл не читается или в нем ошибка
+   * (с номером строки)
+   */
+  static HeadlessConfig load(const std::string &path);
+
+  /**
+   * @brief задать один параметр
+   * @throws std::invalid_argument если ключ неизвестен или значение
+   * не подходит
+   */
+  void set(const std::string &key, const std::string &value);
+};
+
+#endif // HEADLESSCONFIG_H
@@ -0,0 +1,96 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include "../core/broadcastringbuffer.h"
+#include "../core/datapoint.h"
+#include "../core/latency.h"
+#include "../filters/ifilter.h"
+#include "../network/networkcontroller.h"
+#include "../processing/dataprocessor.h"
+#include "headlessconfig.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief конвейер прием -> фильтры -> файл без GUI
+ *
+ * собирает из HeadlessConfig то же, что MainWindow: журнал сырых
+ * отсчетов, NetworkController и DataProcessor с выбранными фильтрами.
+ * вызывающий поток забирает результаты фильтров, пишет их строками
+ * "series,timestamp,value" и раз в stats_interval_ms печатает в stderr
+ * статистику: отсчетов в секунду на приеме и на каждом фильтре, потери
+ * и задержки по стадиям за интервал (p50/p99/max, см. PipelineLatency):
+ * сокет -> журнал, журнал -> фильтр, фильтр -> запись и сокет -> запись
+ *
+ * задержки считаются по меткам SampleStamp, которые отсчеты несут через
+ * журналы: время приема ставит поток приема, время публикации - журнал
+ */
+class HeadlessRunner {
+public:
+  /**
+   * @brief конструктор
+   * @throws std::runtime_error если не открылся файл вывода
+   */
+  explicit HeadlessRunner(const HeadlessConfig &config);
+
+  /**
+   * @brief деструктор
+   * останавливает прием и фильтры, закрывает вывод
+   */
+  ~HeadlessRunner();
+
+  HeadlessRunner(const HeadlessRunner &) = delete;
+  HeadlessRunner &operator=(const HeadlessRunner &) = delete;
+
+  /**
+   * @brief работать до duration_s или до stopRequested
+   *
+   * @return false, если прием не запустился
+   */
+  bool run(const std::atomic<bool> &stopRequested);
+
+private:
+  /**
+   * @brief серия на выходе: курсор и счетчики для статистики
+   */
+  struct Output {
+    std::string name;
+    BroadcastRingBuffer<DataPoint>::Reader *reader;
+    uint64_t written;
+    uint64_t writtenAtLastReport;
+  };
+
+  void addFilter(std::unique_ptr<IFilter> filter,
+                 BroadcastRingBuffer<DataPoint>::Reader *input,
+                 const std::string &name);
+  /**
+   * @brief забрать и записать все готовое
+   */
+  void drainOutputs();
+  void writeBlock(Output &output, const DataPoint *points,
+                  const SampleStamp *stamps, size_t count);
+  void printStatistics(double seconds);
+
+  HeadlessConfig m_config;
+
+  std::unique_ptr<BroadcastRingBuffer<DataPoint>> m_rawStream;
+  std::unique_ptr<NetworkController> m_networkController;
+  std::unique_ptr<DataProcessor> m_dataProcessor;
+  std::vector<std::unique_ptr<IFilter>> m_filters;
+
+  std::vector<Output> m_outputs;
+  std::vector<DataPoint> m_block;
+  std::vector<SampleStamp> m_stamps; // метки отсчетов m_block
+  std::FILE *m_file;
+  bool m_ownsFile;
+
+  PipelineLatency m_latency;
+
+  uint64_t m_samplesAtLastReport;
+};
+
+#endif // HEADLESSRUNNER_H
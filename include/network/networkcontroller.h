@@ -2,9 +2,9 @@
 #define NETWORKCONTROLLER_H
 
 #include "../core/datapoint.h"
-#include "../core/threadsaferingbuffer.h"
-#include "../network/udpreceiver.h"
-#include "../network/udpsender.h"
+#include "../core/broadcastringbuffer.h"
+#include "udpreceiver.h"
+#include "udpsender.h"
 #include <functional>
 #include <memory>
 #include <string>
@@ -14,10 +14,14 @@ public:
   NetworkController();
   ~NetworkController();
 
-  // инициализация с буферами и callback для fan-out
-  void initialize(ThreadSafeRingBuffer<DataPoint> *displayBuffer,
+  // инициализация с журналом сырых отсчетов и callback для fan-out
+  void initialize(BroadcastRingBuffer<DataPoint> *rawStream,
                   std::function<void(const DataPoint &)> fanOutCallback);
 
+  // fan-out целым блоком точек (одна пачка recvmmsg - один вызов)
+  void setBatchFanOut(
+      std::function<void(const DataPoint *, size_t)> batchFanOutCallback);
+
   // управление приемом данных
   bool startReceiver(const std::string &ip, uint16_t port);
   void stopReceiver();
@@ -29,8 +33,16 @@ public:
   // статистика
   size_t getPacketsReceived() const;
   size_t getPacketsSent() const;
+  ReceiverStatistics getReceiverStatistics() const;
   void resetStatistics();
 
+  // задержка сокет -> журнал сырых отсчетов (nullptr - не считать)
+  void setLatencyHistogram(LatencyHistogram *socketToRing);
+
+  // окно переупорядочивания отсчетов на приеме (мс, 0 - выключено)
+  void setReorderWindow(uint32_t windowMs);
+  uint32_t getReorderWindow() const;
+
   // геттеры для доступа к компонентам
   UdpReceiver *getReceiver() const { return m_receiver.get(); }
   UdpSender *getSender() const { return m_sender.get(); }
@@ -38,7 +50,7 @@ public:
 private:
   std::unique_ptr<UdpReceiver> m_receiver;
   std::unique_ptr<UdpSender> m_sender;
-  ThreadSafeRingBuffer<DataPoint> *m_displayBuffer;
+  BroadcastRingBuffer<DataPoint> *m_rawStream;
 };
 
 #endif // NETWORKCONTROLLER_H
@@ -7,6 +7,25 @@
 #include <cstring>
 #include <vector>
 
+/**
+ * @brief заголовок пакета данных v2
+ *
+ * формат (little-endian, 12 байт), за ним sampleCount отсчетов
+ * {uint32 timestamp, float value}:
+ *   uint16 magic, uint8 version, uint8 channel,
+ *   uint32 sequence, uint16 sampleCount, uint16 reserved
+ *
+ * для старого 8-байтного пакета заполняется как version = 1,
+ * channel = 0, sequence = 0, sampleCount = 1
+ */
+struct DataPacketHeader {
+  uint16_t magic = 0;
+  uint8_t version = 0;
+  uint8_t channel = 0;
+  uint32_t sequence = 0;
+  uint16_t sampleCount = 0;
+};
+
 /**
  * @brief парсер бинарных UDP пакетов
  */
@@ -22,6 +41,46 @@ public:
    */
   static DataPoint parseDataPacket(const uint8_t *data, size_t size);
 
+  /**
+   * @brief распарсить пакет данных любого формата (старый 8 байт или v2)
+   *
+   * отсчеты пишутся в массив вызывающего, ничего не выделяется
+   *
+   * @param data указатель на сырые байты
+   * @param size размер данных в байтах
+   * @param out массив для отсчетов
+   * @param outCapacity сколько отсчетов влезает в out
+   * @param header если не nullptr, сюда пишется заголовок пакета
+   * @return количество записанных отсчетов
+   * @throws std::runtime_error если пакет некорректный или out мал
+   */
+  static size_t parseDataPacketBatch(const uint8_t *data, size_t size,
+                                     DataPoint *out, size_t outCapacity,
+                                     DataPacketHeader *header = nullptr);
+
+  /**
+   * @brief создать пакет данных v2
+   *
+   * @param channel номер канала
+   * @param sequence порядковый номер пакета
+   * @param points отсчеты
+   * @param count количество отсчетов (не больше MAX_SAMPLES_PER_PACKET)
+   * @return вектор байт
+   */
+  static std::vector<uint8_t> createDataPacket(uint8_t channel,
+                                               uint32_t sequence,
+                                               const DataPoint *points,
+                                               size_t count);
+
+  /**
+   * @brief проверить, что байты - корректный пакет данных (любого формата)
+   *
+   * @param data указатель на сырые байты
+   * @param size размер в байтах
+   * @return true если пакет можно распарсить
+   */
+  static bool isValidDataPacket(const uint8_t *data, size_t size);
+
   /**
    * @brief распарсить команду (целевое значение)
    *
@@ -65,6 +124,14 @@ private:
    */
   static uint32_t bytesToUint32(const uint8_t *bytes);
 
+  /**
+   * @brief конвертировать байты в uint16_t (little-endian)
+   *
+   * @param bytes указатель на 2 байта
+   * @return uint16_t значение
+   */
+  static uint16_t bytesToUint16(const uint8_t *bytes);
+
   /**
    * @brief конвертировать байты в float (little-endian)
    *
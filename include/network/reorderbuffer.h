@@ -0,0 +1,106 @@
+#ifndef REORDERBUFFER_H
+#define REORDERBUFFER_H
+
+#include "../core/Constants.h"
+#include "../core/datapoint.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief окно переупорядочивания отсчетов по timestamp
+ *
+ * отсчет задерживается, пока не придет отсчет новее него на windowMs
+ * или пока он и все отсчеты перед ним не пролежат в окне windowMs по
+ * времени приема, за это время слегка опоздавшие отсчеты встают на свое
+ * место. так задержка не больше окна и при редких пакетах. отсчет,
+ * пришедший позже уже выпущенных, выбрасывается и считается в lateDropped
+ *
+ * пакеты, пришедшие по порядку номеров, проходят сразу, если за
+ * последнее окно не было пакетов с пропуском, перестановкой или без
+ * номера: окно копит отсчеты только после нарушения порядка, и без
+ * перестановок задержки нет
+ *
+ * вместе с отсчетом хранится время его приема (monotonicNs), оно
+ * выходит из окна вместе с ним
+ *
+ * push/flush вызываются только из потока приема
+ */
+class ReorderBuffer {
+public:
+  /**
+   * @brief конструктор
+   * @param windowMs ширина окна в мс, 0 - без переупорядочивания
+   */
+  explicit ReorderBuffer(
+      uint32_t windowMs = Constants::Network::DEFAULT_REORDER_WINDOW_MS);
+
+  /**
+   * @brief установить ширину окна (можно из любого потока)
+   */
+  void setWindow(uint32_t windowMs);
+
+  /**
+   * @brief ширина окна в мс
+   */
+  uint32_t getWindow() const;
+
+  /**
+   * @brief добавить отсчеты
+   *
+   * отсчеты, вышедшие из окна, дописываются в released по возрастанию
+   * timestamp, время их приема - в releasedNs. count может быть 0: тогда
+   * только выпускаются отсчеты, пролежавшие окно к receivedNs
+   *
+   * @param points отсчеты
+   * @param count количество
+   * @param receivedNs когда отсчеты приняты (сейчас)
+   * @param inSequence пакеты пришли по порядку номеров (см.
+   * SequenceTracker): после окна без нарушений порядка отсчеты выходят
+   * сразу
+   * @param released куда дописать готовые отсчеты
+   * @param releasedNs куда дописать время приема готовых отсчетов
+   */
+  void push(const DataPoint *points, size_t count, uint64_t receivedNs,
+            bool inSequence, std::vector<DataPoint> &released,
+            std::vector<uint64_t> &releasedNs);
+
+  /**
+   * @brief выпустить все задержанные отсчеты (например, при паузе в потоке)
+   */
+  void flush(std::vector<DataPoint> &released,
+             std::vector<uint64_t> &releasedNs);
+
+  /**
+   * @brief забыть задержанные отсчеты и последний выпущенный timestamp
+   */
+  void clear();
+
+  /**
+   * @brief сколько отсчетов сейчас задержано
+   */
+  size_t pending() const;
+
+  /**
+   * @brief сколько отсчетов выброшено как слишком поздние
+   */
+  uint64_t getLateDropped() const;
+
+  /**
+   * @brief сбросить счетчик
+   */
+  void resetStatistics();
+
+private:
+  std::vector<DataPoint> m_pending; // отсортированы по timestamp
+  std::vector<uint64_t> m_pendingNs; // время приема m_pending
+  std::atomic<uint32_t> m_window;
+  uint32_t m_newest;                // самый новый принятый timestamp
+  uint32_t m_lastReleased;          // последний выпущенный timestamp
+  bool m_hasReleased;
+  uint64_t m_disorderNs; // когда последний раз нарушался порядок пакетов
+  std::atomic<uint64_t> m_lateDropped;
+};
+
+#endif // REORDERBUFFER_H
@@ -0,0 +1,91 @@
+#ifndef SEQUENCETRACKER_H
+#define SEQUENCETRACKER_H
+
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+/**
+ * @brief учет порядковых номеров пакетов v2 по каждому источнику
+ *
+ * источник - это пара (адрес отправителя, канал). для каждого хранится
+ * старший принятый номер и окно уже виденных и засчитанных потерянными
+ * номеров позади него, по ним пакет классифицируется как потерянный,
+ * переупорядоченный или дубликат. опоздавший пакет снимает потерю,
+ * только если его номер был засчитан потерянным. пакет позади окна уже
+ * не проверить на дубликат, он Late и счетчиков не трогает
+ *
+ * track() вызывается только из потока приема, счетчики можно читать из
+ * любого потока
+ */
+class SequenceTracker {
+public:
+  /**
+   * @brief результат учета одного пакета
+   */
+  enum class Result {
+    First,     // первый пакет от источника
+    InOrder,   // следующий по порядку
+    Gap,       // пришел с пропуском, пропущенные считаются потерянными
+    Reordered, // опоздал, но раньше не приходил
+    Duplicate, // такой номер уже был
+    Late       // позади окна: дубликат или опоздание, не понять
+  };
+
+  /**
+   * @brief сколько номеров позади старшего помнится для поиска дубликатов
+   */
+  static constexpr size_t WINDOW = 1024;
+
+  SequenceTracker();
+
+  /**
+   * @brief учесть пакет
+   *
+   * @param sourceKey ключ источника (см. makeSourceKey)
+   * @param sequence порядковый номер пакета
+   * @return классификация пакета
+   */
+  Result track(uint64_t sourceKey, uint32_t sequence);
+
+  /**
+   * @brief собрать ключ источника из адреса, порта и канала
+   */
+  static uint64_t makeSourceKey(uint32_t address, uint16_t port,
+                                uint8_t channel);
+
+  /**
+   * @brief забыть все источники (только при остановленном приеме)
+   */
+  void clearSources();
+
+  /**
+   * @brief сбросить счетчики
+   */
+  void resetStatistics();
+
+  uint64_t getLost() const;       // пропущено пакетов
+  uint64_t getReordered() const;  // пришло не по порядку
+  uint64_t getDuplicated() const; // дубликатов
+  uint64_t getGapEvents() const;  // сколько раз поток рвался
+  size_t getSourceCount() const;  // сколько источников видели
+
+private:
+  struct SourceState {
+    uint32_t highest = 0;       // старший принятый номер
+    std::bitset<WINDOW> seen;   // бит i - принят ли номер highest - i
+    std::bitset<WINDOW> missed; // бит i - засчитан ли он потерянным
+  };
+
+  std::unordered_map<uint64_t, SourceState> m_sources;
+
+  std::atomic<uint64_t> m_lost;
+  std::atomic<uint64_t> m_reordered;
+  std::atomic<uint64_t> m_duplicated;
+  std::atomic<uint64_t> m_gapEvents;
+  std::atomic<size_t> m_sourceCount;
+};
+
+#endif // SEQUENCETRACKER_H
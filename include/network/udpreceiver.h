@@ -3,11 +3,15 @@
 
 #include "../core/Constants.h"
 #include "../core/datapoint.h"
-#include "../core/threadsaferingbuffer.h"
+#include "../core/broadcastringbuffer.h"
+#include "../core/latency.h"
+#include "reorderbuffer.h"
+#include "sequencetracker.h"
 #include <atomic>
 #include <functional>
 #include <string>
 #include <thread>
+#include <vector>
 
 #ifdef _WIN32
 // Для шиндовса используем WinSock2
@@ -19,6 +23,19 @@ using SocketHandle = SOCKET;
 using SocketHandle = int;
 #endif
 
+/**
+ * @brief статистика приема
+ */
+struct ReceiverStatistics {
+  size_t packetsReceived = 0;   // принято датаграмм
+  uint64_t samplesReceived = 0; // отдано дальше отсчетов
+  uint64_t lost = 0;            // пропущено пакетов (по sequence)
+  uint64_t reordered = 0;       // пришло не по порядку
+  uint64_t duplicated = 0;      // дубликатов (выброшены)
+  uint64_t gapEvents = 0;       // разрывов потока
+  uint64_t lateDropped = 0;     // отсчетов, опоздавших больше окна
+};
+
 /**
  * @brief класс для приема данных от модели по UDP
  */
@@ -27,13 +44,47 @@ public:
   /**
    * @brief конструктор
    *
-   * @param buffer потокобезопасный буфер для сохранения данных
+   * @param buffer журнал, в который публикуются принятые отсчеты. поток
+   * приема - его единственный писатель
    * @param onDataReceived callback функция, вызываемая при получении данных
    */
   explicit UdpReceiver(
-      ThreadSafeRingBuffer<DataPoint> *buffer,
+      BroadcastRingBuffer<DataPoint> *buffer,
       std::function<void(const DataPoint &)> onDataReceived = nullptr);
 
+  /**
+   * @brief callback для приема целого блока точек за один вызов
+   *
+   * вызывается один раз на пачку датаграмм, вместо поточечного callback.
+   * если задан, поточечный callback не вызывается
+   *
+   * @param onBatchReceived функция (указатель на первую точку, количество)
+   */
+  void setBatchCallback(
+      std::function<void(const DataPoint *, size_t)> onBatchReceived);
+
+  /**
+   * @brief куда писать задержку от выхода датаграммы из сокета до
+   * публикации ее отсчетов в журнал (nullptr - не писать)
+   *
+   * время приема - monotonicNs() сразу после recvfrom/recvmmsg, оно же
+   * уходит в журнал как SampleStamp::receivedNs. задавать до start()
+   */
+  void setLatencyHistogram(LatencyHistogram *socketToRing);
+
+  /**
+   * @brief включить/выключить пакетный прием через recvmmsg
+   *
+   * работает только на linux, на остальных ос всегда поштучный recvfrom.
+   * переключать нужно до start()
+   */
+  void setBatchReceiveEnabled(bool enabled);
+
+  /**
+   * @brief включен ли пакетный прием
+   */
+  bool isBatchReceiveEnabled() const;
+
   /**
    * @brief деструктор
    * автоматически останавливает прием и закрывает сокет
@@ -69,6 +120,22 @@ public:
    */
   size_t getPacketsReceived() const;
 
+  /**
+   * @brief полная статистика приема: потери, порядок, дубликаты
+   */
+  ReceiverStatistics getStatistics() const;
+
+  /**
+   * @brief установить окно переупорядочивания
+   * @param windowMs ширина окна в мс, 0 - выключить
+   */
+  void setReorderWindow(uint32_t windowMs);
+
+  /**
+   * @brief текущее окно переупорядочивания в мс
+   */
+  uint32_t getReorderWindow() const;
+
   /**
    * @brief Сбросить статистику
    */
@@ -80,6 +147,67 @@ private:
    */
   void receiveLoop();
 
+#ifdef __linux__
+  /**
+   * @brief цикл приема пачками через recvmmsg
+   *
+   * за один системный вызов забирает до RECEIVE_BATCH_SIZE датаграмм,
+   * парсит их за один проход и публикует одним блоком
+   */
+  void receiveLoopBatched();
+#endif
+
+  /**
+   * @brief проверить, распарсить и учесть одну датаграмму
+   *
+   * @param data байты датаграммы
+   * @param size размер
+   * @param address адрес отправителя (network order)
+   * @param port порт отправителя (network order)
+   * @param out куда писать отсчеты
+   * @param outCapacity сколько отсчетов влезает в out
+   * @param inSequence false, если отсчеты, возможно, надо
+   * переупорядочить: пакет без номера (старый формат), с пропуском или
+   * опоздавший
+   * @return сколько отсчетов принято (0 для мусора и дубликатов)
+   */
+  size_t acceptPacket(const uint8_t *data, size_t size, uint32_t address,
+                      uint16_t port, DataPoint *out, size_t outCapacity,
+                      bool &inSequence);
+
+  /**
+   * @brief пропустить отсчеты через окно переупорядочивания и опубликовать
+   * @param receivedNs когда датаграммы с отсчетами вышли из сокета
+   * @param inSequence все пакеты пришли по порядку номеров
+   */
+  void release(const DataPoint *points, size_t count, uint64_t receivedNs,
+               bool inSequence);
+
+  /**
+   * @brief опубликовать все, что задержано в окне переупорядочивания
+   */
+  void flushReorderBuffer();
+
+  /**
+   * @brief таймаут приема: пока в окне есть отсчеты - ширина окна, чтобы
+   * при паузе в потоке они вышли вовремя, иначе SOCKET_TIMEOUT_MS
+   *
+   * setsockopt вызывается только при смене таймаута
+   */
+  void updateReceiveTimeout();
+
+  /**
+   * @brief выставить SO_RCVTIMEO
+   */
+  bool setReceiveTimeout(uint32_t timeoutMs);
+
+  /**
+   * @brief опубликовать блок распарсенных точек в буфер и callback'и
+   * @param receivedNs время приема каждой точки
+   */
+  void publish(const DataPoint *points, const uint64_t *receivedNs,
+               size_t count);
+
   /**
    * @brief инициализация сокета
    *
@@ -96,14 +224,25 @@ private:
    */
   void closeSocket();
 
-  ThreadSafeRingBuffer<DataPoint> *m_buffer;               // буфер для данных
+  BroadcastRingBuffer<DataPoint> *m_buffer;                // журнал отсчетов
   std::function<void(const DataPoint &)> m_onDataReceived; // callback
+  std::function<void(const DataPoint *, size_t)>
+      m_onBatchReceived; // callback на блок точек
+  bool m_batchReceive;   // прием через recvmmsg
 
   std::thread m_receiveThread; // поток приема
   std::atomic<bool> m_running; // флаг
 
   SocketHandle m_socket;                 // дескриптор сокета
+  uint32_t m_receiveTimeoutMs;           // текущий SO_RCVTIMEO
   std::atomic<size_t> m_packetsReceived; // количество принятых пакетов
+  std::atomic<uint64_t> m_samplesReceived; // количество отданных отсчетов
+
+  SequenceTracker m_sequenceTracker;   // учет sequence по источникам
+  ReorderBuffer m_reorderBuffer;       // окно переупорядочивания
+  std::vector<DataPoint> m_released;   // выпущенные из окна отсчеты
+  std::vector<uint64_t> m_releasedNs;  // время их приема
+  LatencyHistogram *m_latency;         // сокет -> журнал
 };
 
 #endif // UDPRECEIVER_H
@@ -2,7 +2,8 @@
 #define DATAPROCESSOR_H
 
 #include "../core/datapoint.h"
-#include "../core/threadsaferingbuffer.h"
+#include "../core/ibufferreader.h"
+#include "../core/broadcastringbuffer.h"
 #include "../filters/ifilter.h"
 #include "filterthread.h"
 #include <memory>
@@ -32,11 +33,13 @@ public:
    *
    * @param filter фильтр
    * @param inputBuffer входной буфер сырых данных именно для этого фильтра
+   * (читается только потоком фильтра, подходит SpscRingBuffer)
    * @param name имя фильтра
-   * @return указатель на output buffer для отфильтрованных данных
+   * @return журнал отфильтрованных данных, читатели создаются через
+   * createReader()
    */
-  ThreadSafeRingBuffer<DataPoint> *
-  addFilter(IFilter *filter, ThreadSafeRingBuffer<DataPoint> *inputBuffer,
+  BroadcastRingBuffer<DataPoint> *
+  addFilter(IFilter *filter, IBufferReader<DataPoint> *inputBuffer,
             const std::string &name = "");
 
   /**
@@ -53,7 +56,7 @@ public:
    * @param name имя фильтра
    * @return указатель на output buffer или nullptr если фильтр не найден
    */
-  ThreadSafeRingBuffer<DataPoint> *
+  BroadcastRingBuffer<DataPoint> *
   getFilterOutputBuffer(const std::string &name) const;
 
   /**
@@ -102,6 +105,12 @@ public:
    */
   size_t getFilterProcessedCount(const std::string &name) const;
 
+  /**
+   * @brief задержка журнал сырых отсчетов -> результат фильтра для всех
+   * фильтров, и уже добавленных, и будущих (nullptr - не считать)
+   */
+  void setLatencyHistogram(LatencyHistogram *ringToFilter);
+
 private:
   /**
    * @brief Структура для хранения информации о фильтре
@@ -109,18 +118,19 @@ private:
   struct FilterInfo {
     IFilter *filter;                      // фильтр (не владеем)
     std::unique_ptr<FilterThread> thread; // поток обработки
-    std::unique_ptr<ThreadSafeRingBuffer<DataPoint>>
-        outputBuffer; // буфер выходных данных
+    std::unique_ptr<BroadcastRingBuffer<DataPoint>>
+        outputBuffer; // журнал выходных данных
     std::string name; // имя фильтра
 
     FilterInfo(IFilter *f, std::unique_ptr<FilterThread> t,
-               std::unique_ptr<ThreadSafeRingBuffer<DataPoint>> buf,
+               std::unique_ptr<BroadcastRingBuffer<DataPoint>> buf,
                const std::string &n)
         : filter(f), thread(std::move(t)), outputBuffer(std::move(buf)),
           name(n) {}
   };
 
   std::vector<std::unique_ptr<FilterInfo>> m_filters; // список фильтров
+  LatencyHistogram *m_latency; // общая гистограмма потоков фильтров
 };
 
 #endif // DATAPROCESSOR_H
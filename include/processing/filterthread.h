@@ -2,13 +2,16 @@
 #define FILTERTHREAD_H
 
 #include "../core/datapoint.h"
-#include "../core/threadsaferingbuffer.h"
+#include "../core/ibufferreader.h"
+#include "../core/broadcastringbuffer.h"
+#include "../core/latency.h"
 #include "../filters/ifilter.h"
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 /**
  * @brief поток для выполнения фильтра
@@ -19,12 +22,13 @@ public:
    * @brief конструктор
    *
    * @param filter фильтр для применения (IFilter*)
-   * @param inputBuffer буфер входных данных
-   * @param outputBuffer буфер выходных данных
+   * @param inputBuffer буфер входных данных (ThreadSafeRingBuffer или
+   * SpscRingBuffer - поток только читает из него)
+   * @param outputBuffer журнал выходных данных (поток - единственный писатель)
    * @param name имя потока
    */
-  FilterThread(IFilter *filter, ThreadSafeRingBuffer<DataPoint> *inputBuffer,
-               ThreadSafeRingBuffer<DataPoint> *outputBuffer,
+  FilterThread(IFilter *filter, IBufferReader<DataPoint> *inputBuffer,
+               BroadcastRingBuffer<DataPoint> *outputBuffer,
                const char *name = "FilterThread");
 
   /**
@@ -61,25 +65,44 @@ public:
    */
   size_t getProcessedCount() const;
 
+  /**
+   * @brief куда писать задержку от публикации сырого отсчета до
+   * публикации результата фильтра (nullptr - не писать)
+   *
+   * можно менять на ходу. время приема отсчета переносится в выходной
+   * журнал, поэтому после фильтра по нему видна задержка от сокета
+   */
+  void setLatencyHistogram(LatencyHistogram *ringToFilter);
+
 private:
   /**
    * @brief основная функция потока
    *
    * выполняется в отдельном потоке.
    * чтение из inputBuffer, применение фильтра + сохранение в outputBuffer.
+   * когда данных нет, поток спит в inputBuffer->waitForData().
    */
   void run();
 
   /**
-   * @brief обработать одну точку данных
+   * @brief обработать блок точек из m_inputBlock
    *
-   * применение фильтра сохранение результата.
+   * фильтр обрабатывает блок одним вызовом processBlock(), готовые
+   * результаты публикуются в outputBuffer одной записью. фильтр отдает
+   * результаты для последних входных отсчетов блока (первые уходят на
+   * разгон окна), поэтому k-й с конца результат получает метки k-го с
+   * конца входа
    */
-  void processPoint(const DataPoint &point);
+  void processBlock(size_t count);
 
   IFilter *m_filter;                               // фильтр (IFilter*)
-  ThreadSafeRingBuffer<DataPoint> *m_inputBuffer;  // буфер входных данных
-  ThreadSafeRingBuffer<DataPoint> *m_outputBuffer; // буфер выходных данных
+  IBufferReader<DataPoint> *m_inputBuffer;         // буфер входных данных
+  BroadcastRingBuffer<DataPoint> *m_outputBuffer;  // журнал выходных данных
+  std::vector<DataPoint> m_inputBlock;  // блок, забранный из входного буфера
+  std::vector<DataPoint> m_outputBlock; // результаты фильтра для блока
+  std::vector<SampleStamp> m_inputStamps; // метки отсчетов m_inputBlock
+  std::vector<uint64_t> m_outputReceivedNs; // время приема результатов
+  std::atomic<LatencyHistogram *> m_latency; // журнал -> фильтр
   std::thread m_thread;                            // поток выполнения
   std::atomic<bool> m_running;          // потокобезопасный флаг работы
   std::atomic<size_t> m_processedCount; // счетчик точек
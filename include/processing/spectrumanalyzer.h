@@ -0,0 +1,173 @@
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include "../core/Constants.h"
+#include "../core/datapoint.h"
+#include "../core/ibufferreader.h"
+#include <atomic>
+#include <chrono>
+#include <complex>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief спектр одной серии в готовом кадре
+ */
+struct SpectrumSeries {
+  std::string name;                 // имя серии, как в addSeries()
+  std::vector<double> frequencies;  // частоты бинов, Гц
+  std::vector<double> amplitudes;   // амплитуды бинов
+  double sampleRate = 0.0;          // оценка частоты дискретизации, Гц
+  bool valid = false;               // false - отсчетов пока мало для спектра
+};
+
+/**
+ * @brief кадр спектров всех серий, посчитанный за один проход
+ */
+struct SpectrumFrame {
+  uint64_t sequence = 0; // номер кадра, растет с каждым расчетом
+  std::vector<SpectrumSeries> series;
+};
+
+/**
+ * @brief фоновый расчет спектров
+ *
+ * поток анализа сам читает серии из буферов конвейера (своими курсорами),
+ * хранит последние Spectrum::MAX_FFT_SIZE отсчетов каждой серии и раз в
+ * период считает по ним спектры. GUI только забирает готовый кадр через
+ * takeLatest() и рисует его
+ *
+ * готовый кадр лежит в одном слоте: если GUI не успел его забрать, новый
+ * кадр заменяет старый, а старый считается пропущенным. кадры обмениваются
+ * через swap, так что после первых кадров память не выделяется
+ */
+class SpectrumAnalyzer {
+public:
+  /**
+   * @brief конструктор
+   * @param period период расчета спектров
+   */
+  explicit SpectrumAnalyzer(
+      std::chrono::milliseconds period = std::chrono::milliseconds(
+          Constants::Performance::UPDATE_INTERVAL_MS *
+          Constants::Performance::SPECTRUM_UPDATE_INTERVAL));
+
+  /**
+   * @brief деструктор
+   * останавливает поток анализа
+   */
+  ~SpectrumAnalyzer();
+
+  SpectrumAnalyzer(const SpectrumAnalyzer &) = delete;
+  SpectrumAnalyzer &operator=(const SpectrumAnalyzer &) = delete;
+
+  /**
+   * @brief добавить серию (только при остановленном потоке)
+   *
+   * @param name имя серии
+   * @param reader курсор чтения серии, его читает только поток анализа
+   */
+  void addSeries(const std::string &name, IBufferReader<DataPoint> *reader);
+
+  /**
+   * @brief запустить поток анализа
+   *
+   * накопленная история серий сбрасывается
+   */
+  void start();
+
+  /**
+   * @brief остановить поток анализа
+   */
+  void stop();
+
+  /**
+   * @brief проверить, работает ли поток
+   */
+  bool isRunning() const;
+
+  /**
+   * @brief забрать последний готовый кадр
+   *
+   * кадр обменивается с frame через swap: буферы переданного кадра
+   * переиспользуются для следующих расчетов
+   *
+   * @param frame куда положить кадр
+   * @return false, если с прошлого вызова нового кадра не было
+   */
+  bool takeLatest(SpectrumFrame &frame);
+
+  /**
+   * @brief сколько кадров посчитано
+   */
+  uint64_t getComputedFrames() const;
+
+  /**
+   * @brief сколько кадров заменено новыми, не дойдя до GUI
+   */
+  uint64_t getDroppedFrames() const;
+
+private:
+  /**
+   * @brief история одной серии
+   */
+  struct SeriesState {
+    std::string name;
+    IBufferReader<DataPoint> *reader;
+    std::vector<DataPoint> history; // кольцо последних MAX_FFT_SIZE отсчетов
+    size_t head;                    // куда писать следующий отсчет
+    size_t count;                   // сколько отсчетов в кольце
+  };
+
+  /**
+   * @brief основная функция потока
+   */
+  void run();
+
+  /**
+   * @brief забрать из курсора серии все новые отсчеты
+   */
+  void drain(SeriesState &state);
+
+  /**
+   * @brief посчитать спектр серии в out
+   */
+  void computeSeries(const SeriesState &state, SpectrumSeries &out);
+
+  /**
+   * @brief оценить частоту дискретизации по timestamp в истории
+   */
+  static double estimateSampleRate(const SeriesState &state);
+
+  /**
+   * @brief отдать m_work в слот готового кадра
+   */
+  void publish();
+
+  std::chrono::milliseconds m_period;
+  std::vector<SeriesState> m_series;
+
+  // рабочие буферы потока анализа, выделяются один раз
+  std::vector<DataPoint> m_drainBlock;
+  std::vector<float> m_fftInput;
+  std::vector<std::complex<double>> m_fftSpectrum;
+  SpectrumFrame m_work; // кадр, который сейчас считается
+
+  // слот готового кадра
+  std::mutex m_frameMutex;
+  SpectrumFrame m_latest;
+  bool m_hasLatest;
+
+  std::thread m_thread;
+  std::mutex m_stopMutex;
+  std::condition_variable m_stopCondition;
+  std::atomic<bool> m_running;
+  std::atomic<uint64_t> m_computedFrames;
+  std::atomic<uint64_t> m_droppedFrames;
+};
+
+#endif // SPECTRUMANALYZER_H
@@ -0,0 +1,127 @@
+#ifndef IMPAIRMENT_H
+#define IMPAIRMENT_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+/**
+ * @brief параметры искажения потока пакетов
+ *
+ * все по умолчанию выключено
+ */
+struct ImpairmentConfig {
+  // потеря пачками по Гилберту-Эллиотту: в хорошем состоянии пакет
+  // теряется с вероятностью loss, в плохом - burstLoss. переход в плохое
+  // состояние - с вероятностью burstEnter на пакет, обратно - burstExit.
+  // при burstEnter = 0 остаются только независимые потери loss
+  double loss = 0.0;
+  double burstEnter = 0.0;
+  double burstExit = 0.5;
+  double burstLoss = 1.0;
+
+  // пакет с вероятностью reorder задерживается и уходит после
+  // reorderDepth следующих за ним
+  double reorder = 0.0;
+  size_t reorderDepth = 3;
+
+  // каждый пакет (и его дубликат) задерживается на случайное время до
+  // jitterMs; при jitterMs больше интервала пакетов они перемешиваются
+  double jitterMs = 0.0;
+
+  // вероятность отправить пакет дважды
+  double duplicate = 0.0;
+
+  uint32_t seed = 1;
+
+  /**
+   * @brief включено ли хоть что-то
+   */
+  bool enabled() const {
+    return loss > 0.0 || burstEnter > 0.0 || reorder > 0.0 ||
+           jitterMs > 0.0 || duplicate > 0.0;
+  }
+};
+
+/**
+ * @brief счетчики искажений
+ */
+struct ImpairmentStatistics {
+  uint64_t submitted = 0;  // пакетов от источника
+  uint64_t dropped = 0;    // выброшено
+  uint64_t burstDrops = 0; // из них в плохом состоянии
+  uint64_t duplicated = 0; // отправлено лишних копий
+  uint64_t reordered = 0;  // задержано до reorderDepth следующих
+  uint64_t delivered = 0;  // отдано на отправку, с копиями
+};
+
+/**
+ * @brief искажение потока пакетов между источником и сокетом
+ *
+ * источник отдает пакеты в submit(), те, чей срок наступил, забираются
+ * через release(). решения принимаются генератором с фиксированным seed,
+ * поэтому сценарий воспроизводим. не потокобезопасен: вызывается из
+ * потока темпа
+ */
+class NetworkImpairment {
+public:
+  using Clock = std::chrono::steady_clock;
+  using Packet = std::vector<uint8_t>;
+
+  explicit NetworkImpairment(const ImpairmentConfig &config);
+
+  /**
+   * @brief принять пакет от источника в момент now
+   */
+  void submit(Packet packet, Clock::time_point now);
+
+  /**
+   * @brief отдать в send все пакеты со сроком не позже now, по сроку
+   */
+  void release(Clock::time_point now,
+               const std::function<void(const Packet &)> &send);
+
+  /**
+   * @brief отдать все, включая задержанные до следующих пакетов
+   * (при остановке, чтобы ничего не пропало молча)
+   */
+  void flush(const std::function<void(const Packet &)> &send);
+
+  /**
+   * @brief срок ближайшего пакета в очереди, Clock::time_point::max(),
+   * если очередь пуста
+   */
+  Clock::time_point nextDue() const;
+
+  const ImpairmentStatistics &getStatistics() const { return m_stats; }
+
+private:
+  struct Scheduled {
+    Clock::time_point due;
+    uint64_t order; // при равных сроках - порядок постановки
+    Packet packet;
+  };
+
+  struct Held {
+    size_t remaining; // сколько пакетов еще пропустить вперед
+    Packet packet;
+  };
+
+  void schedule(Packet packet, Clock::time_point now);
+
+  ImpairmentConfig m_config;
+  std::mt19937 m_random;
+  std::uniform_real_distribution<double> m_unit;
+  bool m_burst; // плохое состояние Гилберта-Эллиотта
+
+  std::vector<Scheduled> m_queue; // куча по (due, order)
+  std::vector<Held> m_held;
+  uint64_t m_order;
+
+  ImpairmentStatistics m_stats;
+};
+
+#endif // IMPAIRMENT_H
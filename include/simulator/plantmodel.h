@@ -0,0 +1,76 @@
+#ifndef PLANTMODEL_H
+#define PLANTMODEL_H
+
+#include <cstdint>
+#include <random>
+
+/**
+ * @brief параметры модели объекта под PID-регулятором
+ *
+ * по умолчанию - как в PIDemulator/model.py
+ */
+struct PlantParameters {
+  double kp = 1.5;
+  double ki = 1.5;
+  double kd = 0.01;
+  double integralLimit = 10.0;
+
+  enum class Noise { None, Gaussian, Uniform };
+  Noise noise = Noise::Gaussian;
+  double noiseAmplitude = 1.2;
+
+  // выбросы: частота появления (гц, 0 - выключены), длительность
+  // случайная до outlierMaxDuration секунд, величина до outlierAmplitude
+  double outlierFrequency = 1.0;
+  double outlierMaxDuration = 0.5;
+  double outlierAmplitude = 5.0;
+
+  uint32_t seed = 1;
+};
+
+/**
+ * @brief замкнутый контур: PID-регулятор и объект-интегратор
+ *
+ * та же модель, что в model.py: value += u * dt, u - выход PID по
+ * ошибке setpoint - value. к выходу добавляются шум и выбросы. объект
+ * интегрируется шагом не больше MAX_STEP, поэтому поведение не зависит
+ * от частоты отсчетов. не потокобезопасна
+ */
+class PlantModel {
+public:
+  /**
+   * @brief самый крупный шаг интегрирования, с
+   */
+  static constexpr double MAX_STEP = 0.001;
+
+  explicit PlantModel(const PlantParameters &parameters = PlantParameters());
+
+  /**
+   * @brief продвинуть модель на period секунд и снять отсчет
+   *
+   * @param setpoint задание
+   * @param period время с предыдущего отсчета, с
+   * @return выход объекта с шумом и выбросами
+   */
+  float sample(double setpoint, double period);
+
+  /**
+   * @brief выход объекта без шума
+   */
+  double getValue() const { return m_value; }
+
+private:
+  void step(double setpoint, double dt);
+
+  PlantParameters m_parameters;
+  double m_value;
+  double m_integral;
+  double m_previousError;
+
+  double m_outlierRemaining; // сколько секунд еще длится выброс
+  double m_outlierValue;
+
+  std::mt19937 m_random;
+};
+
+#endif // PLANTMODEL_H
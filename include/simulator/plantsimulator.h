@@ -0,0 +1,167 @@
+#ifndef PLANTSIMULATOR_H
+#define PLANTSIMULATOR_H
+
+#include "../core/Constants.h"
+#include "impairment.h"
+#include "plantmodel.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using SocketHandle = SOCKET;
+#else
+using SocketHandle = int;
+#endif
+
+/**
+ * @brief настройки симулятора
+ *
+ * порты по умолчанию - как у model.py: команды принимаются на
+ * DEFAULT_RECEIVE_PORT, данные уходят на DEFAULT_SEND_PORT, где их
+ * слушает визуализатор
+ */
+struct SimulatorConfig {
+  std::string commandIp = Constants::Network::DEFAULT_RECEIVE_IP;
+  uint16_t commandPort = Constants::Network::DEFAULT_RECEIVE_PORT;
+  std::string dataIp = Constants::Network::DEFAULT_SEND_IP;
+  uint16_t dataPort = Constants::Network::DEFAULT_SEND_PORT;
+
+  double rateHz = 1000.0;  // отсчетов в секунду, 1 .. 100000
+  size_t batch = 0;        // отсчетов в пакете v2, 0 - по частоте
+  bool legacyFormat = false; // 8-байтные пакеты по одному отсчету
+  uint8_t channel = 0;
+
+  double setpoint = 0.0; // начальное задание
+  PlantParameters plant;
+  ImpairmentConfig impairment;
+
+  /**
+   * @brief задать один параметр из "ключ=значение"
+   *
+   * ключи: command_ip, command_port, data_ip, data_port, rate_hz, batch,
+   * format (v2|legacy), channel, setpoint, kp, ki, kd, noise
+   * (gaussian|uniform|none), noise_amplitude, outlier_frequency_hz,
+   * outlier_max_duration_s, outlier_amplitude, seed; искажения сети
+   * (см. ImpairmentConfig): loss, burst_enter, burst_exit, burst_loss,
+   * reorder, reorder_depth, jitter_ms, duplicate, impairment_seed
+   *
+   * @throws std::invalid_argument если ключ неизвестен или значение
+   * не подходит
+   */
+  void set(const std::string &key, const std::string &value);
+
+  /**
+   * @brief сколько отсчетов кладется в пакет
+   *
+   * batch, а если он 0 - столько, чтобы пакетов было не больше ~1000 в
+   * секунду (но не больше MAX_SAMPLES_PER_PACKET). в старом формате 1
+   */
+  size_t samplesPerPacket() const;
+};
+
+/**
+ * @brief статистика симулятора
+ */
+struct SimulatorStatistics {
+  uint64_t packetsSent = 0;
+  uint64_t samplesSent = 0;
+  uint64_t sendErrors = 0;
+  uint64_t commandsReceived = 0;
+  uint64_t resyncs = 0;      // отставаний больше MAX_LAG, темп сброшен
+  double maxLatenessUs = 0;  // худшее опоздание отправки с прошлого чтения
+  double setpoint = 0;
+  ImpairmentStatistics impairment;
+};
+
+/**
+ * @brief локальная модель PID: команды по UDP, отсчеты по UDP
+ *
+ * поток темпа шлет пакеты по абсолютному расписанию от момента запуска:
+ * пакет из n отсчетов уходит в момент, когда "снят" его последний
+ * отсчет. до срока поток спит, последние SPIN_MARGIN досыпает в
+ * активном ожидании, поэтому ошибка темпа не накапливается и не зависит
+ * от точности sleep. если отправка отстала больше чем на MAX_LAG
+ * (процесс был приостановлен), расписание отсчитывается заново, без
+ * пачки догоняющих пакетов
+ *
+ * timestamp отсчета - время модели в мс от запуска (как у model.py):
+ * выше 1 кгц несколько отсчетов подряд имеют одинаковый timestamp
+ *
+ * если в настройках включены искажения, пакеты перед сокетом проходят
+ * через NetworkImpairment: поток темпа между пакетами отправляет
+ * задержанные в их срок, при остановке отправляет все оставшиеся
+ *
+ * поток команд принимает пакеты UdpSender (float задание) и меняет
+ * задание модели
+ */
+class PlantSimulator {
+public:
+  /**
+   * @brief опоздание, после которого расписание сбрасывается
+   */
+  static constexpr double MAX_LAG_SECONDS = 0.1;
+
+  /**
+   * @brief сколько перед сроком отправки ждать активно, а не во сне
+   */
+  static constexpr double SPIN_MARGIN_SECONDS = 0.0002;
+
+  explicit PlantSimulator(const SimulatorConfig &config);
+  ~PlantSimulator();
+
+  PlantSimulator(const PlantSimulator &) = delete;
+  PlantSimulator &operator=(const PlantSimulator &) = delete;
+
+  /**
+   * @brief открыть сокеты и запустить потоки
+   * @return false если сокет команд не привязался или адрес данных
+   * неправильный
+   */
+  bool start();
+
+  /**
+   * @brief остановить потоки и закрыть сокеты
+   */
+  void stop();
+
+  bool isRunning() const { return m_running.load(); }
+
+  /**
+   * @brief статистика; maxLatenessUs сбрасывается при каждом чтении
+   */
+  SimulatorStatistics getStatistics();
+
+private:
+  void paceLoop();
+  void commandLoop();
+  void sendPacket(const std::vector<uint8_t> &packet);
+
+  SimulatorConfig m_config;
+
+  std::atomic<bool> m_running;
+  std::atomic<double> m_setpoint;
+  std::thread m_paceThread;
+  std::thread m_commandThread;
+
+  SocketHandle m_dataSocket;
+  SocketHandle m_commandSocket;
+
+  std::atomic<uint64_t> m_packetsSent;
+  std::atomic<uint64_t> m_samplesSent;
+  std::atomic<uint64_t> m_sendErrors;
+  std::atomic<uint64_t> m_commandsReceived;
+  std::atomic<uint64_t> m_resyncs;
+  std::atomic<uint64_t> m_maxLatenessNs;
+
+  std::mutex m_impairmentMutex;
+  ImpairmentStatistics m_impairmentStats; // копия из потока темпа
+};
+
+#endif // PLANTSIMULATOR_H
@@ -0,0 +1,90 @@
+#ifndef SCENARIORUNNER_H
+#define SCENARIORUNNER_H
+
+#include "plantsimulator.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief проверка метрики сценария: min <= значение <= max
+ */
+struct ScenarioExpectation {
+  std::string metric;
+  double min;
+  double max;
+};
+
+/**
+ * @brief сценарий нагрузки по loopback
+ *
+ * файл - строки "ключ = значение", '#' - комментарий:
+ *
+ *   name - имя в отчете (по умолчанию - имя файла)
+ *   duration_s - сколько работает источник
+ *   reorder_window_ms - окно переупорядочивания на приеме
+ *   expect_<метрика> = min..max или = значение - проверка
+ *   остальное - ключи SimulatorConfig: частота, размер пакета,
+ *     искажения (loss, burst_enter, reorder, jitter_ms, duplicate, ...)
+ *
+ * порты по умолчанию свои (DEFAULT_DATA_PORT, DEFAULT_COMMAND_PORT),
+ * чтобы сценарий не мешал запущенным визуализатору и модели. кроме
+ * проверок из файла всегда проверяется непрерывность выхода фильтров:
+ * backward_steps, filter_input_skipped и filter_output_skipped равны 0
+ */
+struct Scenario {
+  static constexpr uint16_t DEFAULT_DATA_PORT = 50106;
+  static constexpr uint16_t DEFAULT_COMMAND_PORT = 50105;
+
+  std::string name;
+  SimulatorConfig simulator;
+  double durationSeconds = 5.0;
+  uint32_t reorderWindowMs = Constants::Network::DEFAULT_REORDER_WINDOW_MS;
+  std::vector<ScenarioExpectation> expectations;
+
+  Scenario();
+
+  /**
+   * @brief прочитать сценарий из файла
+   * @throws std::runtime_error если файл не читается или в нем ошибка
+   */
+  static Scenario load(const std::string &path);
+};
+
+/**
+ * @brief результат прогона: метрики и проваленные проверки
+ */
+struct ScenarioResult {
+  std::map<std::string, double> metrics;
+  std::vector<std::string> failures;
+
+  bool passed() const { return failures.empty(); }
+};
+
+/**
+ * @brief прогнать сценарий: PlantSimulator с искажениями -> UdpReceiver
+ * -> DataProcessor со всеми фильтрами
+ *
+ * метрики:
+ *   source_packets, packets_sent, packet_rate - что ушло от источника
+ *   dropped, injected_duplicates, injected_reorders - что сделали
+ *     искажения
+ *   packets_received, lost, reordered, duplicated, gap_events, late -
+ *     статистика UdpReceiver
+ *   network_lost - отправлено, но не принято сокетом
+ *   lost_mismatch = |lost - dropped|,
+ *   duplicate_mismatch = |duplicated - injected_duplicates|
+ *   loss_share = lost / source_packets
+ *   samples_published - сколько отсчетов ушло в фильтры
+ *   max_gap_ms - наибольший разрыв timestamp в сырых отсчетах
+ *   backward_steps - сколько раз timestamp пошел назад (сырые и выходы
+ *     фильтров)
+ *   filter_input_skipped, filter_output_skipped - отсчеты, которые
+ *     фильтр или читатель его выхода не успели забрать
+ *
+ * @throws std::runtime_error если не открылись сокеты
+ */
+ScenarioResult runScenario(const Scenario &scenario);
+
+#endif // SCENARIORUNNER_H
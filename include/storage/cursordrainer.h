@@ -0,0 +1,116 @@
+#ifndef CURSORDRAINER_H
+#define CURSORDRAINER_H
+
+#include "../core/datapoint.h"
+#include "../core/ibufferreader.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief поток, который раз в период забирает отсчеты из курсоров серий
+ *
+ * общий для хранилищ, читающих буферы конвейера своими курсорами
+ * (HistoryStore, SessionRecorder). за период из каждого курсора берется
+ * не больше его capacity(), чтобы быстрый писатель не задержал остальные
+ * серии. пропущенные периоды не догоняются: если обработка затянулась,
+ * следующий период отсчитывается от текущего момента. после stop()
+ * делается последний проход, чтобы дописать то, что успело прийти
+ *
+ * исключение из обработчика останавливает поток, это видно в hasFailed()
+ *
+ * addReader/start/stop вызываются из одного потока
+ */
+class CursorDrainer {
+public:
+  /**
+   * @brief отсчеты серии series по порядку, блоками
+   */
+  using Consumer =
+      std::function<void(size_t series, const DataPoint *points, size_t count)>;
+
+  /**
+   * @brief конструктор
+   * @param period как часто забирать данные из курсоров
+   * @throws std::invalid_argument если период не положительный
+   */
+  explicit CursorDrainer(std::chrono::milliseconds period);
+
+  /**
+   * @brief деструктор
+   * останавливает поток
+   */
+  ~CursorDrainer();
+
+  CursorDrainer(const CursorDrainer &) = delete;
+  CursorDrainer &operator=(const CursorDrainer &) = delete;
+
+  /**
+   * @brief добавить курсор серии (только при остановленном потоке)
+   *
+   * @param reader курсор, после start() его читает только поток
+   * @return номер серии, под которым ее отсчеты придут в Consumer
+   * @throws std::invalid_argument если reader == nullptr
+   * @throws std::runtime_error если поток запущен
+   */
+  size_t addReader(IBufferReader<DataPoint> *reader);
+
+  /**
+   * @brief запустить поток
+   *
+   * накопившиеся в курсорах данные пропускаются
+   *
+   * @param consume обработчик отсчетов
+   * @param seriesDone после прохода по курсору серии, может быть пустым
+   * @param finish в потоке после последнего прохода, может быть пустым
+   */
+  void start(Consumer consume, std::function<void(size_t series)> seriesDone,
+             std::function<void()> finish);
+
+  /**
+   * @brief остановить поток и дождаться последнего прохода
+   */
+  void stop();
+
+  /**
+   * @brief проверить, работает ли поток
+   */
+  bool isRunning() const;
+
+  /**
+   * @brief true, если поток остановился из-за исключения обработчика
+   */
+  bool hasFailed() const;
+
+private:
+  /**
+   * @brief основная функция потока
+   */
+  void run();
+
+  /**
+   * @brief забрать из курсора серии новые отсчеты
+   */
+  void drain(size_t series);
+
+  std::chrono::milliseconds m_period;
+  std::vector<IBufferReader<DataPoint> *> m_readers;
+  std::vector<DataPoint> m_block;
+
+  Consumer m_consume;
+  std::function<void(size_t)> m_seriesDone;
+  std::function<void()> m_finish;
+
+  std::thread m_thread;
+  std::mutex m_stopMutex;
+  std::condition_variable m_stopCondition;
+  std::atomic<bool> m_running;
+  std::atomic<bool> m_failed;
+};
+
+#endif // CURSORDRAINER_H
@@ -0,0 +1,134 @@
+#ifndef GORILLACODEC_H
+#define GORILLACODEC_H
+
+#include "../core/datapoint.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief сжатие блока отсчетов в стиле Gorilla
+ *
+ * timestamp кодируется разностью второго порядка (delta-of-delta): при
+ * ровном шаге отсчетов это один бит на отсчет. value кодируется XOR с
+ * предыдущим значением: одинаковые значения - один бит, у близких
+ * значений пишутся только значащие биты XOR между ведущими и хвостовыми
+ * нулями
+ *
+ * первый отсчет блока пишется как есть, поэтому блок декодируется
+ * независимо от соседних. число отсчетов в поток не пишется - его хранит
+ * контейнер (заголовок чанка), он же отвечает за границы блоков
+ *
+ * кодирование отсчетов (после первого), биты от старших:
+ *   delta-of-delta dod: 0 -> '0'; [-63, 64] -> '10' + 7 бит;
+ *     [-255, 256] -> '110' + 9 бит; [-2047, 2048] -> '1110' + 12 бит;
+ *     иначе '1111' + 32 бита (арифметика по модулю 2^32, так что скачки
+ *     времени назад тоже кодируются)
+ *   XOR значения x: 0 -> '0'; значащие биты x внутри окна предыдущего
+ *     значения -> '10' + биты окна; иначе '11' + 5 бит ведущих нулей +
+ *     5 бит (длина - 1) + значащие биты, окно запоминается
+ */
+class GorillaEncoder {
+public:
+  GorillaEncoder();
+
+  /**
+   * @brief начать новый блок (память буфера переиспользуется)
+   */
+  void reset();
+
+  /**
+   * @brief дописать отсчет в блок
+   */
+  void append(const DataPoint &point);
+
+  /**
+   * @brief дописать отсчеты в блок
+   */
+  void append(const DataPoint *points, size_t count);
+
+  /**
+   * @brief сколько отсчетов в блоке
+   */
+  size_t count() const;
+
+  /**
+   * @brief закончить блок: добить последний байт нулями
+   *
+   * после finish() блок можно только прочитать или начать заново reset()
+   *
+   * @return закодированный блок
+   */
+  const std::vector<uint8_t> &finish();
+
+  /**
+   * @brief сжать count отсчетов одним блоком
+   */
+  static void encode(const DataPoint *points, size_t count,
+                     std::vector<uint8_t> &out);
+
+private:
+  void writeBits(uint64_t value, unsigned bits);
+
+  std::vector<uint8_t> m_bytes;
+  uint64_t m_accumulator; // недописанные биты, младшие m_pending
+  unsigned m_pending;
+
+  size_t m_count;
+  uint32_t m_lastTimestamp;
+  uint32_t m_lastDelta;
+  uint32_t m_lastValue; // биты float
+  unsigned m_leading;   // окно значащих битов последнего XOR
+  unsigned m_trailing;
+};
+
+/**
+ * @brief чтение блока, записанного GorillaEncoder
+ *
+ * декодер не владеет данными блока, они должны жить, пока он читает
+ */
+class GorillaDecoder {
+public:
+  /**
+   * @param data закодированный блок
+   * @param size его размер в байтах
+   * @param count сколько отсчетов в блоке (из контейнера)
+   */
+  GorillaDecoder(const uint8_t *data, size_t size, size_t count);
+
+  /**
+   * @brief сколько отсчетов еще не прочитано
+   */
+  size_t remaining() const;
+
+  /**
+   * @brief прочитать следующие отсчеты
+   *
+   * @return сколько прочитано, не больше maxCount и remaining()
+   * @throws std::runtime_error если блок кончился раньше отсчетов
+   */
+  size_t decode(DataPoint *out, size_t maxCount);
+
+  /**
+   * @brief распаковать блок целиком
+   * @throws std::runtime_error если блок поврежден
+   */
+  static void decode(const uint8_t *data, size_t size, size_t count,
+                     DataPoint *out);
+
+private:
+  const uint8_t *m_data;
+  const uint8_t *m_end;
+  uint64_t m_accumulator; // непрочитанные биты, выровнены к старшему
+  unsigned m_available;
+
+  size_t m_remaining;
+  bool m_started;
+  uint32_t m_lastTimestamp;
+  uint32_t m_lastDelta;
+  uint32_t m_lastValue;
+  unsigned m_leading;
+  unsigned m_trailing;
+};
+
+#endif // GORILLACODEC_H
@@ -0,0 +1,253 @@
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include "../core/datapoint.h"
+#include "../core/ibufferreader.h"
+#include "../core/minmaxdecimator.h"
+#include "cursordrainer.h"
+#include "mappedfile.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief история серий на диске во всю частоту отсчетов
+ *
+ * поток записи (CursorDrainer) сам читает серии из буферов конвейера
+ * своими курсорами и дописывает каждый отсчет в файлы-чанки по
+ * CHUNK_SAMPLES отсчетов, отображенные в память. в чанке за отсчетами
+ * лежат сводки min/max по блокам SUMMARY_BLOCK отсчетов, сводка всего
+ * чанка хранится в памяти
+ *
+ * query() отдает графику точки видимого окна с тем же контрактом, что у
+ * MinMaxDecimator::decimate. целиком попавшие в столбец чанки берутся из
+ * сводок в памяти, блоки - из сводок на диске, отсчеты читаются только по
+ * краям столбцов, поэтому запрос по любому окну трогает не больше пары
+ * страниц на столбец. чанки для чтения отображаются лениво, открытыми
+ * держится не больше MAX_MAPPED_CHUNKS, так что расход памяти не зависит
+ * от длины сессии (растет только оглавление: десятки байт на чанк)
+ *
+ * отсчеты серии должны идти по возрастанию timestamp: опоздавшие
+ * отбрасываются, скачок назад больше Constants::RESTART_GAP_MS начинает
+ * историю серии заново, как в TimeSeriesPyramid
+ *
+ * addSeries/start/stop/query вызываются из одного потока (GUI), запись
+ * идет в своем потоке
+ */
+class HistoryStore {
+public:
+  static constexpr size_t CHUNK_SAMPLES = 65536;
+  static constexpr size_t SUMMARY_BLOCK = 256;
+  static constexpr size_t MAX_MAPPED_CHUNKS = 32;
+
+  /**
+   * @brief конструктор
+   * @param directory каталог сессии, при start() его чанки удаляются
+   * @param period как часто поток записи забирает данные из буферов
+   */
+  explicit HistoryStore(
+      const std::string &directory,
+      std::chrono::milliseconds period = std::chrono::milliseconds(20));
+
+  /**
+   * @brief деструктор
+   * останавливает поток записи
+   */
+  ~HistoryStore();
+
+  HistoryStore(const HistoryStore &) = delete;
+  HistoryStore &operator=(const HistoryStore &) = delete;
+
+  /**
+   * @brief добавить серию (только при остановленном потоке)
+   *
+   * @param name имя серии
+   * @param reader курсор чтения серии, его читает только поток записи
+   * @return номер серии для query()
+   */
+  size_t addSeries(const std::string &name, IBufferReader<DataPoint> *reader);
+
+  /**
+   * @brief номер серии по имени
+   * @return номер или -1, если такой серии нет
+   */
+  int findSeries(const std::string &name) const;
+
+  /**
+   * @brief запустить поток записи
+   *
+   * чанки прошлой сессии удаляются, накопившиеся в курсорах данные
+   * пропускаются
+   *
+   * @throws std::runtime_error если каталог не создается
+   */
+  void start();
+
+  /**
+   * @brief остановить поток записи
+   *
+   * записанная история остается доступной для query() до следующего start()
+   */
+  void stop();
+
+  /**
+   * @brief проверить, работает ли поток
+   */
+  bool isRunning() const;
+
+  /**
+   * @brief диапазон времени записанной истории серии
+   * @return false, если у серии нет отсчетов
+   */
+  bool keyRange(size_t series, double &firstKey, double &lastKey) const;
+
+  /**
+   * @brief точки для отрисовки диапазона [keyLower, keyUpper]
+   *
+   * тот же контракт, что у MinMaxDecimator::decimate: min и max на
+   * столбец в порядке времени плюс ближайшие отсчеты за краями, не больше
+   * MinMaxDecimator::maxOutputSize(columns) точек. отсчеты последнего
+   * периода записи могут быть еще не видны
+   *
+   * @return сколько точек записано
+   */
+  size_t query(size_t series, double keyLower, double keyUpper,
+               size_t columns, double *outKeys, double *outValues);
+
+  /**
+   * @brief сколько отсчетов записано на диск
+   */
+  uint64_t getWrittenSamples() const;
+
+  /**
+   * @brief сколько отсчетов отброшено как опоздавшие
+   */
+  uint64_t getDroppedSamples() const;
+
+  /**
+   * @brief сколько места на диске занимают чанки (байт)
+   */
+  uint64_t getDiskUsage() const;
+
+  /**
+   * @brief true, если запись остановилась из-за ошибки (нет места и т.п.)
+   */
+  bool hasFailed() const;
+
+private:
+  /**
+   * @brief сводка min/max по подряд идущим отсчетам, так же лежит на диске
+   */
+  using Summary = MinMaxDecimator::MinMax;
+
+  /**
+   * @brief заголовок файла-чанка, за ним отсчеты и сводки блоков
+   */
+  struct ChunkHeader {
+    uint32_t magic;
+    uint32_t count; // сколько отсчетов записано
+    uint32_t firstKey;
+    uint32_t lastKey;
+  };
+
+  /**
+   * @brief оглавление чанка
+   *
+   * summary заполнена, когда чанк заполнен целиком
+   */
+  struct ChunkInfo {
+    uint64_t fileNumber; // номер файла серии, не повторяется за сессию
+    uint32_t count;
+    uint32_t firstKey;
+    uint32_t lastKey;
+    Summary summary;
+  };
+
+  /**
+   * @brief серия: курсор, оглавление и состояние записи
+   */
+  struct SeriesState {
+    std::string name;
+
+    // оглавление, его читает query(): под m_indexMutex
+    std::vector<ChunkInfo> chunks;
+
+    // дальше только поток записи
+    MappedFile writeFile; // чанк, в который идет запись
+    ChunkInfo current;    // его оглавление, публикуется пачкой
+    Summary block;        // сводка незаконченного блока
+    uint64_t nextFileNumber;
+    uint32_t lastKey; // последний принятый отсчет, для проверки порядка
+    bool hasLast;
+    bool hasCurrent;
+  };
+
+  /**
+   * @brief отображенный для чтения чанк
+   */
+  struct MappedChunk {
+    size_t series;
+    uint64_t fileNumber;
+    uint64_t lastUse;
+    MappedFile file;
+  };
+
+  /**
+   * @brief снимок оглавления серии, по которому идет один запрос
+   */
+  struct QueryView {
+    size_t series;
+    std::vector<ChunkInfo> chunks;
+    uint64_t total; // отсчетов во всех чанках
+  };
+
+  static size_t chunkFileSize();
+
+  std::string chunkPath(size_t series, uint64_t fileNumber) const;
+  void removeChunkFiles();
+
+  /**
+   * @brief дописать отсчеты серии, пришедшие из курсора
+   */
+  void consume(size_t series, const DataPoint *points, size_t count);
+  void append(SeriesState &state, const DataPoint &point);
+  void openChunk(SeriesState &state);
+  void restartSeries(SeriesState &state);
+
+  /**
+   * @brief показать query() записанное в текущий чанк
+   */
+  void publish(SeriesState &state);
+
+  // чтение: отсчеты идут сквозным номером по всем чанкам снимка
+  const uint8_t *mapChunk(size_t series, uint64_t fileNumber);
+  const DataPoint *chunkSamples(const QueryView &view, size_t chunk);
+  const Summary *chunkBlocks(const QueryView &view, size_t chunk);
+  DataPoint sampleAt(const QueryView &view, uint64_t index);
+  uint64_t lowerBound(const QueryView &view, double key, uint64_t first,
+                      uint64_t last);
+  uint64_t upperBound(const QueryView &view, double key, uint64_t first,
+                      uint64_t last);
+  Summary aggregate(const QueryView &view, uint64_t first, uint64_t last);
+
+  std::string m_directory;
+  std::vector<SeriesState> m_series;
+
+  mutable std::mutex m_indexMutex;
+
+  // отображенные для чтения чанки, вытесняются по давности использования
+  std::vector<MappedChunk> m_mapped;
+  uint64_t m_useCounter;
+  QueryView m_view; // снимок оглавления, память переиспользуется
+
+  CursorDrainer m_drainer;
+  std::atomic<uint64_t> m_writtenSamples;
+  std::atomic<uint64_t> m_droppedSamples;
+  std::atomic<uint64_t> m_diskUsage;
+};
+
+#endif // HISTORYSTORE_H
@@ -0,0 +1,66 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief файл, отображенный в память целиком
+ *
+ * в режиме ReadWrite файл создается (или перезаписывается) заданного
+ * размера, в режиме ReadOnly открывается существующий. несколько
+ * отображений одного файла видят одни и те же страницы, поэтому читатель
+ * видит данные, записанные писателем через другое отображение
+ */
+class MappedFile {
+public:
+  enum class Mode { ReadOnly, ReadWrite };
+
+  MappedFile();
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  /**
+   * @brief открыть и отобразить файл
+   *
+   * @param path путь к файлу
+   * @param size размер файла (для ReadOnly - сколько отображать)
+   * @param mode режим доступа
+   * @throws std::runtime_error если файл не открылся или не отобразился
+   */
+  void open(const std::string &path, size_t size, Mode mode);
+
+  /**
+   * @brief снять отображение и закрыть файл
+   */
+  void close();
+
+  /**
+   * @brief попросить ОС сбросить измененные страницы на диск (не ждет)
+   */
+  void flush();
+
+  bool isOpen() const { return m_data != nullptr; }
+  uint8_t *data() { return m_data; }
+  const uint8_t *data() const { return m_data; }
+  size_t size() const { return m_size; }
+
+private:
+  void swap(MappedFile &other) noexcept;
+
+  uint8_t *m_data;
+  size_t m_size;
+#ifdef _WIN32
+  void *m_file;    // HANDLE файла
+  void *m_mapping; // HANDLE отображения
+#else
+  int m_fd;
+#endif
+};
+
+#endif // MAPPEDFILE_H
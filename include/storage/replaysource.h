@@ -0,0 +1,186 @@
+#ifndef REPLAYSOURCE_H
+#define REPLAYSOURCE_H
+
+#include "../core/broadcastringbuffer.h"
+#include "../core/datapoint.h"
+#include "../core/ibufferreader.h"
+#include "sessionreader.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief источник отсчетов из записи сессии вместо UDP
+ *
+ * поток воспроизведения читает серию записи по чанкам и публикует отсчеты
+ * в тот же журнал, куда пишет UdpReceiver, так что фильтры, график и
+ * запись работают как при живом приеме
+ *
+ * темп задается Pacing: по timestamp в реальном времени, в speed раз
+ * быстрее или так быстро, как успевают потребители. в последнем режиме
+ * писатель не обгоняет потребителей, добавленных через addConsumer(),
+ * больше чем на журнал (иначе они теряли бы отсчеты), и это заодно замер
+ * пропускной способности: для каждого потребителя считается, за сколько
+ * он прочитал все воспроизведенные отсчеты
+ */
+class ReplaySource {
+public:
+  enum class Pacing {
+    RealTime,        // по timestamp записи
+    Scaled,          // по timestamp, в speed раз быстрее
+    AsFastAsPossible // без пауз, сколько успевают потребители
+  };
+
+  /**
+   * @brief пропускная способность одного потребителя
+   */
+  struct ConsumerReport {
+    std::string name;
+    uint64_t samples = 0;   // сколько отсчетов прочитал
+    double seconds = 0.0;   // от старта до последнего прочитанного
+    double samplesPerSecond = 0.0; // 0 для застрявшего: замера нет
+    bool stalled = false;   // перестал читать, писатель его не ждал
+  };
+
+  /**
+   * @brief конструктор
+   * @param buffer журнал сырых отсчетов, как у UdpReceiver
+   */
+  explicit ReplaySource(BroadcastRingBuffer<DataPoint> *buffer);
+
+  /**
+   * @brief деструктор
+   * останавливает воспроизведение
+   */
+  ~ReplaySource();
+
+  ReplaySource(const ReplaySource &) = delete;
+  ReplaySource &operator=(const ReplaySource &) = delete;
+
+  /**
+   * @brief открыть запись (только при остановленном воспроизведении)
+   *
+   * @param path файл записи сессии
+   * @param series какую серию воспроизводить (обычно сырые данные)
+   * @throws std::runtime_error если файл не читается или серии нет
+   */
+  void open(const std::string &path, const std::string &series = "Raw");
+
+  /**
+   * @brief добавить потребителя журнала (только при остановленном
+   * воспроизведении)
+   *
+   * @param name имя для отчета
+   * @param reader курсор потребителя, отсюда только смотрим его отставание
+   */
+  void addConsumer(const std::string &name,
+                   const IBufferReader<DataPoint> *reader);
+
+  /**
+   * @brief убрать всех потребителей
+   */
+  void clearConsumers();
+
+  /**
+   * @brief начать воспроизведение открытой записи с начала
+   *
+   * @param pacing темп
+   * @param speed множитель скорости для Pacing::Scaled, > 0
+   * @return false, если запись не открыта или уже воспроизводится
+   */
+  bool start(Pacing pacing, double speed = 1.0);
+
+  /**
+   * @brief остановить воспроизведение
+   */
+  void stop();
+
+  /**
+   * @brief идет ли воспроизведение (поток работает и запись не кончилась)
+   */
+  bool isRunning() const;
+
+  /**
+   * @brief вся запись опубликована и потребители ее дочитали
+   */
+  bool isFinished() const;
+
+  /**
+   * @brief сколько отсчетов опубликовано
+   */
+  uint64_t getSamplesReplayed() const;
+
+  /**
+   * @brief сколько отсчетов в воспроизводимой серии
+   */
+  uint64_t getTotalSamples() const;
+
+  /**
+   * @brief отчет по потребителям (готов, когда isFinished())
+   */
+  std::vector<ConsumerReport> getConsumerReports() const;
+
+  /**
+   * @brief почему воспроизведение кончилось раньше конца записи
+   * (поврежденный чанк), пусто - запись воспроизведена целиком
+   */
+  std::string getError() const;
+
+private:
+  struct Consumer {
+    std::string name;
+    const IBufferReader<DataPoint> *reader;
+    uint64_t lastBacklog;                        // отставание при проверке
+    std::chrono::steady_clock::time_point moved; // когда оно менялось
+    bool stalled;
+  };
+
+  /**
+   * @brief основная функция потока
+   */
+  void run();
+
+  /**
+   * @brief опубликовать блок, дождавшись места у потребителей
+   */
+  void publish(const DataPoint *points, size_t count);
+
+  /**
+   * @brief ждать, пока у всех потребителей отставание не станет не больше
+   * backlog (застрявших не ждем)
+   */
+  bool waitForConsumers(size_t backlog);
+
+  /**
+   * @brief ждать до момента, прерывается stop()
+   * @return false, если воспроизведение остановили
+   */
+  bool sleepUntil(std::chrono::steady_clock::time_point deadline);
+
+  BroadcastRingBuffer<DataPoint> *m_buffer;
+  SessionReader m_reader;
+  size_t m_series;
+  uint64_t m_totalSamples;
+
+  Pacing m_pacing;
+  double m_speed;
+  std::vector<Consumer> m_consumers;
+
+  mutable std::mutex m_reportMutex;
+  std::vector<ConsumerReport> m_reports;
+  std::string m_error; // под m_reportMutex
+
+  std::thread m_thread;
+  std::mutex m_stopMutex;
+  std::condition_variable m_stopCondition;
+  std::atomic<bool> m_running;
+  std::atomic<bool> m_finished;
+  std::atomic<uint64_t> m_samplesReplayed;
+};
+
+#endif // REPLAYSOURCE_H
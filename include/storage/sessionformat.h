@@ -0,0 +1,86 @@
+#ifndef SESSIONFORMAT_H
+#define SESSIONFORMAT_H
+
+#include <cstdint>
+
+/**
+ * @brief формат файла записи сессии (.pidrec)
+ *
+ * файл только дописывается:
+ *
+ *   FileHeader, затем seriesCount имен серий (uint16 длина + байты)
+ *   чанки: ChunkHeader, затем size байт отсчетов
+ *   оглавление: IndexEntry на каждый чанк в порядке записи
+ *   FooterTail - последние 16 байт файла
+ *
+ * в чанке одна серия. отсчеты ENCODING_RAW лежат по столбцам: uint32
+ * timestamp[count], затем float value[count]. ENCODING_GORILLA - блок
+ * GorillaEncoder, в среднем в 2-4 раза меньше. по оглавлению чанк с нужным
+ * временем ищется двоичным поиском, без чтения самих данных. если запись
+ * оборвалась и оглавления нет, его можно восстановить проходом по
+ * заголовкам чанков
+ *
+ * время внутри серии растет в пределах участка (segment). когда источник
+ * перезапускается и время скачет назад больше Constants::RESTART_GAP_MS,
+ * чанк закрывается и начинается следующий участок. в восстановленном
+ * оглавлении участки определяются по скачку времени назад между чанками
+ *
+ * в версии 1 заголовок чанка был на 4 байта короче (без size), а чанки
+ * всегда ENCODING_RAW
+ *
+ * все поля little-endian, структуры без выравнивающих дыр
+ */
+namespace SessionFormat {
+
+constexpr uint32_t FILE_MAGIC = 0x43525050;   // "PPRC"
+constexpr uint32_t CHUNK_MAGIC = 0x4B4E4843;  // "CHNK"
+constexpr uint32_t FOOTER_MAGIC = 0x58444950; // "PIDX"
+constexpr uint16_t VERSION = 2;
+
+constexpr uint16_t ENCODING_RAW = 0;
+constexpr uint16_t ENCODING_GORILLA = 1;
+
+struct FileHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t seriesCount;
+};
+
+struct ChunkHeader {
+  uint32_t magic;
+  uint16_t series;   // номер серии в заголовке файла
+  uint16_t encoding; // ENCODING_*
+  uint32_t count;
+  uint32_t firstTimestamp;
+  uint32_t lastTimestamp;
+  uint32_t size; // байт отсчетов за заголовком
+};
+
+// длина заголовка чанка в файле версии version
+constexpr uint32_t chunkHeaderSize(uint16_t version) {
+  return version < 2 ? 20 : 24;
+}
+
+struct IndexEntry {
+  uint64_t offset; // смещение ChunkHeader от начала файла
+  uint16_t series;
+  uint16_t segment; // участок серии, в старых записях 0
+  uint32_t count;
+  uint32_t firstTimestamp;
+  uint32_t lastTimestamp;
+};
+
+struct FooterTail {
+  uint64_t indexOffset; // смещение первого IndexEntry
+  uint32_t entryCount;
+  uint32_t magic;
+};
+
+static_assert(sizeof(FileHeader) == 8, "FileHeader layout changed");
+static_assert(sizeof(ChunkHeader) == 24, "ChunkHeader layout changed");
+static_assert(sizeof(IndexEntry) == 24, "IndexEntry layout changed");
+static_assert(sizeof(FooterTail) == 16, "FooterTail layout changed");
+
+} // namespace SessionFormat
+
+#endif // SESSIONFORMAT_H
@@ -0,0 +1,123 @@
+#ifndef SESSIONREADER_H
+#define SESSIONREADER_H
+
+#include "../core/datapoint.h"
+#include "sessionformat.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief чтение файла записи сессии (SessionFormat)
+ *
+ * при открытии читается только заголовок и оглавление, отсчеты читаются
+ * по чанку. чанк серии, содержащий нужное время, находится двоичным
+ * поиском по оглавлению. если оглавления нет (запись оборвалась), оно
+ * восстанавливается проходом по заголовкам чанков, оборванный последний
+ * чанк отбрасывается
+ *
+ * время серии растет только в пределах участка (см. SessionFormat),
+ * поэтому поиск по времени идет внутри одного участка. чанки участка идут
+ * в оглавлении серии подряд
+ */
+class SessionReader {
+public:
+  SessionReader();
+
+  /**
+   * @brief открыть файл записи
+   * @throws std::runtime_error если файл не открылся или это не запись
+   */
+  void open(const std::string &path);
+
+  /**
+   * @brief закрыть файл
+   */
+  void close();
+
+  bool isOpen() const;
+
+  /**
+   * @brief true, если оглавления не было и оно восстановлено по чанкам
+   */
+  bool wasRecovered() const;
+
+  size_t seriesCount() const;
+  const std::string &seriesName(size_t series) const;
+
+  /**
+   * @brief номер серии по имени
+   * @return номер или -1, если такой серии нет
+   */
+  int findSeries(const std::string &name) const;
+
+  /**
+   * @brief оглавление серии: чанки в порядке записи
+   */
+  const std::vector<SessionFormat::IndexEntry> &
+  chunks(size_t series) const;
+
+  /**
+   * @brief сколько отсчетов у серии
+   */
+  uint64_t sampleCount(size_t series) const;
+
+  /**
+   * @brief сколько участков у серии
+   */
+  size_t segmentCount(size_t series) const;
+
+  /**
+   * @brief чанки участка: [first, last) в оглавлении серии
+   */
+  void segmentChunks(size_t series, size_t segment, size_t &first,
+                     size_t &last) const;
+
+  /**
+   * @brief первый чанк участка, где есть отсчеты не раньше timestamp
+   * @return номер чанка в оглавлении серии или конец участка, если таких
+   * нет
+   */
+  size_t findChunk(size_t series, size_t segment, uint32_t timestamp) const;
+
+  /**
+   * @brief прочитать отсчеты чанка
+   *
+   * @param series номер серии
+   * @param chunk номер чанка в оглавлении серии
+   * @param out куда положить отсчеты (размер меняется)
+   * @throws std::runtime_error если данные чанка не читаются
+   */
+  void readChunk(size_t series, size_t chunk, std::vector<DataPoint> &out);
+
+private:
+  void read(void *data, size_t size);
+
+  /**
+   * @brief прочитать заголовок чанка с текущей позиции файла
+   *
+   * заголовок версии 1 дополняется до текущего: size и ENCODING_RAW
+   *
+   * @return false, если это не заголовок чанка
+   */
+  bool readChunkHeader(SessionFormat::ChunkHeader &header);
+  bool readFooter(uint64_t fileSize);
+  void rebuildIndex(uint64_t dataBegin, uint64_t fileSize);
+  void addEntry(SessionFormat::IndexEntry entry);
+
+  std::ifstream m_file;
+  uint16_t m_version;
+  bool m_recovered;
+  std::vector<std::string> m_names;
+  std::vector<std::vector<SessionFormat::IndexEntry>> m_chunks;
+  std::vector<std::vector<size_t>> m_segments; // первый чанк участка
+
+  // данные читаемого чанка, переиспользуются
+  std::vector<uint32_t> m_timestamps;
+  std::vector<float> m_values;
+  std::vector<uint8_t> m_encoded;
+};
+
+#endif // SESSIONREADER_H
@@ -0,0 +1,154 @@
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+#include "../core/datapoint.h"
+#include "../core/ibufferreader.h"
+#include "cursordrainer.h"
+#include "gorillacodec.h"
+#include "sessionformat.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief запись сессии в файл формата SessionFormat
+ *
+ * поток записи (CursorDrainer) сам читает серии из буферов конвейера,
+ * сжимает отсчеты каждой серии GorillaEncoder по ходу чтения и дописывает
+ * чанком каждые CHUNK_SAMPLES отсчетов. прием и фильтры на диск не ждут:
+ * курсор, который не успевает, пропускает отсчеты в своем буфере, а не
+ * задерживает писателя
+ *
+ * отсчеты серии должны идти по возрастанию timestamp, как в HistoryStore:
+ * опоздавшие отбрасываются, скачок назад больше Constants::RESTART_GAP_MS
+ * закрывает чанк и начинает следующий участок серии в оглавлении
+ *
+ * stop() дописывает неполные чанки и оглавление. файл без оглавления
+ * (запись оборвалась) читается SessionReader с восстановлением
+ */
+class SessionRecorder {
+public:
+  static constexpr size_t CHUNK_SAMPLES = 4096;
+
+  /**
+   * @brief конструктор
+   * @param period как часто поток записи забирает данные из буферов
+   */
+  explicit SessionRecorder(
+      std::chrono::milliseconds period = std::chrono::milliseconds(20));
+
+  /**
+   * @brief деструктор
+   * останавливает запись и закрывает файл
+   */
+  ~SessionRecorder();
+
+  SessionRecorder(const SessionRecorder &) = delete;
+  SessionRecorder &operator=(const SessionRecorder &) = delete;
+
+  /**
+   * @brief добавить серию (только при остановленной записи)
+   *
+   * @param name имя серии, попадает в заголовок файла
+   * @param reader курсор чтения серии, его читает только поток записи
+   */
+  void addSeries(const std::string &name, IBufferReader<DataPoint> *reader);
+
+  /**
+   * @brief начать запись в новый файл
+   *
+   * накопившиеся в курсорах данные пропускаются
+   *
+   * @param path путь к файлу, существующий перезаписывается
+   * @throws std::runtime_error если файл не открылся
+   */
+  void start(const std::string &path);
+
+  /**
+   * @brief закончить запись: неполные чанки, оглавление, закрытие файла
+   */
+  void stop();
+
+  /**
+   * @brief проверить, идет ли запись
+   */
+  bool isRunning() const;
+
+  /**
+   * @brief true, если запись прервалась из-за ошибки ввода-вывода
+   */
+  bool hasFailed() const;
+
+  /**
+   * @brief сколько отсчетов записано (всех серий)
+   */
+  uint64_t getRecordedSamples() const;
+
+  /**
+   * @brief сколько отсчетов отброшено как опоздавшие
+   */
+  uint64_t getDroppedSamples() const;
+
+  /**
+   * @brief сколько байт записано в файл
+   */
+  uint64_t getBytesWritten() const;
+
+  /**
+   * @brief во сколько раз сжаты записанные отсчеты (8 байт на отсчет
+   * против байт чанков с заголовками)
+   */
+  double getCompressionRatio() const;
+
+private:
+  /**
+   * @brief серия: курсор и копящийся сжатый чанк
+   */
+  struct SeriesState {
+    std::string name;
+    GorillaEncoder encoder;
+    uint32_t firstTimestamp;
+    uint32_t lastTimestamp; // последний принятый отсчет, и между чанками
+    uint16_t segment;       // текущий участок серии
+    bool hasLast;
+  };
+
+  /**
+   * @brief сжать отсчеты серии, пришедшие из курсора
+   */
+  void consume(size_t series, const DataPoint *points, size_t count);
+
+  /**
+   * @brief дописать неполные чанки всех серий и оглавление
+   */
+  void finish();
+
+  /**
+   * @brief дописать накопленный чанк серии
+   */
+  void writeChunk(size_t series);
+
+  /**
+   * @brief дописать оглавление и хвост файла
+   */
+  void writeFooter();
+
+  void write(const void *data, size_t size);
+
+  std::vector<SeriesState> m_series;
+
+  // только поток записи (и start() до его запуска)
+  std::ofstream m_file;
+  std::vector<SessionFormat::IndexEntry> m_index;
+
+  CursorDrainer m_drainer;
+  std::atomic<uint64_t> m_recordedSamples;
+  std::atomic<uint64_t> m_droppedSamples;
+  std::atomic<uint64_t> m_bytesWritten;
+  std::atomic<uint64_t> m_chunkBytes;
+};
+
+#endif // SESSIONRECORDER_H
@@ -2,7 +2,11 @@
 #define GRAPHMANAGER_H
 
 #include "../core/datapoint.h"
-#include "../core/threadsaferingbuffer.h"
+#include "../core/ibufferreader.h"
+#include "../core/latency.h"
+#include "../core/timeseriespyramid.h"
+#include "../processing/spectrumanalyzer.h"
+#include "../storage/historystore.h"
 #include <QWidget>
 #include <memory>
 #include <qcustomplot.h>
@@ -13,10 +17,10 @@ class QTabWidget;
 // структура для хранения пары график-буфер
 struct GraphSeries {
   QCPGraph *graph;
-  ThreadSafeRingBuffer<DataPoint> *buffer;
+  IBufferReader<DataPoint> *buffer;
   QString name;
 
-  GraphSeries(QCPGraph *g, ThreadSafeRingBuffer<DataPoint> *b, const QString &n)
+  GraphSeries(QCPGraph *g, IBufferReader<DataPoint> *b, const QString &n)
       : graph(g), buffer(b), name(n) {}
 };
 
@@ -32,7 +36,14 @@ public:
 
   // обновление графиков
   void updateGraph(const std::vector<GraphSeries> &series, size_t maxSamples);
-  void updateSpectrum(const std::vector<GraphSeries> &series, bool isRunning);
+  // отрисовка готового кадра спектров из SpectrumAnalyzer
+  void drawSpectrum(const SpectrumFrame &frame);
+  // история на диске для окон старше истории в памяти (nullptr - нет)
+  void setHistoryStore(HistoryStore *store);
+  // куда писать задержки до отрисовки: filterToPlot и endToEnd - возраст
+  // самого свежего отсчета каждой видимой серии, когда он впервые
+  // нарисован (nullptr - не считать)
+  void setLatency(PipelineLatency *latency);
 
   // управление видимостью серий
   void setSeriesVisible(const QString &name, bool visible);
@@ -47,12 +58,33 @@ public:
   QCPGraph *getExponentialGraph() const { return m_exponentialGraph; }
   QCPGraph *getKalmanGraph() const { return m_kalmanGraph; }
 
+private slots:
+  void onSignalRangeChanged(const QCPRange &range);
+
 private:
-  bool readBufferData(ThreadSafeRingBuffer<DataPoint> *buffer,
-                      std::vector<DataPoint> &data);
-  void addPointsToGraph(QCPGraph *graph, const std::vector<DataPoint> &data);
-  void removeOldPoints(const std::vector<QCPGraph *> &graphs,
-                       size_t maxSamples);
+  // история серии сигнала с уровнями сводок: на график уходит только ее
+  // видимая часть, min/max на столбец пикселей
+  struct SeriesHistory {
+    QCPGraph *graph;
+    TimeSeriesPyramid store;
+    std::string diskName; // имя серии в HistoryStore
+    SampleStamp newest;   // метки последнего отсчета, забранного за тик
+    bool hasNewest;       // за тик пришли отсчеты
+
+    SeriesHistory(QCPGraph *g, size_t capacity, const std::string &name)
+        : graph(g), store(capacity), diskName(name), hasNewest(false) {}
+  };
+
+  SeriesHistory *findHistory(QCPGraph *graph);
+  void appendFromBuffer(SeriesHistory &history,
+                        IBufferReader<DataPoint> *buffer);
+  void followLastSamples(size_t maxSamples);
+  void rebuildLevelOfDetail(bool rescaleValueAxis);
+  void recordFrameLatency();
+  size_t queryHistory(SeriesHistory &history, const QCPRange &keyRange,
+                      size_t columns);
+  void setAxisRange(QCPAxis *axis, const QCPRange &range);
+  QCPGraph *getSpectrumGraph(const std::string &name) const;
 
   QCustomPlot *m_plot;
   QCustomPlot *m_spectrumPlot;
@@ -71,6 +103,18 @@ private:
   QCPGraph *m_medianSpectrumGraph;
   QCPGraph *m_exponentialSpectrumGraph;
   QCPGraph *m_kalmanSpectrumGraph;
+
+  std::vector<SeriesHistory> m_histories;
+  HistoryStore *m_historyStore;
+
+  // рабочие буферы обновления графика, переиспользуются между тиками
+  std::vector<DataPoint> m_readBlock; // блок, забранный из буфера серии
+  std::vector<SampleStamp> m_readStamps; // метки отсчетов m_readBlock
+  PipelineLatency *m_latency;
+  std::vector<double> m_lodKeys;      // прореженные точки одной серии
+  std::vector<double> m_lodValues;
+  bool m_followingRange; // окно двигает updateGraph, а не пользователь
+  bool m_followLatest;   // окно едет за последними отсчетами
 };
 
 #endif // GRAPHMANAGER_H
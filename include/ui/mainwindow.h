@@ -22,11 +22,16 @@ class MainWindow;
 
 #include "../core/Constants.h"
 #include "../core/datapoint.h"
-#include "../core/threadsaferingbuffer.h"
+#include "../core/broadcastringbuffer.h"
+#include "../core/latency.h"
+#include "../network/networkcontroller.h"
 #include "../processing/dataprocessor.h"
+#include "../processing/spectrumanalyzer.h"
+#include "../storage/historystore.h"
+#include "../storage/replaysource.h"
+#include "../storage/sessionrecorder.h"
 #include "cyclictargetcontroller.h"
 #include "graphmanager.h"
-#include "networkcontroller.h"
 #include "statusbarmanager.h"
 
 class MovingAverageFilter;
@@ -44,6 +49,7 @@ public:
 private slots:
   void onSendButtonClicked();
   void onStartStopButtonClicked();
+  void onReplayButtonClicked();
   void updateGraph();
 
 private:
@@ -51,6 +57,15 @@ private:
   void setupFilters();
   void setupTimer();
   void connectSignals();
+  void startHistory();
+  void startRecording();
+  void startPipeline();
+  void reportReplay();
+  void saveTrace();
+
+  // задержки по стадиям: пишут поток приема, потоки фильтров и график,
+  // объявлены раньше компонентов, чтобы пережить их потоки
+  PipelineLatency m_latency;
 
   // компоненты приложения
   std::unique_ptr<NetworkController> m_networkController;
@@ -59,18 +74,36 @@ private:
   std::unique_ptr<CyclicTargetController> m_cyclicTargetController;
   std::unique_ptr<StatusBarManager> m_statusBarManager;
 
-  // буферы для данных (нужны для фильтров и графиков)
-  std::unique_ptr<ThreadSafeRingBuffer<DataPoint>> m_rawDataDisplayBuffer;
-  std::unique_ptr<ThreadSafeRingBuffer<DataPoint>> m_rawBufferMovingAvg;
-  std::unique_ptr<ThreadSafeRingBuffer<DataPoint>> m_rawBufferMedian;
-  std::unique_ptr<ThreadSafeRingBuffer<DataPoint>> m_rawBufferExponential;
-  std::unique_ptr<ThreadSafeRingBuffer<DataPoint>> m_rawBufferKalman;
-
-  // буферы для отображения (получаем от DataProcessor)
-  ThreadSafeRingBuffer<DataPoint> *m_movingAvgBuffer;
-  ThreadSafeRingBuffer<DataPoint> *m_medianBuffer;
-  ThreadSafeRingBuffer<DataPoint> *m_exponentialBuffer;
-  ThreadSafeRingBuffer<DataPoint> *m_kalmanBuffer;
+  // общий журнал сырых отсчетов: пишет только поток приема
+  std::unique_ptr<BroadcastRingBuffer<DataPoint>> m_rawStream;
+
+  // курсоры чтения журнала для графика и для каждого фильтра (владеет журнал)
+  BroadcastRingBuffer<DataPoint>::Reader *m_rawDataDisplayBuffer;
+  BroadcastRingBuffer<DataPoint>::Reader *m_rawBufferMovingAvg;
+  BroadcastRingBuffer<DataPoint>::Reader *m_rawBufferMedian;
+  BroadcastRingBuffer<DataPoint>::Reader *m_rawBufferExponential;
+  BroadcastRingBuffer<DataPoint>::Reader *m_rawBufferKalman;
+
+  // курсоры графика в журналах результатов фильтров (получаем от
+  // DataProcessor)
+  BroadcastRingBuffer<DataPoint>::Reader *m_movingAvgBuffer;
+  BroadcastRingBuffer<DataPoint>::Reader *m_medianBuffer;
+  BroadcastRingBuffer<DataPoint>::Reader *m_exponentialBuffer;
+  BroadcastRingBuffer<DataPoint>::Reader *m_kalmanBuffer;
+
+  // расчет спектров в своем потоке, GUI только рисует готовые кадры
+  std::unique_ptr<SpectrumAnalyzer> m_spectrumAnalyzer;
+  SpectrumFrame m_spectrumFrame;
+
+  // запись всех серий на диск для просмотра истории старше памяти графика
+  std::unique_ptr<HistoryStore> m_historyStore;
+
+  // запись сессии в файл .pidrec для последующего воспроизведения
+  std::unique_ptr<SessionRecorder> m_sessionRecorder;
+
+  // воспроизведение записи в журнал сырых отсчетов вместо приема по UDP
+  std::unique_ptr<ReplaySource> m_replaySource;
+  bool m_isReplaying;
 
   // фильтры для настройки параметров из GUI
   std::unique_ptr<MovingAverageFilter> m_movingAvgFilter;
@@ -2,7 +2,9 @@
 #define STATUSBARMANAGER_H
 
 #include "../core/datapoint.h"
-#include "../core/threadsaferingbuffer.h"
+#include "../core/ibufferreader.h"
+#include "../core/latency.h"
+#include <QElapsedTimer>
 #include <QObject>
 #include <QString>
 #include <memory>
@@ -58,14 +60,22 @@ public:
   /**
    * @brief установить буферы для расчета памяти фильтров
    */
-  void setFilterBuffers(ThreadSafeRingBuffer<DataPoint> *rawBufferMovingAvg,
-                        ThreadSafeRingBuffer<DataPoint> *movingAvgBuffer,
-                        ThreadSafeRingBuffer<DataPoint> *rawBufferMedian,
-                        ThreadSafeRingBuffer<DataPoint> *medianBuffer,
-                        ThreadSafeRingBuffer<DataPoint> *rawBufferExponential,
-                        ThreadSafeRingBuffer<DataPoint> *exponentialBuffer,
-                        ThreadSafeRingBuffer<DataPoint> *rawBufferKalman,
-                        ThreadSafeRingBuffer<DataPoint> *kalmanBuffer);
+  void setFilterBuffers(IBufferReader<DataPoint> *rawBufferMovingAvg,
+                        IBufferReader<DataPoint> *movingAvgBuffer,
+                        IBufferReader<DataPoint> *rawBufferMedian,
+                        IBufferReader<DataPoint> *medianBuffer,
+                        IBufferReader<DataPoint> *rawBufferExponential,
+                        IBufferReader<DataPoint> *exponentialBuffer,
+                        IBufferReader<DataPoint> *rawBufferKalman,
+                        IBufferReader<DataPoint> *kalmanBuffer);
+
+  /**
+   * @brief задержки конвейера для статусной строки (nullptr - не показывать)
+   *
+   * p50/p99/max по стадиям пересчитываются раз в
+   * LATENCY_REPORT_INTERVAL_MS за прошедший интервал
+   */
+  void setLatency(PipelineLatency *latency);
 
   /**
    * @brief обновить статус
@@ -84,6 +94,11 @@ private:
    */
   void updateStatusBar(bool isRunning);
 
+  /**
+   * @brief пересчитать текст задержек, если прошел интервал
+   */
+  void updateLatencyText();
+
   /**
    * @brief обновить статистику фильтров
    */
@@ -98,6 +113,11 @@ private:
   NetworkController *m_networkController;
   DataProcessor *m_dataProcessor;
 
+  // задержки по стадиям и их последний текст
+  PipelineLatency *m_latency;
+  QString m_latencyText;
+  QElapsedTimer m_latencyTimer;
+
   // ui элементы для статистики фильтров
   QLabel *m_movingAvgStatsLabel;
   QLabel *m_medianStatsLabel;
@@ -116,14 +136,14 @@ private:
   KalmanFilter *m_kalmanFilter;
 
   // буферы для фильтров
-  ThreadSafeRingBuffer<DataPoint> *m_rawBufferMovingAvg;
-  ThreadSafeRingBuffer<DataPoint> *m_movingAvgBuffer;
-  ThreadSafeRingBuffer<DataPoint> *m_rawBufferMedian;
-  ThreadSafeRingBuffer<DataPoint> *m_medianBuffer;
-  ThreadSafeRingBuffer<DataPoint> *m_rawBufferExponential;
-  ThreadSafeRingBuffer<DataPoint> *m_exponentialBuffer;
-  ThreadSafeRingBuffer<DataPoint> *m_rawBufferKalman;
-  ThreadSafeRingBuffer<DataPoint> *m_kalmanBuffer;
+  IBufferReader<DataPoint> *m_rawBufferMovingAvg;
+  IBufferReader<DataPoint> *m_movingAvgBuffer;
+  IBufferReader<DataPoint> *m_rawBufferMedian;
+  IBufferReader<DataPoint> *m_medianBuffer;
+  IBufferReader<DataPoint> *m_rawBufferExponential;
+  IBufferReader<DataPoint> *m_exponentialBuffer;
+  IBufferReader<DataPoint> *m_rawBufferKalman;
+  IBufferReader<DataPoint> *m_kalmanBuffer;
 };
 
 #endif // STATUSBARMANAGER_H
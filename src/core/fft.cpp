@@ -1,9 +1,16 @@
 #include "../../include/core/fft.h"
 #include <algorithm>
 #include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
 
 namespace FFT {
 
+namespace {
+const double PI = 3.14159265358979323846;
+} // namespace
+
 size_t nextPowerOfTwo(size_t n) {
   if (n == 0)
     return 1;
@@ -17,72 +24,149 @@ size_t nextPowerOfTwo(size_t n) {
   return power;
 }
 
-std::vector<std::complex<double>> computeFFT(const std::vector<float> &input) {
-  if (input.empty()) {
-    return {};
+RealFftPlan::RealFftPlan(size_t size) : m_size(size), m_half(size / 2) {
+  if (size < 4 || (size & (size - 1)) != 0) {
+    throw std::invalid_argument("FFT size must be a power of two >= 4");
   }
 
-  // дополняем до степени двойки нулями
-  size_t n = nextPowerOfTwo(input.size());
-  std::vector<std::complex<double>> data(n);
-
-  // копируем данные
-  for (size_t i = 0; i < input.size(); ++i) {
-    data[i] = std::complex<double>(static_cast<double>(input[i]), 0.0);
-  }
-
-  // бит-реверс перестановка
-  for (size_t i = 1, j = 0; i < n; ++i) {
-    size_t bit = n >> 1;
+  // бит-реверс для БПФ половинной длины
+  m_bitReverse.resize(m_half);
+  for (size_t i = 1, j = 0; i < m_half; ++i) {
+    size_t bit = m_half >> 1;
     for (; j & bit; bit >>= 1) {
       j ^= bit;
     }
     j ^= bit;
-    if (i < j) {
-      std::swap(data[i], data[j]);
-    }
+    m_bitReverse[i] = static_cast<uint32_t>(j);
+  }
+  m_bitReverse[0] = 0;
+
+  // каждый множитель считается напрямую, без накопления ошибки
+  // умножением w *= wlen
+  m_twiddles.resize(m_half / 2);
+  for (size_t j = 0; j < m_twiddles.size(); ++j) {
+    double angle = -2.0 * PI * static_cast<double>(j) /
+                   static_cast<double>(m_half);
+    m_twiddles[j] = std::complex<double>(std::cos(angle), std::sin(angle));
+  }
+
+  m_realSplit.resize(m_half / 2 + 1);
+  for (size_t k = 0; k < m_realSplit.size(); ++k) {
+    double angle = -2.0 * PI * static_cast<double>(k) /
+                   static_cast<double>(m_size);
+    m_realSplit[k] = std::complex<double>(std::cos(angle), std::sin(angle));
+  }
+}
+
+void RealFftPlan::forward(const float *input, size_t count,
+                          std::complex<double> *output) const {
+  count = std::min(count, m_size);
+
+  // упаковка пар отсчетов в комплексные числа сразу в порядке бит-реверса
+  for (size_t m = 0; m < m_half; ++m) {
+    size_t even = 2 * m;
+    double re = even < count ? static_cast<double>(input[even]) : 0.0;
+    double im = even + 1 < count ? static_cast<double>(input[even + 1]) : 0.0;
+    output[m_bitReverse[m]] = std::complex<double>(re, im);
   }
 
-  // итеративный алгоритм cooley-tukey fft
-  const double PI = 3.14159265358979323846;
-  for (size_t len = 2; len <= n; len <<= 1) {
-    double angle = -2.0 * PI / static_cast<double>(len);
-    std::complex<double> wlen(std::cos(angle), std::sin(angle));
-
-    for (size_t i = 0; i < n; i += len) {
-      std::complex<double> w(1.0);
-      for (size_t j = 0; j < len / 2; ++j) {
-        std::complex<double> u = data[i + j];
-        std::complex<double> v = data[i + j + len / 2] * w;
-        data[i + j] = u + v;
-        data[i + j + len / 2] = u - v;
-        w *= wlen;
+  // итеративный cooley-tukey длины n/2
+  for (size_t len = 2; len <= m_half; len <<= 1) {
+    const size_t halfLen = len / 2;
+    const size_t step = m_half / len;
+    for (size_t i = 0; i < m_half; i += len) {
+      for (size_t j = 0; j < halfLen; ++j) {
+        std::complex<double> u = output[i + j];
+        std::complex<double> v = output[i + j + halfLen] * m_twiddles[j * step];
+        output[i + j] = u + v;
+        output[i + j + halfLen] = u - v;
       }
     }
   }
 
-  return data;
+  // разделение спектров четных и нечетных отсчетов:
+  // X[k] = (Z[k] + conj(Z[h-k]))/2 - i*W^k*(Z[k] - conj(Z[h-k]))/2
+  const std::complex<double> z0 = output[0];
+  output[0] = std::complex<double>(z0.real() + z0.imag(), 0.0);
+  output[m_half] = std::complex<double>(z0.real() - z0.imag(), 0.0);
+
+  const std::complex<double> minusHalfI(0.0, -0.5);
+  for (size_t k = 1; k <= m_half / 2; ++k) {
+    const size_t mirror = m_half - k;
+    const std::complex<double> zk = output[k];
+    const std::complex<double> zm = output[mirror];
+
+    const std::complex<double> wk = m_realSplit[k];
+    // W^(h-k) = -conj(W^k)
+    const std::complex<double> wm = -std::conj(wk);
+
+    output[k] = 0.5 * (zk + std::conj(zm)) +
+                minusHalfI * wk * (zk - std::conj(zm));
+    if (mirror != k) {
+      output[mirror] = 0.5 * (zm + std::conj(zk)) +
+                       minusHalfI * wm * (zm - std::conj(zk));
+    }
+  }
 }
 
-std::vector<double> computeAmplitudeSpectrum(const std::vector<float> &input) {
-  auto spectrum = computeFFT(input);
-  std::vector<double> amplitudes(spectrum.size());
+std::shared_ptr<const RealFftPlan> getPlan(size_t size) {
+  static std::mutex mutex;
+  static std::map<size_t, std::shared_ptr<const RealFftPlan>> plans;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  auto it = plans.find(size);
+  if (it != plans.end()) {
+    return it->second;
+  }
+  auto plan = std::make_shared<const RealFftPlan>(size);
+  plans.emplace(size, plan);
+  return plan;
+}
 
-  for (size_t i = 0; i < spectrum.size(); ++i) {
+void computeAmplitudes(const std::complex<double> *spectrum, size_t count,
+                       double *amplitudes) {
+  for (size_t i = 0; i < count; ++i) {
     amplitudes[i] = std::abs(spectrum[i]);
   }
+}
 
-  return amplitudes;
+void computeFrequencies(size_t fftSize, double sampleRate,
+                        double *frequencies, size_t count) {
+  double freqStep = sampleRate / static_cast<double>(fftSize);
+  for (size_t i = 0; i < count; ++i) {
+    frequencies[i] = static_cast<double>(i) * freqStep;
+  }
 }
 
-std::vector<double> computeFrequencies(size_t spectrumSize, double sampleRate) {
-  std::vector<double> frequencies(spectrumSize);
-  double freqStep = sampleRate / static_cast<double>(spectrumSize);
+std::vector<std::complex<double>> computeFFT(const std::vector<float> &input) {
+  if (input.empty()) {
+    return {};
+  }
 
-  for (size_t i = 0; i < spectrumSize; ++i) {
-    frequencies[i] = static_cast<double>(i) * freqStep;
+  // дополняем до степени двойки нулями
+  size_t n = std::max<size_t>(4, nextPowerOfTwo(input.size()));
+  std::vector<std::complex<double>> data(n);
+  getPlan(n)->forward(input.data(), input.size(), data.data());
+
+  // вторая половина спектра вещественного сигнала - сопряженная первой
+  for (size_t k = n / 2 + 1; k < n; ++k) {
+    data[k] = std::conj(data[n - k]);
   }
 
+  return data;
+}
+
+std::vector<double> computeAmplitudeSpectrum(const std::vector<float> &input) {
+  auto spectrum = computeFFT(input);
+  std::vector<double> amplitudes(spectrum.size());
+  computeAmplitudes(spectrum.data(), spectrum.size(), amplitudes.data());
+  return amplitudes;
+}
+
+std::vector<double> computeFrequencies(size_t spectrumSize, double sampleRate) {
+  std::vector<double> frequencies(spectrumSize);
+  computeFrequencies(spectrumSize, sampleRate, frequencies.data(),
+                     spectrumSize);
   return frequencies;
 }
 
@@ -0,0 +1,109 @@
+#include "../../include/core/keyvalue.h"
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+// все значение - число
+bool readNumber(const std::string &value, double &result) {
+  char *end = nullptr;
+  errno = 0;
+  result = std::strtod(value.c_str(), &end);
+  return !value.empty() && *end == '\0' && errno == 0;
+}
+} // namespace
+
+namespace KeyValue {
+
+std::string trim(const std::string &text) {
+  const char *spaces = " \t\r\n";
+  size_t first = text.find_first_not_of(spaces);
+  if (first == std::string::npos) {
+    return std::string();
+  }
+  size_t last = text.find_last_not_of(spaces);
+  return text.substr(first, last - first + 1);
+}
+
+void readFile(
+    const std::string &path,
+    const std::function<void(const std::string &key, const std::string &value)>
+        &set) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open " + path);
+  }
+
+  std::string line;
+  size_t number = 0;
+  while (std::getline(file, line)) {
+    ++number;
+    size_t comment = line.find('#');
+    if (comment != std::string::npos) {
+      line.erase(comment);
+    }
+    line = trim(line);
+    if (line.empty()) {
+      continue;
+    }
+
+    const std::string where = path + ":" + std::to_string(number) + ": ";
+    size_t equals = line.find('=');
+    if (equals == std::string::npos) {
+      throw std::runtime_error(where + "expected key = value");
+    }
+    try {
+      set(trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+    } catch (const std::invalid_argument &e) {
+      throw std::runtime_error(where + e.what());
+    }
+  }
+}
+
+double parseNumber(const std::string &key, const std::string &value) {
+  double result = 0.0;
+  if (!readNumber(value, result)) {
+    throw std::invalid_argument(key + ": expected number");
+  }
+  return result;
+}
+
+double parseNumber(const std::string &key, const std::string &value,
+                   double min, double max) {
+  double result = 0.0;
+  if (!readNumber(value, result) || !(result >= min) || !(result <= max)) {
+    throw std::invalid_argument(key + ": expected number in [" +
+                                std::to_string(min) + ", " +
+                                std::to_string(max) + "]");
+  }
+  return result;
+}
+
+unsigned long long parseUnsigned(const std::string &key,
+                                 const std::string &value,
+                                 unsigned long long min,
+                                 unsigned long long max) {
+  char *end = nullptr;
+  errno = 0;
+  unsigned long long result = std::strtoull(value.c_str(), &end, 10);
+  if (value.empty() || value[0] == '-' || *end != '\0' || errno != 0 ||
+      result < min || result > max) {
+    throw std::invalid_argument(key + ": expected integer in [" +
+                                std::to_string(min) + ", " +
+                                std::to_string(max) + "]");
+  }
+  return result;
+}
+
+bool parseBool(const std::string &key, const std::string &value) {
+  if (value == "true" || value == "1" || value == "yes") {
+    return true;
+  }
+  if (value == "false" || value == "0" || value == "no") {
+    return false;
+  }
+  throw std::invalid_argument(key + ": expected true or false");
+}
+
+} // namespace KeyValue
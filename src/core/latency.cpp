@@ -0,0 +1,75 @@
+#include "../../include/core/latency.h"
+#include <algorithm>
+
+LatencyHistogram::LatencyHistogram() : m_max(0) {
+  for (std::atomic<uint64_t> &count : m_counts) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+LatencySummary LatencyHistogram::summarize() const {
+  std::array<uint64_t, BUCKET_COUNT> counts;
+  for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+    counts[i] = m_counts[i].load(std::memory_order_relaxed);
+  }
+  return summarize(counts, m_max.load(std::memory_order_relaxed));
+}
+
+LatencySummary LatencyHistogram::takeInterval() {
+  std::array<uint64_t, BUCKET_COUNT> counts;
+  for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+    counts[i] = m_counts[i].exchange(0, std::memory_order_relaxed);
+  }
+  return summarize(counts, m_max.exchange(0, std::memory_order_relaxed));
+}
+
+void LatencyHistogram::reset() {
+  for (std::atomic<uint64_t> &count : m_counts) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+  if (index < SUB_BUCKET_COUNT) {
+    return index;
+  }
+  const uint64_t shift = index / SUB_BUCKET_HALF - 1;
+  const uint64_t sub = index - shift * SUB_BUCKET_HALF;
+  return ((sub + 1) << shift) - 1;
+}
+
+LatencySummary
+LatencyHistogram::summarize(const std::array<uint64_t, BUCKET_COUNT> &counts,
+                            uint64_t max) {
+  LatencySummary summary;
+  for (uint64_t count : counts) {
+    summary.count += count;
+  }
+  if (summary.count == 0) {
+    return summary;
+  }
+
+  // ранги процентилей, как в HDR: наименьшее значение, не меньше которого
+  // заданная доля отсчетов
+  const auto rank = [&summary](uint64_t percent) {
+    return std::max<uint64_t>(1, (summary.count * percent + 99) / 100);
+  };
+  const uint64_t rank50 = rank(50);
+  const uint64_t rank99 = rank(99);
+  uint64_t seen = 0;
+  bool has50 = false;
+  for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+    seen += counts[i];
+    if (!has50 && seen >= rank50) {
+      summary.p50Us = std::min(bucketUpperBound(i), max) / 1000.0;
+      has50 = true;
+    }
+    if (seen >= rank99) {
+      summary.p99Us = std::min(bucketUpperBound(i), max) / 1000.0;
+      break;
+    }
+  }
+  summary.maxUs = max / 1000.0;
+  return summary;
+}
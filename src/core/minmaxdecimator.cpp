@@ -0,0 +1,63 @@
+#include "../../include/core/minmaxdecimator.h"
+#include <algorithm>
+
+namespace MinMaxDecimator {
+
+namespace {
+/**
+ * @brief отсчет и сводка столбца с ключами double
+ */
+struct Sample {
+  double timestamp;
+  double value;
+};
+
+struct Column {
+  double minKey;
+  double maxKey;
+  double min;
+  double max;
+};
+} // namespace
+
+size_t decimate(const double *keys, const double *values, size_t count,
+                double keyLower, double keyUpper, size_t columns,
+                double *outKeys, double *outValues) {
+  if (count == 0 || columns == 0) {
+    return 0;
+  }
+
+  const size_t begin =
+      static_cast<size_t>(std::lower_bound(keys, keys + count, keyLower) -
+                          keys);
+  const size_t end = static_cast<size_t>(
+      std::upper_bound(keys + begin, keys + count, keyUpper) - keys);
+
+  auto sampleAt = [&](uint64_t index) {
+    return Sample{keys[index], values[index]};
+  };
+  auto lowerBound = [&](double key, uint64_t first, uint64_t last) {
+    return static_cast<uint64_t>(
+        std::lower_bound(keys + first, keys + last, key) - keys);
+  };
+  // внутри столбца - один проход по непрерывному участку
+  auto aggregate = [&](uint64_t first, uint64_t last) {
+    uint64_t minIndex = first;
+    uint64_t maxIndex = first;
+    for (uint64_t i = first + 1; i < last; ++i) {
+      if (values[i] < values[minIndex]) {
+        minIndex = i;
+      }
+      if (values[i] > values[maxIndex]) {
+        maxIndex = i;
+      }
+    }
+    return Column{keys[minIndex], keys[maxIndex], values[minIndex],
+                  values[maxIndex]};
+  };
+
+  return decimateColumns(0, count, begin, end, keyLower, keyUpper, columns,
+                         sampleAt, lowerBound, aggregate, outKeys, outValues);
+}
+
+} // namespace MinMaxDecimator
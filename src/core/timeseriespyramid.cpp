@@ -0,0 +1,287 @@
+#include "../../include/core/timeseriespyramid.h"
+#include "../../include/core/Constants.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+// отсчеты и сводки отрезаются, когда лишних набралось на 1/8 вместимости
+constexpr size_t TRIM_SLACK_DIVISOR = 8;
+// память освобождается, когда отрезанная часть больше половины массива
+template <typename T> void compact(std::vector<T> &items, size_t &begin) {
+  if (begin > 0 && begin >= items.size() / 2) {
+    items.erase(items.begin(),
+                items.begin() + static_cast<std::ptrdiff_t>(begin));
+    begin = 0;
+  }
+}
+} // namespace
+
+constexpr size_t TimeSeriesPyramid::FANOUT;
+constexpr size_t TimeSeriesPyramid::LEVEL_COUNT;
+
+TimeSeriesPyramid::TimeSeriesPyramid(size_t capacity)
+    : m_capacity(capacity), m_samplesBegin(0), m_firstIndex(0), m_dropped(0) {
+  if (m_capacity < FANOUT) {
+    throw std::invalid_argument("Pyramid capacity must be at least FANOUT");
+  }
+}
+
+void TimeSeriesPyramid::append(const DataPoint &point) {
+  if (!empty()) {
+    uint32_t last = m_samples.back().timestamp;
+    if (point.timestamp < last) {
+      if (last - point.timestamp > Constants::RESTART_GAP_MS) {
+        // время источника пошло заново, старая история не продолжается
+        clear();
+      } else {
+        ++m_dropped;
+        return;
+      }
+    }
+  }
+
+  m_samples.push_back(point);
+  completeBuckets();
+  trim();
+}
+
+void TimeSeriesPyramid::append(const DataPoint *points, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    append(points[i]);
+  }
+}
+
+void TimeSeriesPyramid::clear() {
+  m_samples.clear();
+  m_samplesBegin = 0;
+  m_firstIndex = 0;
+  for (Level &level : m_levels) {
+    level.buckets.clear();
+    level.begin = 0;
+    level.firstIndex = 0;
+  }
+}
+
+size_t TimeSeriesPyramid::size() const {
+  return m_samples.size() - m_samplesBegin;
+}
+
+bool TimeSeriesPyramid::empty() const { return size() == 0; }
+
+size_t TimeSeriesPyramid::capacity() const { return m_capacity; }
+
+double TimeSeriesPyramid::keyAt(size_t index) const {
+  return sampleAt(m_firstIndex + index).timestamp;
+}
+
+double TimeSeriesPyramid::lastKey() const { return m_samples.back().timestamp; }
+
+size_t TimeSeriesPyramid::query(double keyLower, double keyUpper,
+                                size_t columns, double *outKeys,
+                                double *outValues) const {
+  if (empty() || columns == 0) {
+    return 0;
+  }
+
+  const uint64_t total = totalCount();
+  const uint64_t begin = lowerBound(keyLower, m_firstIndex, total);
+  const uint64_t end = upperBound(keyUpper, begin, total);
+
+  // границы столбцов те же, что у MinMaxDecimator, но min/max столбца
+  // собираются из готовых сводок, а не из отсчетов
+  return MinMaxDecimator::decimateColumns(
+      m_firstIndex, total, begin, end, keyLower, keyUpper, columns,
+      [this](uint64_t index) { return sampleAt(index); },
+      [this](double key, uint64_t first, uint64_t last) {
+        return lowerBound(key, first, last);
+      },
+      [this](uint64_t first, uint64_t last) {
+        return aggregate(first, last).range;
+      },
+      outKeys, outValues);
+}
+
+TimeSeriesPyramid::Summary
+TimeSeriesPyramid::summarize(double keyLower, double keyUpper) const {
+  Summary summary;
+  if (empty()) {
+    return summary;
+  }
+
+  const uint64_t total = totalCount();
+  const uint64_t begin = lowerBound(keyLower, m_firstIndex, total);
+  const uint64_t end = upperBound(keyUpper, begin, total);
+  if (end <= begin) {
+    return summary;
+  }
+
+  Bucket bucket = aggregate(begin, end);
+  summary.count = bucket.count;
+  summary.min = bucket.range.min;
+  summary.max = bucket.range.max;
+  summary.mean = bucket.sum / static_cast<double>(bucket.count);
+  return summary;
+}
+
+uint64_t TimeSeriesPyramid::getDropped() const { return m_dropped; }
+
+size_t TimeSeriesPyramid::getMemoryUsage() const {
+  size_t bytes = m_samples.capacity() * sizeof(DataPoint);
+  for (const Level &level : m_levels) {
+    bytes += level.buckets.capacity() * sizeof(Bucket);
+  }
+  return bytes;
+}
+
+TimeSeriesPyramid::Bucket
+TimeSeriesPyramid::makeBucket(const DataPoint &point) {
+  Bucket bucket;
+  bucket.range = MinMaxDecimator::makeMinMax(point);
+  bucket.sum = point.value;
+  bucket.count = 1;
+  return bucket;
+}
+
+void TimeSeriesPyramid::merge(Bucket &target, const Bucket &next) {
+  // next идет позже target
+  MinMaxDecimator::merge(target.range, next.range);
+  target.sum += next.sum;
+  target.count += next.count;
+}
+
+uint64_t TimeSeriesPyramid::totalCount() const {
+  return m_firstIndex + size();
+}
+
+const DataPoint &TimeSeriesPyramid::sampleAt(uint64_t index) const {
+  return m_samples[m_samplesBegin + static_cast<size_t>(index - m_firstIndex)];
+}
+
+bool TimeSeriesPyramid::hasBucket(size_t level, uint64_t index) const {
+  const Level &data = m_levels[level];
+  return index >= data.firstIndex &&
+         index - data.firstIndex < data.buckets.size() - data.begin;
+}
+
+const TimeSeriesPyramid::Bucket &
+TimeSeriesPyramid::bucketAt(size_t level, uint64_t index) const {
+  const Level &data = m_levels[level];
+  return data
+      .buckets[data.begin + static_cast<size_t>(index - data.firstIndex)];
+}
+
+uint64_t TimeSeriesPyramid::lowerBound(double key, uint64_t first,
+                                       uint64_t last) const {
+  const DataPoint *base = m_samples.data() + m_samplesBegin;
+  const DataPoint *found = std::lower_bound(
+      base + (first - m_firstIndex), base + (last - m_firstIndex), key,
+      [](const DataPoint &point, double k) { return point.timestamp < k; });
+  return m_firstIndex + static_cast<uint64_t>(found - base);
+}
+
+uint64_t TimeSeriesPyramid::upperBound(double key, uint64_t first,
+                                       uint64_t last) const {
+  const DataPoint *base = m_samples.data() + m_samplesBegin;
+  const DataPoint *found = std::upper_bound(
+      base + (first - m_firstIndex), base + (last - m_firstIndex), key,
+      [](double k, const DataPoint &point) { return k < point.timestamp; });
+  return m_firstIndex + static_cast<uint64_t>(found - base);
+}
+
+TimeSeriesPyramid::Bucket TimeSeriesPyramid::aggregate(uint64_t first,
+                                                       uint64_t last) const {
+  Bucket result = makeBucket(sampleAt(first));
+  uint64_t index = first + 1;
+
+  while (index < last) {
+    // самая крупная готовая сводка, которая начинается с index и не
+    // выходит за last
+    size_t level = 0;
+    uint64_t span = 1;
+    while (level + 1 < LEVEL_COUNT) {
+      uint64_t next = span * FANOUT;
+      if (index % next != 0 || index + next > last ||
+          !hasBucket(level + 1, index / next)) {
+        break;
+      }
+      span = next;
+      ++level;
+    }
+
+    if (level == 0) {
+      merge(result, makeBucket(sampleAt(index)));
+    } else {
+      merge(result, bucketAt(level, index / span));
+    }
+    index += span;
+  }
+
+  return result;
+}
+
+void TimeSeriesPyramid::completeBuckets() {
+  const uint64_t total = totalCount();
+  uint64_t span = 1;
+
+  for (size_t level = 1; level < LEVEL_COUNT; ++level) {
+    span *= FANOUT;
+    if (total % span != 0) {
+      break;
+    }
+
+    // готова сводка уровня level: собираем ее из FANOUT сводок ниже
+    const uint64_t index = total / span - 1;
+    const uint64_t childFirst = index * FANOUT;
+    Bucket bucket = level == 1 ? makeBucket(sampleAt(childFirst))
+                               : bucketAt(level - 1, childFirst);
+    for (uint64_t child = childFirst + 1; child < childFirst + FANOUT;
+         ++child) {
+      merge(bucket, level == 1 ? makeBucket(sampleAt(child))
+                               : bucketAt(level - 1, child));
+    }
+
+    Level &data = m_levels[level];
+    if (data.buckets.size() == data.begin) {
+      data.firstIndex = index;
+    }
+    data.buckets.push_back(bucket);
+  }
+}
+
+void TimeSeriesPyramid::trim() {
+  if (size() <= m_capacity + m_capacity / TRIM_SLACK_DIVISOR) {
+    return;
+  }
+
+  const uint64_t total = totalCount();
+
+  // отсчеты незавершенной сводки первого уровня нужны для ее постройки
+  const uint64_t newFirst =
+      std::min(total - m_capacity, total / FANOUT * FANOUT);
+  m_samplesBegin += static_cast<size_t>(newFirst - m_firstIndex);
+  m_firstIndex = newFirst;
+  compact(m_samples, m_samplesBegin);
+
+  uint64_t span = 1;
+  for (size_t level = 1; level < LEVEL_COUNT; ++level) {
+    span *= FANOUT;
+    Level &data = m_levels[level];
+
+    // сводки, целиком старше первого хранимого отсчета, больше не нужны.
+    // сводки незавершенной группы уровнем выше нужны для ее постройки
+    uint64_t dropUntil = newFirst / span;
+    if (level + 1 < LEVEL_COUNT) {
+      dropUntil = std::min(dropUntil, total / span / FANOUT * FANOUT);
+    }
+    if (dropUntil <= data.firstIndex) {
+      continue;
+    }
+
+    size_t stored = data.buckets.size() - data.begin;
+    size_t drop = static_cast<size_t>(
+        std::min<uint64_t>(dropUntil - data.firstIndex, stored));
+    data.begin += drop;
+    data.firstIndex += drop;
+    compact(data.buckets, data.begin);
+  }
+}
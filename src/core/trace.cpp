@@ -0,0 +1,240 @@
+#include "../../include/core/trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t EVENT_MASK = Trace::EVENTS_PER_THREAD - 1;
+static_assert((Trace::EVENTS_PER_THREAD & EVENT_MASK) == 0,
+              "EVENTS_PER_THREAD must be a power of two");
+
+struct Event {
+  const char *name;
+  uint64_t startNs;
+  uint64_t endNs;
+};
+
+/**
+ * @brief кольцо событий одного потока
+ *
+ * пишет только свой поток: событие в слот, потом head (release).
+ * выгрузка читает слоты до head и после копирования сверяется с head,
+ * как BroadcastRingBuffer с claim-курсором
+ */
+struct ThreadBuffer {
+  std::unique_ptr<Event[]> events;
+  std::atomic<uint64_t> head;      // сколько событий записано
+  std::atomic<uint64_t> clearedAt; // события до этого номера забыты
+  std::atomic<bool> retired;       // поток завершился
+  uint32_t tid;
+  std::string name; // под registryMutex
+  std::string key;  // имя при регистрации, пусто - безымянный поток
+
+  explicit ThreadBuffer(uint32_t id)
+      : events(new Event[Trace::EVENTS_PER_THREAD]), head(0), clearedAt(0),
+        retired(false), tid(id) {}
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+uint32_t nextTid = 1;
+
+/**
+ * @brief буфер и имя текущего потока; при выходе потока буфер
+ * помечается завершенным, но живет до выгрузки или clear()
+ */
+struct ThreadSlot {
+  ThreadBuffer *buffer = nullptr;
+  std::string name;
+
+  ~ThreadSlot() {
+    if (buffer) {
+      buffer->retired.store(true);
+    }
+  }
+};
+
+thread_local ThreadSlot slot;
+
+/**
+ * @brief буфер для нового потока
+ *
+ * потоки, которые пересоздаются (FilterThread при каждом старте),
+ * приходят с тем же именем: такой поток продолжает кольцо завершенного
+ * тезки, в трассе это одна дорожка, а память не растет с каждым
+ * перезапуском
+ */
+ThreadBuffer *registerThread() {
+  std::lock_guard<std::mutex> lock(registryMutex);
+  for (const std::unique_ptr<ThreadBuffer> &buffer : registry) {
+    if (buffer->retired.load() && buffer->key == slot.name) {
+      buffer->retired.store(false);
+      return buffer.get();
+    }
+  }
+
+  registry.push_back(std::make_unique<ThreadBuffer>(nextTid++));
+  ThreadBuffer *buffer = registry.back().get();
+  buffer->key = slot.name;
+  buffer->name = slot.name.empty() ? "thread " + std::to_string(buffer->tid)
+                                   : slot.name;
+  return buffer;
+}
+
+/**
+ * @brief освободить буферы завершившихся потоков (под registryMutex)
+ */
+void dropRetired() {
+  registry.erase(std::remove_if(registry.begin(), registry.end(),
+                                [](const std::unique_ptr<ThreadBuffer> &b) {
+                                  return b->retired.load();
+                                }),
+                 registry.end());
+}
+
+void writeEscaped(std::FILE *file, const char *text) {
+  for (; *text; ++text) {
+    const char c = *text;
+    if (c == '"' || c == '\\') {
+      std::fputc('\\', file);
+      std::fputc(c, file);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      std::fprintf(file, "\\u%04x", static_cast<unsigned>(c));
+    } else {
+      std::fputc(c, file);
+    }
+  }
+}
+
+/**
+ * @brief скопировать целые события буфера (вызывать под registryMutex)
+ */
+void collect(const ThreadBuffer &buffer, std::vector<Event> &out) {
+  const uint64_t head = buffer.head.load(std::memory_order_acquire);
+  uint64_t first = head > Trace::EVENTS_PER_THREAD
+                       ? head - Trace::EVENTS_PER_THREAD
+                       : 0;
+  first = std::max(first, buffer.clearedAt.load(std::memory_order_relaxed));
+
+  const size_t start = out.size();
+  for (uint64_t i = first; i < head; ++i) {
+    out.push_back(buffer.events[i & EVENT_MASK]);
+  }
+
+  // поток мог успеть затереть начало скопированного: слот события с
+  // номером h переписывается, когда пишется событие h + EVENTS_PER_THREAD
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const uint64_t now = buffer.head.load(std::memory_order_relaxed);
+  if (now + 1 > Trace::EVENTS_PER_THREAD) {
+    const uint64_t valid = now + 1 - Trace::EVENTS_PER_THREAD;
+    if (valid > first) {
+      const uint64_t torn = std::min(valid, head) - first;
+      out.erase(out.begin() + static_cast<std::ptrdiff_t>(start),
+                out.begin() + static_cast<std::ptrdiff_t>(start + torn));
+    }
+  }
+}
+
+} // namespace
+
+namespace Trace {
+
+namespace detail {
+
+std::atomic<bool> enabled(false);
+
+void record(const char *name, uint64_t startNs, uint64_t endNs) {
+  ThreadBuffer *buffer = slot.buffer;
+  if (!buffer) {
+    buffer = slot.buffer = registerThread();
+  }
+  const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  buffer->events[head & EVENT_MASK] = {name, startNs, endNs};
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+} // namespace detail
+
+void setEnabled(bool enabled) { detail::enabled.store(enabled); }
+
+void setThreadName(const std::string &name) {
+  slot.name = name;
+  if (slot.buffer) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    slot.buffer->name = name;
+  }
+}
+
+void clear() {
+  std::lock_guard<std::mutex> lock(registryMutex);
+  dropRetired();
+  for (const std::unique_ptr<ThreadBuffer> &buffer : registry) {
+    buffer->clearedAt.store(buffer->head.load(std::memory_order_acquire));
+  }
+}
+
+size_t eventCount() {
+  std::lock_guard<std::mutex> lock(registryMutex);
+  size_t count = 0;
+  for (const std::unique_ptr<ThreadBuffer> &buffer : registry) {
+    const uint64_t head = buffer->head.load(std::memory_order_acquire);
+    const uint64_t first =
+        std::max(head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0,
+                 buffer->clearedAt.load(std::memory_order_relaxed));
+    count += static_cast<size_t>(head > first ? head - first : 0);
+  }
+  return count;
+}
+
+bool writeChromeJson(const std::string &path) {
+  std::FILE *file = std::fopen(path.c_str(), "w");
+  if (!file) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(registryMutex);
+  std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  bool firstRecord = true;
+  const auto separator = [&] {
+    if (!firstRecord) {
+      std::fprintf(file, ",\n");
+    }
+    firstRecord = false;
+  };
+
+  std::vector<Event> events;
+  for (const std::unique_ptr<ThreadBuffer> &buffer : registry) {
+    separator();
+    std::fprintf(file,
+                 "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                 "\"tid\":%u,\"args\":{\"name\":\"",
+                 buffer->tid);
+    writeEscaped(file, buffer->name.c_str());
+    std::fprintf(file, "\"}}");
+
+    events.clear();
+    collect(*buffer, events);
+    for (const Event &event : events) {
+      separator();
+      std::fprintf(file, "{\"name\":\"");
+      writeEscaped(file, event.name);
+      // время в мкс, как ждет формат, с точностью до нс
+      std::fprintf(file,
+                   "\",\"cat\":\"pipeline\",\"ph\":\"X\",\"pid\":1,"
+                   "\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                   buffer->tid, event.startNs / 1000.0,
+                   (event.endNs - event.startNs) / 1000.0);
+    }
+  }
+  std::fprintf(file, "\n]}\n");
+  // события завершившихся потоков выгружены, буферы больше не нужны
+  dropRetired();
+
+  const bool ok = std::ferror(file) == 0;
+  return std::fclose(file) == 0 && ok;
+}
+
+} // namespace Trace
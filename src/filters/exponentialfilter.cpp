@@ -6,42 +6,60 @@
  */
 
 ExponentialFilter::ExponentialFilter(double alpha)
-    : FilterBase("Exponential"),
-      m_alpha(Constants::Filters::DEFAULT_EXPONENTIAL_ALPHA),
-      m_prevOutput(0.0f) {
+    : FilterBase("Exponential"), m_alpha(clampAlpha(alpha)),
+      m_resetRequested(false), m_prevOutput(0.0f) {}
+
+double ExponentialFilter::clampAlpha(double alpha) {
   if (alpha < Constants::Filters::MIN_EXPONENTIAL_ALPHA) {
-    m_alpha = Constants::Filters::MIN_EXPONENTIAL_ALPHA;
-  } else if (alpha > Constants::Filters::MAX_EXPONENTIAL_ALPHA) {
-    m_alpha = Constants::Filters::MAX_EXPONENTIAL_ALPHA;
-  } else {
-    m_alpha = alpha;
+    return Constants::Filters::MIN_EXPONENTIAL_ALPHA;
+  }
+  if (alpha > Constants::Filters::MAX_EXPONENTIAL_ALPHA) {
+    return Constants::Filters::MAX_EXPONENTIAL_ALPHA;
+  }
+  return alpha;
+}
+
+void ExponentialFilter::applyPendingSettings() {
+  // сброс применяем здесь, в потоке фильтра
+  if (m_resetRequested.exchange(false, std::memory_order_relaxed)) {
+    m_prevOutput = 0.0f;
   }
 }
 
 DataPoint ExponentialFilter::filter(const DataPoint &input) {
-  float out = static_cast<float>(m_alpha * input.value +
-                                 (1.0 - m_alpha) * m_prevOutput);
+  applyPendingSettings();
+  const double alpha = m_alpha.load(std::memory_order_relaxed);
+  float out = static_cast<float>(alpha * input.value +
+                                 (1.0 - alpha) * m_prevOutput);
   m_prevOutput = out;
   return DataPoint(input.timestamp, out);
 }
 
-void ExponentialFilter::reset() { m_prevOutput = 0.0f; }
+size_t ExponentialFilter::processBlock(const DataPoint *input, size_t count,
+                                       DataPoint *output) {
+  applyPendingSettings();
+  const double alpha = m_alpha.load(std::memory_order_relaxed);
+  const double beta = 1.0 - alpha;
+  float prev = m_prevOutput;
+  for (size_t i = 0; i < count; ++i) {
+    prev = static_cast<float>(alpha * input[i].value + beta * prev);
+    output[i] = DataPoint(input[i].timestamp, prev);
+  }
+  m_prevOutput = prev;
+  return count;
+}
+
+void ExponentialFilter::reset() { m_resetRequested.store(true); }
 
 bool ExponentialFilter::isReady() const { return true; }
 
 void ExponentialFilter::setAlpha(double alpha) {
-  if (alpha < Constants::Filters::MIN_EXPONENTIAL_ALPHA) {
-    m_alpha = Constants::Filters::MIN_EXPONENTIAL_ALPHA;
-  } else if (alpha > Constants::Filters::MAX_EXPONENTIAL_ALPHA) {
-    m_alpha = Constants::Filters::MAX_EXPONENTIAL_ALPHA;
-  } else {
-    m_alpha = alpha;
-  }
-  m_prevOutput = 0.0f;
+  m_alpha.store(clampAlpha(alpha));
+  m_resetRequested.store(true);
 }
 
-double ExponentialFilter::getAlpha() const { return m_alpha; }
+double ExponentialFilter::getAlpha() const { return m_alpha.load(); }
 
 size_t ExponentialFilter::getMemoryUsage() const {
-  return sizeof(m_alpha) + sizeof(m_prevOutput);
+  return sizeof(m_alpha) + sizeof(m_resetRequested) + sizeof(m_prevOutput);
 }
@@ -4,3 +4,15 @@
 FilterBase::FilterBase(const std::string &name) : m_name(name) {}
 
 std::string FilterBase::getName() const { return m_name; }
+
+size_t FilterBase::processBlock(const DataPoint *input, size_t count,
+                                DataPoint *output) {
+  size_t produced = 0;
+  for (size_t i = 0; i < count; ++i) {
+    DataPoint filtered = filter(input[i]);
+    if (isReady()) {
+      output[produced++] = filtered;
+    }
+  }
+  return produced;
+}
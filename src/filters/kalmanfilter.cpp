@@ -3,19 +3,36 @@
 #include <algorithm>
 
 KalmanFilter::KalmanFilter(double q, double r, double p)
-    : FilterBase("Kalman"), m_q(q), m_r(r), m_p(p), m_x(0.0f), m_v(0.0f),
+    : FilterBase("Kalman"),
+      m_q(q > 0.0 ? q : Constants::Filters::DEFAULT_KALMAN_Q),
+      m_r(r > 0.0 ? r : Constants::Filters::DEFAULT_KALMAN_R),
+      m_initialP(p > 0.0 ? p : Constants::Filters::DEFAULT_KALMAN_P),
+      m_resetRequested(false), m_p(m_initialP.load()), m_x(0.0f), m_v(0.0f),
       m_a(0.0f), m_prevX(0.0f), m_prevV(0.0f), m_prevTimestamp(0),
-      m_initialized(false) {
-  // валидация параметров
-  if (m_q <= 0.0)
-    m_q = Constants::Filters::DEFAULT_KALMAN_Q;
-  if (m_r <= 0.0)
-    m_r = Constants::Filters::DEFAULT_KALMAN_R;
-  if (m_p <= 0.0)
-    m_p = Constants::Filters::DEFAULT_KALMAN_P;
+      m_initialized(false) {}
+
+void KalmanFilter::applyPendingSettings() {
+  // сброс применяем здесь, в потоке фильтра
+  if (!m_resetRequested.exchange(false, std::memory_order_relaxed)) {
+    return;
+  }
+  m_x = 0.0f;
+  m_v = 0.0f;
+  m_a = 0.0f;
+  m_prevX = 0.0f;
+  m_prevV = 0.0f;
+  m_prevTimestamp = 0;
+  m_p = m_initialP.load(std::memory_order_relaxed);
+  m_initialized = false;
 }
 
 DataPoint KalmanFilter::filter(const DataPoint &input) {
+  applyPendingSettings();
+  return step(input, m_q.load(std::memory_order_relaxed),
+              m_r.load(std::memory_order_relaxed));
+}
+
+DataPoint KalmanFilter::step(const DataPoint &input, double q, double r) {
   if (!m_initialized) {
     m_x = input.value;
     m_v = 0.0f;
@@ -44,9 +61,9 @@ DataPoint KalmanFilter::filter(const DataPoint &input) {
   double x_pred = static_cast<double>(m_x) + static_cast<double>(m_v) * dt_sec +
                   0.5 * static_cast<double>(m_a) * dt_sec * dt_sec;
 
-  double p_pred = m_p + m_q * dt_sec;
+  double p_pred = m_p + q * dt_sec;
 
-  double k = p_pred / (p_pred + m_r);
+  double k = p_pred / (p_pred + r);
 
   double measurement = static_cast<double>(input.value);
   double x_new = x_pred + k * (measurement - x_pred);
@@ -62,61 +79,67 @@ DataPoint KalmanFilter::filter(const DataPoint &input) {
   return DataPoint(input.timestamp, m_x);
 }
 
-void KalmanFilter::reset() {
-  m_x = 0.0f;
-  m_v = 0.0f;
-  m_a = 0.0f;
-  m_prevX = 0.0f;
-  m_prevV = 0.0f;
-  m_prevTimestamp = 0;
-  m_p = Constants::Filters::DEFAULT_KALMAN_P;
-  m_initialized = false;
+size_t KalmanFilter::processBlock(const DataPoint *input, size_t count,
+                                  DataPoint *output) {
+  // параметры читаем один раз на блок. после первой точки фильтр всегда
+  // готов, так что выход есть на каждую точку
+  applyPendingSettings();
+  const double q = m_q.load(std::memory_order_relaxed);
+  const double r = m_r.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < count; ++i) {
+    output[i] = step(input[i], q, r);
+  }
+  return count;
 }
 
-bool KalmanFilter::isReady() const { return m_initialized; }
+void KalmanFilter::reset() { m_resetRequested.store(true); }
+
+bool KalmanFilter::isReady() const {
+  return !m_resetRequested.load(std::memory_order_relaxed) && m_initialized;
+}
 
 void KalmanFilter::setQ(double q) {
   if (q > 0.0) {
-    m_q = q;
+    m_q.store(q);
     reset();
   }
 }
 
-double KalmanFilter::getQ() const { return m_q; }
+double KalmanFilter::getQ() const { return m_q.load(); }
 
 void KalmanFilter::setR(double r) {
   if (r > 0.0) {
-    m_r = r;
+    m_r.store(r);
     reset();
   }
 }
 
-double KalmanFilter::getR() const { return m_r; }
+double KalmanFilter::getR() const { return m_r.load(); }
 
 void KalmanFilter::setP(double p) {
   if (p > 0.0) {
-    m_p = p;
+    m_initialP.store(p);
     reset();
   }
 }
 
-double KalmanFilter::getP() const { return m_p; }
+double KalmanFilter::getP() const { return m_initialP.load(); }
 
 void KalmanFilter::setParameters(double q, double r, double p) {
   bool needReset = false;
 
-  if (q > 0.0 && q != m_q) {
-    m_q = q;
+  if (q > 0.0 && q != m_q.load()) {
+    m_q.store(q);
     needReset = true;
   }
 
-  if (r > 0.0 && r != m_r) {
-    m_r = r;
+  if (r > 0.0 && r != m_r.load()) {
+    m_r.store(r);
     needReset = true;
   }
 
-  if (p > 0.0 && p != m_p) {
-    m_p = p;
+  if (p > 0.0 && p != m_initialP.load()) {
+    m_initialP.store(p);
     needReset = true;
   }
 
@@ -126,7 +149,8 @@ void KalmanFilter::setParameters(double q, double r, double p) {
 }
 
 size_t KalmanFilter::getMemoryUsage() const {
-  return sizeof(m_q) + sizeof(m_r) + sizeof(m_p) + sizeof(m_x) + sizeof(m_v) +
+  return sizeof(m_q) + sizeof(m_r) + sizeof(m_initialP) +
+         sizeof(m_resetRequested) + sizeof(m_p) + sizeof(m_x) + sizeof(m_v) +
          sizeof(m_a) + sizeof(m_prevX) + sizeof(m_prevV) +
          sizeof(m_prevTimestamp) + sizeof(m_initialized);
 }
@@ -1,73 +1,76 @@
 #include "../../include/filters/medianfilter.h"
 #include "../../include/core/Constants.h"
-#include <algorithm>
-#include <vector>
 
 /*
  * медианный фильтр. в каждом шаге окна из последних N значений (N нечётное).
  */
 
 MedianFilter::MedianFilter(size_t windowSize)
-    : FilterBase("Median"), m_windowSize(5), m_window() {
+    : FilterBase("Median"), m_windowSize(clampWindowSize(windowSize)),
+      m_resetRequested(false), m_window(m_windowSize.load()) {}
+
+size_t MedianFilter::clampWindowSize(size_t windowSize) {
+  size_t result = windowSize;
   if (windowSize < Constants::Filters::MIN_MEDIAN_WINDOW) {
-    m_windowSize =
-        Constants::Filters::MIN_MEDIAN_WINDOW; // если мало, то минимальное
+    // если мало, то минимальное
+    result = Constants::Filters::MIN_MEDIAN_WINDOW;
   } else if (windowSize > Constants::Filters::MAX_MEDIAN_WINDOW) {
-    m_windowSize =
-        Constants::Filters::MAX_MEDIAN_WINDOW; // если много, то максимальное
-  } else {
-    m_windowSize = windowSize; // если в пределах, то используем
+    // если много, то максимальное
+    result = Constants::Filters::MAX_MEDIAN_WINDOW;
   }
-  if (m_windowSize % 2 == 0) { // если четное, то уменьшаем на 1
-    m_windowSize--;            // чтобы было нечетное
+  if (result % 2 == 0) { // если четное, то уменьшаем на 1
+    result--;            // чтобы было нечетное
   }
+  return result;
 }
 
-DataPoint MedianFilter::filter(const DataPoint &input) {
-  m_window.push_back(input.value);
-
-  while (m_window.size() > m_windowSize) {
-    m_window.pop_front();
+void MedianFilter::applyPendingSettings() {
+  // новый размер окна и сброс применяем здесь, в потоке фильтра
+  bool resetRequested =
+      m_resetRequested.exchange(false, std::memory_order_relaxed);
+  size_t windowSize = m_windowSize.load(std::memory_order_relaxed);
+  if (windowSize != m_window.capacity()) {
+    m_window.setCapacity(windowSize);
+  } else if (resetRequested) {
+    m_window.clear();
   }
-
-  float median = computeMedian();
-  return DataPoint(input.timestamp, median);
 }
 
-void MedianFilter::reset() { m_window.clear(); }
+DataPoint MedianFilter::filter(const DataPoint &input) {
+  applyPendingSettings();
+  m_window.push(input.value);
+  return DataPoint(input.timestamp, m_window.median());
+}
 
-bool MedianFilter::isReady() const { return m_window.size() >= m_windowSize; }
+size_t MedianFilter::processBlock(const DataPoint *input, size_t count,
+                                  DataPoint *output) {
+  // настройки проверяем один раз на блок, а не на каждую точку
+  applyPendingSettings();
+  const size_t windowSize = m_window.capacity();
 
-void MedianFilter::setWindowSize(size_t windowSize) {
-  if (windowSize < Constants::Filters::MIN_MEDIAN_WINDOW) {
-    m_windowSize = Constants::Filters::MIN_MEDIAN_WINDOW;
-  } else if (windowSize > Constants::Filters::MAX_MEDIAN_WINDOW) {
-    m_windowSize = Constants::Filters::MAX_MEDIAN_WINDOW;
-  } else {
-    m_windowSize = windowSize;
-  }
-  if (m_windowSize % 2 == 0) {
-    m_windowSize--;
+  size_t produced = 0;
+  for (size_t i = 0; i < count; ++i) {
+    m_window.push(input[i].value);
+    if (m_window.size() >= windowSize) {
+      output[produced++] = DataPoint(input[i].timestamp, m_window.median());
+    }
   }
-  m_window.clear();
+  return produced;
 }
 
-size_t MedianFilter::getWindowSize() const { return m_windowSize; }
+void MedianFilter::reset() { m_resetRequested.store(true); }
 
-size_t MedianFilter::getMemoryUsage() const {
-  return m_window.size() * sizeof(float) + sizeof(m_windowSize) +
-         sizeof(m_window);
+bool MedianFilter::isReady() const {
+  return !m_resetRequested.load(std::memory_order_relaxed) &&
+         m_window.size() >= m_windowSize.load(std::memory_order_relaxed);
 }
 
-float MedianFilter::computeMedian() const {
-  if (m_window.empty()) {
-    return 0.0f;
-  }
+void MedianFilter::setWindowSize(size_t windowSize) {
+  m_windowSize.store(clampWindowSize(windowSize));
+}
 
-  std::vector<float> copy(m_window.begin(), m_window.end());
-  size_t mid = (copy.size() - 1) / 2;
+size_t MedianFilter::getWindowSize() const { return m_windowSize.load(); }
 
-  std::nth_element(copy.begin(),
-                   copy.begin() + static_cast<std::ptrdiff_t>(mid), copy.end());
-  return copy[mid];
+size_t MedianFilter::getMemoryUsage() const {
+  return m_window.getMemoryUsage() + sizeof(m_windowSize);
 }
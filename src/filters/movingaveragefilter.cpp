@@ -1,58 +1,69 @@
 #include "../../include/filters/movingaveragefilter.h"
 #include "../../include/core/Constants.h"
-#include <algorithm>
-#include <numeric>
 
 MovingAverageFilter::MovingAverageFilter(size_t windowSize)
-    : FilterBase("MovingAverage"), m_windowSize(windowSize), m_window() {
+    : FilterBase("MovingAverage"), m_windowSize(clampWindowSize(windowSize)),
+      m_resetRequested(false), m_window(m_windowSize.load()) {}
+
+size_t MovingAverageFilter::clampWindowSize(size_t windowSize) {
   if (windowSize < Constants::Filters::MIN_MOVING_AVERAGE_WINDOW) {
-    m_windowSize = Constants::Filters::MIN_MOVING_AVERAGE_WINDOW;
-  } else if (windowSize > Constants::Filters::MAX_MOVING_AVERAGE_WINDOW) {
-    m_windowSize = Constants::Filters::MAX_MOVING_AVERAGE_WINDOW;
+    return Constants::Filters::MIN_MOVING_AVERAGE_WINDOW;
+  }
+  if (windowSize > Constants::Filters::MAX_MOVING_AVERAGE_WINDOW) {
+    return Constants::Filters::MAX_MOVING_AVERAGE_WINDOW;
+  }
+  return windowSize;
+}
+
+void MovingAverageFilter::applyPendingSettings() {
+  // новый размер окна и сброс применяем здесь, в потоке фильтра
+  bool resetRequested =
+      m_resetRequested.exchange(false, std::memory_order_relaxed);
+  size_t windowSize = m_windowSize.load(std::memory_order_relaxed);
+  if (windowSize != m_window.capacity()) {
+    m_window.setCapacity(windowSize);
+  } else if (resetRequested) {
+    m_window.clear();
   }
 }
 
 DataPoint MovingAverageFilter::filter(const DataPoint &input) {
-  m_window.push_back(input.value);
+  applyPendingSettings();
+  m_window.push(input.value);
+  return DataPoint(input.timestamp, m_window.mean());
+}
 
-  while (m_window.size() > m_windowSize) {
-    m_window.pop_front();
-  }
+size_t MovingAverageFilter::processBlock(const DataPoint *input,
+                                         size_t count, DataPoint *output) {
+  applyPendingSettings();
+  const size_t windowSize = m_window.capacity();
 
-  float average = calculateAverage();
-  return DataPoint(input.timestamp, average);
+  size_t produced = 0;
+  for (size_t i = 0; i < count; ++i) {
+    m_window.push(input[i].value);
+    if (m_window.size() >= windowSize) {
+      output[produced++] = DataPoint(input[i].timestamp, m_window.mean());
+    }
+  }
+  return produced;
 }
 
-void MovingAverageFilter::reset() { m_window.clear(); }
+void MovingAverageFilter::reset() { m_resetRequested.store(true); }
 
 bool MovingAverageFilter::isReady() const {
-  return m_window.size() >= m_windowSize;
+  return !m_resetRequested.load(std::memory_order_relaxed) &&
+         m_window.size() >= m_windowSize.load(std::memory_order_relaxed);
 }
 
 void MovingAverageFilter::setWindowSize(size_t windowSize) {
-  if (windowSize < Constants::Filters::MIN_MOVING_AVERAGE_WINDOW) {
-    m_windowSize = Constants::Filters::MIN_MOVING_AVERAGE_WINDOW;
-  } else if (windowSize > Constants::Filters::MAX_MOVING_AVERAGE_WINDOW) {
-    m_windowSize = Constants::Filters::MAX_MOVING_AVERAGE_WINDOW;
-  } else {
-    m_windowSize = windowSize;
-  }
-
-  m_window.clear();
+  m_windowSize.store(clampWindowSize(windowSize));
 }
 
-size_t MovingAverageFilter::getWindowSize() const { return m_windowSize; }
-
-size_t MovingAverageFilter::getMemoryUsage() const {
-  return m_window.size() * sizeof(float) + sizeof(m_windowSize) +
-         sizeof(m_window);
+size_t MovingAverageFilter::getWindowSize() const {
+  return m_windowSize.load();
 }
 
-float MovingAverageFilter::calculateAverage() const {
-  if (m_window.empty()) {
-    return 0.0f;
-  }
-
-  float sum = std::accumulate(m_window.begin(), m_window.end(), 0.0f);
-  return sum / static_cast<float>(m_window.size());
+size_t MovingAverageFilter::getMemoryUsage() const {
+  return m_window.getMemoryUsage() + sizeof(m_windowSize) +
+         sizeof(m_resetRequested);
 }
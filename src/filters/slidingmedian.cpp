@@ -0,0 +1,187 @@
+#include "../../include/filters/slidingmedian.h"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+/*
+ * индексируемый skiplist по схеме Реймонда Хеттингера: ширина ссылки -
+ * на сколько позиций уровня 0 она переходит, k-й элемент находится
+ * спуском сверху с вычитанием ширин.
+ */
+
+SlidingMedian::SlidingMedian(size_t capacity)
+    : m_capacity(0), m_levels(1), m_fifoStart(0), m_size(0),
+      m_random(0x9E3779B9u) {
+  setCapacity(capacity);
+}
+
+void SlidingMedian::setCapacity(size_t capacity) {
+  if (capacity == 0) {
+    throw std::invalid_argument("Window size must be greater than 0");
+  }
+
+  m_capacity = capacity;
+  m_levels = 1;
+  while ((static_cast<size_t>(1) << m_levels) < capacity) {
+    ++m_levels;
+  }
+
+  const size_t nodes = capacity + FIRST_NODE;
+  m_values.assign(nodes, 0.0f);
+  m_heights.assign(nodes, 0);
+  m_next.assign(nodes * m_levels, NIL);
+  m_width.assign(nodes * m_levels, 0);
+  m_freeNodes.reserve(capacity);
+  m_fifo.assign(capacity, 0.0f);
+
+  clear();
+}
+
+size_t SlidingMedian::capacity() const { return m_capacity; }
+
+size_t SlidingMedian::size() const { return m_size; }
+
+void SlidingMedian::push(float value) {
+  // NaN не упорядочивается, в окно его не берем
+  if (std::isnan(value)) {
+    return;
+  }
+
+  if (m_size == m_capacity) {
+    remove(m_fifo[m_fifoStart]);
+    m_fifo[m_fifoStart] = value;
+    m_fifoStart = (m_fifoStart + 1) % m_capacity;
+  } else {
+    m_fifo[(m_fifoStart + m_size) % m_capacity] = value;
+  }
+  insert(value);
+}
+
+float SlidingMedian::median() const {
+  if (m_size == 0) {
+    return 0.0f;
+  }
+  return at((m_size - 1) / 2);
+}
+
+float SlidingMedian::at(size_t k) const {
+  uint32_t node = HEAD;
+  size_t remaining = k + 1;
+  for (size_t level = m_levels; level-- > 0;) {
+    while (width(node, level) <= remaining) {
+      remaining -= width(node, level);
+      node = next(node, level);
+    }
+  }
+  return m_values[node];
+}
+
+void SlidingMedian::clear() {
+  m_values[NIL] = std::numeric_limits<float>::infinity();
+  for (size_t level = 0; level < m_levels; ++level) {
+    next(HEAD, level) = NIL;
+    width(HEAD, level) = 1;
+    next(NIL, level) = NIL;
+    width(NIL, level) = 0;
+  }
+
+  m_freeNodes.clear();
+  for (size_t i = m_capacity + FIRST_NODE; i-- > FIRST_NODE;) {
+    m_freeNodes.push_back(static_cast<uint32_t>(i));
+  }
+
+  m_fifoStart = 0;
+  m_size = 0;
+}
+
+size_t SlidingMedian::getMemoryUsage() const {
+  return sizeof(*this) + m_values.capacity() * sizeof(float) +
+         m_heights.capacity() * sizeof(uint8_t) +
+         m_next.capacity() * sizeof(uint32_t) +
+         m_width.capacity() * sizeof(uint32_t) +
+         m_freeNodes.capacity() * sizeof(uint32_t) +
+         m_fifo.capacity() * sizeof(float);
+}
+
+size_t SlidingMedian::randomLevel() {
+  // xorshift32, каждый следующий уровень с вероятностью 1/2
+  m_random ^= m_random << 13;
+  m_random ^= m_random >> 17;
+  m_random ^= m_random << 5;
+
+  size_t level = 1;
+  uint32_t bits = m_random;
+  while (level < m_levels && (bits & 1u)) {
+    ++level;
+    bits >>= 1;
+  }
+  return level;
+}
+
+void SlidingMedian::insert(float value) {
+  // для каждого уровня - последний узел левее места вставки и пройденный путь
+  uint32_t chain[32];
+  size_t steps[32];
+
+  uint32_t node = HEAD;
+  for (size_t level = m_levels; level-- > 0;) {
+    steps[level] = 0;
+    while (next(node, level) != NIL && m_values[next(node, level)] <= value) {
+      steps[level] += width(node, level);
+      node = next(node, level);
+    }
+    chain[level] = node;
+  }
+
+  const uint32_t created = m_freeNodes.back();
+  m_freeNodes.pop_back();
+  const size_t height = randomLevel();
+  m_values[created] = value;
+  m_heights[created] = static_cast<uint8_t>(height);
+
+  size_t passed = 0;
+  for (size_t level = 0; level < height; ++level) {
+    uint32_t prev = chain[level];
+    next(created, level) = next(prev, level);
+    next(prev, level) = created;
+    width(created, level) =
+        width(prev, level) - static_cast<uint32_t>(passed);
+    width(prev, level) = static_cast<uint32_t>(passed + 1);
+    passed += steps[level];
+  }
+  for (size_t level = height; level < m_levels; ++level) {
+    width(chain[level], level) += 1;
+  }
+
+  ++m_size;
+}
+
+void SlidingMedian::remove(float value) {
+  uint32_t chain[32];
+
+  uint32_t node = HEAD;
+  for (size_t level = m_levels; level-- > 0;) {
+    while (next(node, level) != NIL && m_values[next(node, level)] < value) {
+      node = next(node, level);
+    }
+    chain[level] = node;
+  }
+
+  const uint32_t removed = next(chain[0], 0);
+  if (removed == NIL || m_values[removed] != value) {
+    return; // такого значения в окне нет
+  }
+
+  const size_t height = m_heights[removed];
+  for (size_t level = 0; level < height; ++level) {
+    uint32_t prev = chain[level];
+    width(prev, level) += width(removed, level) - 1;
+    next(prev, level) = next(removed, level);
+  }
+  for (size_t level = height; level < m_levels; ++level) {
+    width(chain[level], level) -= 1;
+  }
+
+  m_freeNodes.push_back(removed);
+  --m_size;
+}
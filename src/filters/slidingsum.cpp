@@ -0,0 +1,109 @@
+#include "../../include/filters/slidingsum.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+SlidingSum::SlidingSum(size_t capacity)
+    : m_start(0), m_size(0), m_sum(0.0), m_compensation(0.0), m_nonFinite(0),
+      m_sinceResync(0) {
+  setCapacity(capacity);
+}
+
+void SlidingSum::setCapacity(size_t capacity) {
+  if (capacity == 0) {
+    throw std::invalid_argument("Window size must be greater than 0");
+  }
+  m_ring.assign(capacity, 0.0f);
+  clear();
+}
+
+size_t SlidingSum::capacity() const { return m_ring.size(); }
+
+size_t SlidingSum::size() const { return m_size; }
+
+void SlidingSum::push(float value) {
+  const size_t capacity = m_ring.size();
+
+  if (m_size == capacity) {
+    float evicted = m_ring[m_start];
+    if (std::isfinite(evicted)) {
+      add(-static_cast<double>(evicted));
+    } else {
+      --m_nonFinite;
+    }
+    m_ring[m_start] = value;
+    m_start = (m_start + 1 == capacity) ? 0 : m_start + 1;
+  } else {
+    size_t index = m_start + m_size;
+    if (index >= capacity) {
+      index -= capacity;
+    }
+    m_ring[index] = value;
+    ++m_size;
+  }
+
+  if (std::isfinite(value)) {
+    add(static_cast<double>(value));
+  } else {
+    ++m_nonFinite;
+  }
+
+  if (++m_sinceResync >= std::max(RESYNC_INTERVAL, capacity)) {
+    resync();
+  }
+}
+
+double SlidingSum::sum() const {
+  if (m_nonFinite > 0) {
+    // NaN/inf в окне: результат такой же, как у прямого суммирования
+    double exact = 0.0;
+    for (size_t i = 0; i < m_size; ++i) {
+      exact += m_ring[(m_start + i) % m_ring.size()];
+    }
+    return exact;
+  }
+  return m_sum + m_compensation;
+}
+
+float SlidingSum::mean() const {
+  if (m_size == 0) {
+    return 0.0f;
+  }
+  return static_cast<float>(sum() / static_cast<double>(m_size));
+}
+
+void SlidingSum::clear() {
+  m_start = 0;
+  m_size = 0;
+  m_sum = 0.0;
+  m_compensation = 0.0;
+  m_nonFinite = 0;
+  m_sinceResync = 0;
+}
+
+size_t SlidingSum::getMemoryUsage() const {
+  return sizeof(*this) + m_ring.capacity() * sizeof(float);
+}
+
+void SlidingSum::add(double value) {
+  // суммирование Неймайера: теряемые младшие разряды копятся отдельно
+  double total = m_sum + value;
+  if (std::fabs(m_sum) >= std::fabs(value)) {
+    m_compensation += (m_sum - total) + value;
+  } else {
+    m_compensation += (value - total) + m_sum;
+  }
+  m_sum = total;
+}
+
+void SlidingSum::resync() {
+  m_sum = 0.0;
+  m_compensation = 0.0;
+  for (size_t i = 0; i < m_size; ++i) {
+    float value = m_ring[(m_start + i) % m_ring.size()];
+    if (std::isfinite(value)) {
+      add(static_cast<double>(value));
+    }
+  }
+  m_sinceResync = 0;
+}
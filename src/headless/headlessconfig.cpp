@@ -0,0 +1,77 @@
+#include "../../include/headless/headlessconfig.h"
+#include "../../include/core/keyvalue.h"
+#include <stdexcept>
+
+HeadlessConfig HeadlessConfig::load(const std::string &path) {
+  HeadlessConfig config;
+  KeyValue::readFile(path,
+                     [&config](const std::string &key,
+                               const std::string &value) {
+                       config.set(key, value);
+                     });
+  return config;
+}
+
+void HeadlessConfig::set(const std::string &key, const std::string &value) {
+  using namespace Constants;
+  using namespace KeyValue;
+
+  if (key == "receive_ip") {
+    receiveIp = value;
+  } else if (key == "receive_port") {
+    receivePort = static_cast<uint16_t>(parseUnsigned(key, value, 1, 65535));
+  } else if (key == "reorder_window_ms") {
+    reorderWindowMs = static_cast<uint32_t>(
+        parseUnsigned(key, value, 0, Network::MAX_REORDER_WINDOW_MS));
+  } else if (key == "filters") {
+    movingAverage = median = exponential = kalman = false;
+    size_t begin = 0;
+    while (begin <= value.size()) {
+      size_t comma = value.find(',', begin);
+      if (comma == std::string::npos) {
+        comma = value.size();
+      }
+      const std::string name = trim(value.substr(begin, comma - begin));
+      if (name == "moving_average") {
+        movingAverage = true;
+      } else if (name == "median") {
+        median = true;
+      } else if (name == "exponential") {
+        exponential = true;
+      } else if (name == "kalman") {
+        kalman = true;
+      } else if (name != "none" && !name.empty()) {
+        throw std::invalid_argument(key + ": unknown filter " + name);
+      }
+      begin = comma + 1;
+    }
+  } else if (key == "moving_average_window") {
+    movingAverageWindow = static_cast<size_t>(
+        parseUnsigned(key, value, Filters::MIN_MOVING_AVERAGE_WINDOW,
+                      Filters::MAX_MOVING_AVERAGE_WINDOW));
+  } else if (key == "median_window") {
+    medianWindow = static_cast<size_t>(parseUnsigned(
+        key, value, Filters::MIN_MEDIAN_WINDOW, Filters::MAX_MEDIAN_WINDOW));
+  } else if (key == "exponential_alpha") {
+    exponentialAlpha =
+        parseNumber(key, value, Filters::MIN_EXPONENTIAL_ALPHA,
+                    Filters::MAX_EXPONENTIAL_ALPHA);
+  } else if (key == "kalman_q") {
+    kalmanQ = parseNumber(key, value, 0.0, 1e9);
+  } else if (key == "kalman_r") {
+    kalmanR = parseNumber(key, value, 0.0, 1e9);
+  } else if (key == "output") {
+    output = value;
+  } else if (key == "output_raw") {
+    outputRaw = parseBool(key, value);
+  } else if (key == "stats_interval_ms") {
+    statsIntervalMs =
+        static_cast<uint32_t>(parseUnsigned(key, value, 10, 3600000));
+  } else if (key == "duration_s") {
+    durationSeconds = parseNumber(key, value, 0.0, 1e9);
+  } else if (key == "trace") {
+    trace = value;
+  } else {
+    throw std::invalid_argument("unknown key " + key);
+  }
+}
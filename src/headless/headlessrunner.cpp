@@ -0,0 +1,241 @@
+#include "../../include/headless/headlessrunner.h"
+#include "../../include/core/Constants.h"
+#include "../../include/core/trace.h"
+#include "../../include/filters/exponentialfilter.h"
+#include "../../include/filters/kalmanfilter.h"
+#include "../../include/filters/medianfilter.h"
+#include "../../include/filters/movingaveragefilter.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+// как часто писатель забирает результаты: от этого зависит и задержка
+// до записи
+constexpr std::chrono::milliseconds POLL_INTERVAL(1);
+constexpr size_t OUTPUT_BLOCK_SIZE = 4096;
+constexpr size_t OUTPUT_FILE_BUFFER = 1 << 20;
+} // namespace
+
+HeadlessRunner::HeadlessRunner(const HeadlessConfig &config)
+    : m_config(config), m_block(OUTPUT_BLOCK_SIZE),
+      m_stamps(OUTPUT_BLOCK_SIZE), m_file(nullptr), m_ownsFile(false),
+      m_samplesAtLastReport(0) {
+  m_rawStream = std::make_unique<BroadcastRingBuffer<DataPoint>>(
+      Constants::RAW_STREAM_CAPACITY);
+  if (m_config.outputRaw) {
+    m_outputs.push_back({"Raw", m_rawStream->createReader(), 0, 0});
+  }
+
+  m_networkController = std::make_unique<NetworkController>();
+  m_networkController->initialize(m_rawStream.get(), nullptr);
+  m_networkController->setLatencyHistogram(&m_latency.socketToRing);
+  m_networkController->setReorderWindow(m_config.reorderWindowMs);
+
+  // те же имена серий, что в GUI и в записи сессии
+  m_dataProcessor = std::make_unique<DataProcessor>();
+  m_dataProcessor->setLatencyHistogram(&m_latency.ringToFilter);
+  if (m_config.movingAverage) {
+    addFilter(
+        std::make_unique<MovingAverageFilter>(m_config.movingAverageWindow),
+        m_rawStream->createReader(), "MovingAverage");
+  }
+  if (m_config.median) {
+    addFilter(std::make_unique<MedianFilter>(m_config.medianWindow),
+              m_rawStream->createReader(), "Median");
+  }
+  if (m_config.exponential) {
+    addFilter(std::make_unique<ExponentialFilter>(m_config.exponentialAlpha),
+              m_rawStream->createReader(), "Exponential");
+  }
+  if (m_config.kalman) {
+    addFilter(
+        std::make_unique<KalmanFilter>(m_config.kalmanQ, m_config.kalmanR),
+        m_rawStream->createReader(), "Kalman");
+  }
+
+  // файл открывается последним: дальше конструктор не бросает
+  if (m_config.output == "-") {
+    m_file = stdout;
+  } else if (!m_config.output.empty()) {
+    m_file = std::fopen(m_config.output.c_str(), "w");
+    if (!m_file) {
+      throw std::runtime_error("Failed to open output: " + m_config.output);
+    }
+    m_ownsFile = true;
+  }
+  if (m_file) {
+    std::setvbuf(m_file, nullptr, _IOFBF, OUTPUT_FILE_BUFFER);
+    std::fprintf(m_file, "series,timestamp,value\n");
+  }
+}
+
+HeadlessRunner::~HeadlessRunner() {
+  m_networkController->stopReceiver();
+  m_dataProcessor->stop();
+  if (m_file) {
+    std::fflush(m_file);
+    if (m_ownsFile) {
+      std::fclose(m_file);
+    }
+  }
+}
+
+bool HeadlessRunner::run(const std::atomic<bool> &stopRequested) {
+  using Clock = std::chrono::steady_clock;
+
+  if (!m_config.trace.empty()) {
+    Trace::setThreadName("Output");
+    Trace::clear();
+    Trace::setEnabled(true);
+  }
+  m_dataProcessor->start();
+  if (!m_networkController->startReceiver(m_config.receiveIp,
+                                          m_config.receivePort)) {
+    m_dataProcessor->stop();
+    return false;
+  }
+
+  const Clock::time_point started = Clock::now();
+  const std::chrono::milliseconds statsInterval(m_config.statsIntervalMs);
+  Clock::time_point lastReport = started;
+
+  while (!stopRequested.load()) {
+    std::this_thread::sleep_for(POLL_INTERVAL);
+    drainOutputs();
+
+    const Clock::time_point now = Clock::now();
+    if (now - lastReport >= statsInterval) {
+      printStatistics(std::chrono::duration<double>(now - lastReport).count());
+      lastReport = now;
+    }
+    if (m_config.durationSeconds > 0.0 &&
+        std::chrono::duration<double>(now - started).count() >=
+            m_config.durationSeconds) {
+      break;
+    }
+  }
+
+  // сначала прием, потом фильтры, потом то, что успело дойти до выхода
+  m_networkController->stopReceiver();
+  m_dataProcessor->stop();
+  drainOutputs();
+  printStatistics(
+      std::chrono::duration<double>(Clock::now() - lastReport).count());
+  if (m_file) {
+    std::fflush(m_file);
+  }
+  if (!m_config.trace.empty()) {
+    Trace::setEnabled(false);
+    if (Trace::writeChromeJson(m_config.trace)) {
+      std::fprintf(stderr, "trace: %zu events written to %s\n",
+                   Trace::eventCount(), m_config.trace.c_str());
+    } else {
+      std::fprintf(stderr, "trace: failed to write %s\n",
+                   m_config.trace.c_str());
+    }
+  }
+  return true;
+}
+
+void HeadlessRunner::addFilter(std::unique_ptr<IFilter> filter,
+                               BroadcastRingBuffer<DataPoint>::Reader *input,
+                               const std::string &name) {
+  BroadcastRingBuffer<DataPoint> *output =
+      m_dataProcessor->addFilter(filter.get(), input, name);
+  m_filters.push_back(std::move(filter));
+  m_outputs.push_back({name, output->createReader(), 0, 0});
+}
+
+void HeadlessRunner::drainOutputs() {
+  TRACE_SCOPE("HeadlessRunner::drainOutputs");
+  for (Output &output : m_outputs) {
+    // не больше одного журнала за раз, чтобы быстрая серия не задержала
+    // остальные
+    size_t budget = output.reader->capacity();
+    while (budget > 0) {
+      size_t count = output.reader->popBulkStamped(
+          m_block.data(), m_stamps.data(), std::min(budget, m_block.size()));
+      if (count == 0) {
+        break;
+      }
+      writeBlock(output, m_block.data(), m_stamps.data(), count);
+      budget -= count;
+    }
+  }
+}
+
+void HeadlessRunner::writeBlock(Output &output, const DataPoint *points,
+                                const SampleStamp *stamps, size_t count) {
+  if (m_file) {
+    for (size_t i = 0; i < count; ++i) {
+      std::fprintf(m_file, "%s,%u,%.9g\n", output.name.c_str(),
+                   points[i].timestamp, points[i].value);
+    }
+  }
+  output.written += count;
+
+  // запись в вывод - последняя стадия, как отрисовка в GUI
+  const uint64_t writtenNs = monotonicNs();
+  for (size_t i = 0; i < count; ++i) {
+    m_latency.filterToPlot.recordSince(stamps[i].publishedNs, writtenNs);
+    m_latency.endToEnd.recordSince(stamps[i].receivedNs, writtenNs);
+  }
+}
+
+void HeadlessRunner::printStatistics(double seconds) {
+  if (seconds <= 0.0) {
+    return;
+  }
+
+  const ReceiverStatistics receiver =
+      m_networkController->getReceiverStatistics();
+  std::fprintf(stderr,
+               "rx %.0f pt/s packets %zu lost %llu reordered %llu "
+               "duplicated %llu late %llu",
+               (receiver.samplesReceived - m_samplesAtLastReport) / seconds,
+               receiver.packetsReceived,
+               static_cast<unsigned long long>(receiver.lost),
+               static_cast<unsigned long long>(receiver.reordered),
+               static_cast<unsigned long long>(receiver.duplicated),
+               static_cast<unsigned long long>(receiver.lateDropped));
+  m_samplesAtLastReport = receiver.samplesReceived;
+
+  for (Output &output : m_outputs) {
+    // чего писатель не застал в журнале серии, то потеряно
+    const uint64_t produced =
+        output.name == "Raw"
+            ? receiver.samplesReceived
+            : m_dataProcessor->getFilterProcessedCount(output.name);
+    const uint64_t seen = output.written + output.reader->size();
+    const uint64_t dropped = produced > seen ? produced - seen : 0;
+
+    std::fprintf(stderr, " | %s %.0f pt/s dropped %llu", output.name.c_str(),
+                 (output.written - output.writtenAtLastReport) / seconds,
+                 static_cast<unsigned long long>(dropped));
+    output.writtenAtLastReport = output.written;
+  }
+  std::fprintf(stderr, "\n");
+
+  // задержки по стадиям за интервал, мс: p50/p99/max
+  const struct {
+    const char *name;
+    LatencyHistogram &histogram;
+  } stages[] = {{"socket->ring", m_latency.socketToRing},
+                {"ring->filter", m_latency.ringToFilter},
+                {"filter->output", m_latency.filterToPlot},
+                {"total", m_latency.endToEnd}};
+  std::fprintf(stderr, "latency ms p50/p99/max");
+  for (const auto &stage : stages) {
+    const LatencySummary summary = stage.histogram.takeInterval();
+    if (summary.count == 0) {
+      std::fprintf(stderr, " | %s -", stage.name);
+      continue;
+    }
+    std::fprintf(stderr, " | %s %.3f/%.3f/%.3f", stage.name,
+                 summary.p50Us / 1000.0, summary.p99Us / 1000.0,
+                 summary.maxUs / 1000.0);
+  }
+  std::fprintf(stderr, "\n");
+}
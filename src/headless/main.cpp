@@ -0,0 +1,60 @@
+/*
+ * pidheadless: прием, фильтры и запись результатов без GUI
+ *
+ * запуск: pidheadless <файл настроек> [ключ=значение ...]
+ *
+ * параметры командной строки переопределяют файл (см. HeadlessConfig).
+ * Ctrl+C завершает работу, дописав то, что успело пройти через фильтры
+ */
+
+#include "../../include/headless/headlessconfig.h"
+#include "../../include/headless/headlessrunner.h"
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <exception>
+#include <string>
+
+namespace {
+
+std::atomic<bool> stopRequested(false);
+
+void onSignal(int) { stopRequested.store(true); }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::fprintf(stderr,
+                 "usage: pidheadless <config> [key=value ...]\n");
+    return 2;
+  }
+
+  try {
+    HeadlessConfig config = HeadlessConfig::load(argv[1]);
+    for (int i = 2; i < argc; ++i) {
+      const std::string argument = argv[i];
+      size_t equals = argument.find('=');
+      if (equals == std::string::npos) {
+        throw std::invalid_argument("expected key=value: " + argument);
+      }
+      config.set(argument.substr(0, equals), argument.substr(equals + 1));
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    HeadlessRunner runner(config);
+    if (!runner.run(stopRequested)) {
+      std::fprintf(stderr, "failed to start receiver on %s:%u\n",
+                   config.receiveIp.c_str(),
+                   static_cast<unsigned>(config.receivePort));
+      return 1;
+    }
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -1,23 +1,30 @@
-#include "../../include/ui/networkcontroller.h"
+#include "../../include/network/networkcontroller.h"
 
-NetworkController::NetworkController() : m_displayBuffer(nullptr) {}
+NetworkController::NetworkController() : m_rawStream(nullptr) {}
 
 NetworkController::~NetworkController() { stopReceiver(); }
 
 void NetworkController::initialize(
-    ThreadSafeRingBuffer<DataPoint> *displayBuffer,
+    BroadcastRingBuffer<DataPoint> *rawStream,
     std::function<void(const DataPoint &)> fanOutCallback) {
-  m_displayBuffer = displayBuffer;
+  m_rawStream = rawStream;
 
-  if (!m_displayBuffer) {
+  if (!m_rawStream) {
     return;
   }
 
   // создаем UdpReceiver с коллбеком для веерного вывода
-  m_receiver = std::make_unique<UdpReceiver>(m_displayBuffer, fanOutCallback);
+  m_receiver = std::make_unique<UdpReceiver>(m_rawStream, fanOutCallback);
   m_sender = std::make_unique<UdpSender>();
 }
 
+void NetworkController::setBatchFanOut(
+    std::function<void(const DataPoint *, size_t)> batchFanOutCallback) {
+  if (m_receiver) {
+    m_receiver->setBatchCallback(batchFanOutCallback);
+  }
+}
+
 bool NetworkController::startReceiver(const std::string &ip, uint16_t port) {
   if (!m_receiver) {
     return false;
@@ -49,6 +56,26 @@ size_t NetworkController::getPacketsReceived() const {
   return m_receiver ? m_receiver->getPacketsReceived() : 0;
 }
 
+ReceiverStatistics NetworkController::getReceiverStatistics() const {
+  return m_receiver ? m_receiver->getStatistics() : ReceiverStatistics();
+}
+
+void NetworkController::setLatencyHistogram(LatencyHistogram *socketToRing) {
+  if (m_receiver) {
+    m_receiver->setLatencyHistogram(socketToRing);
+  }
+}
+
+void NetworkController::setReorderWindow(uint32_t windowMs) {
+  if (m_receiver) {
+    m_receiver->setReorderWindow(windowMs);
+  }
+}
+
+uint32_t NetworkController::getReorderWindow() const {
+  return m_receiver ? m_receiver->getReorderWindow() : 0;
+}
+
 size_t NetworkController::getPacketsSent() const {
   return m_sender ? m_sender->getPacketsSent() : 0;
 }
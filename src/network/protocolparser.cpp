@@ -1,10 +1,16 @@
 #include "../../include/network/protocolparser.h"
+#include "../../include/core/Constants.h"
 #include <array>
 #include <stdexcept>
+#include <string>
 
 namespace {
 constexpr size_t DATA_PACKET_SIZE = 8;
 constexpr size_t COMMAND_PACKET_SIZE = 4;
+constexpr size_t V2_HEADER_SIZE =
+    Constants::Network::DATA_PACKET_V2_HEADER_SIZE;
+constexpr size_t V2_SAMPLE_SIZE =
+    Constants::Network::DATA_PACKET_V2_SAMPLE_SIZE;
 } // namespace
 
 DataPoint ProtocolParser::parseDataPacket(const uint8_t *data, size_t size) {
@@ -29,6 +35,101 @@ DataPoint ProtocolParser::parseDataPacket(const uint8_t *data, size_t size) {
   return DataPoint(timestamp, value);
 }
 
+size_t ProtocolParser::parseDataPacketBatch(const uint8_t *data, size_t size,
+                                           DataPoint *out, size_t outCapacity,
+                                           DataPacketHeader *header) {
+  if (!isValidDataPacket(data, size)) {
+    throw std::runtime_error("Invalid data packet: " + std::to_string(size) +
+                             " bytes");
+  }
+
+  // старый формат: один отсчет без заголовка
+  if (size == DATA_PACKET_SIZE) {
+    if (outCapacity < 1) {
+      throw std::runtime_error("Output buffer too small for data packet");
+    }
+    out[0] = DataPoint(bytesToUint32(data), bytesToFloat(data + 4));
+    if (header) {
+      header->magic = 0;
+      header->version = 1;
+      header->channel = 0;
+      header->sequence = 0;
+      header->sampleCount = 1;
+    }
+    return 1;
+  }
+
+  // v2: заголовок + массив отсчетов
+  uint16_t count = bytesToUint16(data + 8);
+  if (count > outCapacity) {
+    throw std::runtime_error("Output buffer too small: packet has " +
+                             std::to_string(count) + " samples");
+  }
+
+  if (header) {
+    header->magic = bytesToUint16(data);
+    header->version = data[2];
+    header->channel = data[3];
+    header->sequence = bytesToUint32(data + 4);
+    header->sampleCount = count;
+  }
+
+  const uint8_t *sample = data + V2_HEADER_SIZE;
+  for (size_t i = 0; i < count; ++i, sample += V2_SAMPLE_SIZE) {
+    out[i] = DataPoint(bytesToUint32(sample), bytesToFloat(sample + 4));
+  }
+
+  return count;
+}
+
+std::vector<uint8_t> ProtocolParser::createDataPacket(uint8_t channel,
+                                                      uint32_t sequence,
+                                                      const DataPoint *points,
+                                                      size_t count) {
+  if (count > Constants::Network::MAX_SAMPLES_PER_PACKET) {
+    throw std::runtime_error("Too many samples for one data packet: " +
+                             std::to_string(count));
+  }
+
+  std::vector<uint8_t> packet(V2_HEADER_SIZE + count * V2_SAMPLE_SIZE, 0);
+  uint16_t magic = Constants::Network::DATA_PACKET_V2_MAGIC;
+  uint16_t sampleCount = static_cast<uint16_t>(count);
+
+  std::memcpy(packet.data(), &magic, sizeof(magic));
+  packet[2] = Constants::Network::DATA_PACKET_V2_VERSION;
+  packet[3] = channel;
+  std::memcpy(packet.data() + 4, &sequence, sizeof(sequence));
+  std::memcpy(packet.data() + 8, &sampleCount, sizeof(sampleCount));
+  // байты 10-11 зарезервированы, остаются нулями
+
+  uint8_t *sample = packet.data() + V2_HEADER_SIZE;
+  for (size_t i = 0; i < count; ++i, sample += V2_SAMPLE_SIZE) {
+    std::memcpy(sample, &points[i].timestamp, sizeof(uint32_t));
+    std::memcpy(sample + 4, &points[i].value, sizeof(float));
+  }
+
+  return packet;
+}
+
+bool ProtocolParser::isValidDataPacket(const uint8_t *data, size_t size) {
+  if (size == DATA_PACKET_SIZE) {
+    return true;
+  }
+
+  if (size < V2_HEADER_SIZE) {
+    return false;
+  }
+
+  if (bytesToUint16(data) != Constants::Network::DATA_PACKET_V2_MAGIC ||
+      data[2] != Constants::Network::DATA_PACKET_V2_VERSION) {
+    return false;
+  }
+
+  // размер должен точно совпадать с количеством отсчетов в заголовке
+  size_t count = bytesToUint16(data + 8);
+  return size == V2_HEADER_SIZE + count * V2_SAMPLE_SIZE;
+}
+
 float ProtocolParser::parseCommandPacket(const uint8_t *data, size_t size) {
   if (!isValidCommandPacketSize(size)) {
     throw std::runtime_error(
@@ -60,6 +161,12 @@ uint32_t ProtocolParser::bytesToUint32(const uint8_t *bytes) {
   return result;
 }
 
+uint16_t ProtocolParser::bytesToUint16(const uint8_t *bytes) {
+  uint16_t result;
+  std::memcpy(&result, bytes, sizeof(uint16_t));
+  return result;
+}
+
 float ProtocolParser::bytesToFloat(const uint8_t *bytes) {
   float result;
   std::memcpy(&result, bytes, sizeof(float));
@@ -0,0 +1,148 @@
+#include "../../include/network/reorderbuffer.h"
+#include <algorithm>
+
+ReorderBuffer::ReorderBuffer(uint32_t windowMs)
+    : m_window(std::min(windowMs, Constants::Network::MAX_REORDER_WINDOW_MS)),
+      m_newest(0), m_lastReleased(0), m_hasReleased(false), m_disorderNs(0),
+      m_lateDropped(0) {
+  m_pending.reserve(Constants::Network::MAX_REORDER_PENDING);
+  m_pendingNs.reserve(Constants::Network::MAX_REORDER_PENDING);
+}
+
+void ReorderBuffer::setWindow(uint32_t windowMs) {
+  m_window = std::min(windowMs, Constants::Network::MAX_REORDER_WINDOW_MS);
+}
+
+uint32_t ReorderBuffer::getWindow() const { return m_window.load(); }
+
+void ReorderBuffer::push(const DataPoint *points, size_t count,
+                         uint64_t receivedNs, bool inSequence,
+                         std::vector<DataPoint> &released,
+                         std::vector<uint64_t> &releasedNs) {
+  uint32_t window = m_window.load(std::memory_order_relaxed);
+
+  // окно выключено: пропускаем как есть, но сначала отдаем остатки
+  if (window == 0) {
+    if (!m_pending.empty()) {
+      flush(released, releasedNs);
+    }
+    released.insert(released.end(), points, points + count);
+    releasedNs.insert(releasedNs.end(), count, receivedNs);
+    return;
+  }
+
+  // пакеты идут по порядку дольше окна: опоздавшим взяться неоткуда,
+  // задержанное отдаем, новое пропускаем сразу
+  const uint64_t windowNs = static_cast<uint64_t>(window) * 1000000;
+  if (!inSequence) {
+    m_disorderNs = receivedNs;
+  } else if (receivedNs >= m_disorderNs + windowNs) {
+    flush(released, releasedNs);
+    if (count > 0) {
+      released.insert(released.end(), points, points + count);
+      releasedNs.insert(releasedNs.end(), count, receivedNs);
+      m_lastReleased = points[count - 1].timestamp;
+      m_newest = m_lastReleased;
+      m_hasReleased = true;
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    const DataPoint &point = points[i];
+
+    if (m_hasReleased && point.timestamp < m_lastReleased) {
+      if (m_lastReleased - point.timestamp > Constants::RESTART_GAP_MS) {
+        // время источника пошло заново: отдаем старое и начинаем с нуля
+        flush(released, releasedNs);
+        m_newest = 0;
+        m_hasReleased = false;
+      } else {
+        // место этого отсчета уже пройдено
+        m_lateDropped.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+    }
+
+    // почти всегда отсчет новее всех - просто дописываем в конец
+    if (m_pending.empty() || point.timestamp >= m_pending.back().timestamp) {
+      m_pending.push_back(point);
+      m_pendingNs.push_back(receivedNs);
+    } else {
+      auto pos = std::upper_bound(
+          m_pending.begin(), m_pending.end(), point.timestamp,
+          [](uint32_t ts, const DataPoint &p) { return ts < p.timestamp; });
+      m_pendingNs.insert(m_pendingNs.begin() + (pos - m_pending.begin()),
+                         receivedNs);
+      m_pending.insert(pos, point);
+    }
+
+    if (point.timestamp > m_newest) {
+      m_newest = point.timestamp;
+    }
+  }
+
+  // выпускаем все, что старше самого нового на ширину окна
+  size_t ready = 0;
+  while (ready < m_pending.size() &&
+         static_cast<uint64_t>(m_pending[ready].timestamp) + window <=
+             m_newest) {
+    ++ready;
+  }
+
+  // и все, что пролежало дольше двух окон, если время источника стоит.
+  // не одного окна: пакеты одного залпа после паузы отправителя приходят
+  // почти сразу, и опоздавший из них еще должен встать на место. при
+  // паузе в приеме окно выпускает таймаут сокета (см. UdpReceiver)
+  const uint64_t holdNs = 2 * windowNs;
+  while (ready < m_pending.size() &&
+         m_pendingNs[ready] + holdNs <= receivedNs) {
+    ++ready;
+  }
+
+  // окно не должно расти бесконечно при очень плотном потоке
+  if (m_pending.size() - ready > Constants::Network::MAX_REORDER_PENDING) {
+    ready = m_pending.size() - Constants::Network::MAX_REORDER_PENDING;
+  }
+
+  if (ready > 0) {
+    const auto readyEnd = static_cast<std::ptrdiff_t>(ready);
+    released.insert(released.end(), m_pending.begin(),
+                    m_pending.begin() + readyEnd);
+    releasedNs.insert(releasedNs.end(), m_pendingNs.begin(),
+                      m_pendingNs.begin() + readyEnd);
+    m_lastReleased = m_pending[ready - 1].timestamp;
+    m_hasReleased = true;
+    m_pending.erase(m_pending.begin(), m_pending.begin() + readyEnd);
+    m_pendingNs.erase(m_pendingNs.begin(), m_pendingNs.begin() + readyEnd);
+  }
+}
+
+void ReorderBuffer::flush(std::vector<DataPoint> &released,
+                          std::vector<uint64_t> &releasedNs) {
+  if (m_pending.empty()) {
+    return;
+  }
+
+  released.insert(released.end(), m_pending.begin(), m_pending.end());
+  releasedNs.insert(releasedNs.end(), m_pendingNs.begin(), m_pendingNs.end());
+  m_lastReleased = m_pending.back().timestamp;
+  m_hasReleased = true;
+  m_pending.clear();
+  m_pendingNs.clear();
+}
+
+void ReorderBuffer::clear() {
+  m_pending.clear();
+  m_pendingNs.clear();
+  m_newest = 0;
+  m_lastReleased = 0;
+  m_hasReleased = false;
+  m_disorderNs = 0;
+}
+
+size_t ReorderBuffer::pending() const { return m_pending.size(); }
+
+uint64_t ReorderBuffer::getLateDropped() const { return m_lateDropped.load(); }
+
+void ReorderBuffer::resetStatistics() { m_lateDropped = 0; }
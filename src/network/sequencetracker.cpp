@@ -0,0 +1,121 @@
+#include "../../include/network/sequencetracker.h"
+
+namespace {
+// скачок назад больше этого считаем перезапуском источника, а не опозданием
+constexpr int64_t RESTART_THRESHOLD = 65536;
+} // namespace
+
+SequenceTracker::SequenceTracker()
+    : m_lost(0), m_reordered(0), m_duplicated(0), m_gapEvents(0),
+      m_sourceCount(0) {}
+
+SequenceTracker::Result SequenceTracker::track(uint64_t sourceKey,
+                                               uint32_t sequence) {
+  auto it = m_sources.find(sourceKey);
+  if (it == m_sources.end()) {
+    SourceState state;
+    state.highest = sequence;
+    state.seen.set(0);
+    m_sources.emplace(sourceKey, state);
+    m_sourceCount.store(m_sources.size(), std::memory_order_relaxed);
+    return Result::First;
+  }
+
+  SourceState &state = it->second;
+
+  // разница со знаком корректно переживает переполнение uint32
+  int64_t diff = static_cast<int32_t>(sequence - state.highest);
+
+  if (diff > 0) {
+    // новый старший номер: сдвигаем окно, пропущенные номера - потери
+    if (static_cast<uint64_t>(diff) >= WINDOW) {
+      state.seen.reset();
+      state.missed.set();
+    } else {
+      state.seen <<= static_cast<size_t>(diff);
+      state.missed <<= static_cast<size_t>(diff);
+      for (int64_t i = 1; i < diff; ++i) {
+        state.missed.set(static_cast<size_t>(i));
+      }
+    }
+    state.seen.set(0);
+    state.missed.reset(0);
+    state.highest = sequence;
+
+    if (diff == 1) {
+      return Result::InOrder;
+    }
+
+    m_lost.fetch_add(static_cast<uint64_t>(diff - 1),
+                     std::memory_order_relaxed);
+    m_gapEvents.fetch_add(1, std::memory_order_relaxed);
+    return Result::Gap;
+  }
+
+  if (diff == 0) {
+    m_duplicated.fetch_add(1, std::memory_order_relaxed);
+    return Result::Duplicate;
+  }
+
+  int64_t behind = -diff;
+  if (behind > RESTART_THRESHOLD) {
+    // источник начал нумерацию заново
+    state.highest = sequence;
+    state.seen.reset();
+    state.missed.reset();
+    state.seen.set(0);
+    return Result::First;
+  }
+
+  if (static_cast<uint64_t>(behind) >= WINDOW) {
+    return Result::Late;
+  }
+
+  size_t bit = static_cast<size_t>(behind);
+  if (state.seen.test(bit)) {
+    m_duplicated.fetch_add(1, std::memory_order_relaxed);
+    return Result::Duplicate;
+  }
+  state.seen.set(bit);
+
+  // опоздавший пакет раньше был засчитан как потерянный (номера до
+  // первого пакета источника потерянными не считались)
+  if (state.missed.test(bit)) {
+    state.missed.reset(bit);
+    // счетчик могли сбросить после того, как потеря засчитана
+    uint64_t lost = m_lost.load(std::memory_order_relaxed);
+    while (lost > 0 && !m_lost.compare_exchange_weak(
+                           lost, lost - 1, std::memory_order_relaxed)) {
+    }
+  }
+  m_reordered.fetch_add(1, std::memory_order_relaxed);
+  return Result::Reordered;
+}
+
+uint64_t SequenceTracker::makeSourceKey(uint32_t address, uint16_t port,
+                                        uint8_t channel) {
+  return (static_cast<uint64_t>(address) << 24) |
+         (static_cast<uint64_t>(port) << 8) | channel;
+}
+
+void SequenceTracker::clearSources() {
+  m_sources.clear();
+  m_sourceCount.store(0, std::memory_order_relaxed);
+}
+
+void SequenceTracker::resetStatistics() {
+  m_lost = 0;
+  m_reordered = 0;
+  m_duplicated = 0;
+  m_gapEvents = 0;
+}
+
+uint64_t SequenceTracker::getLost() const { return m_lost.load(); }
+
+uint64_t SequenceTracker::getReordered() const { return m_reordered.load(); }
+
+uint64_t SequenceTracker::getDuplicated() const { return m_duplicated.load(); }
+
+uint64_t SequenceTracker::getGapEvents() const { return m_gapEvents.load(); }
+
+size_t SequenceTracker::getSourceCount() const { return m_sourceCount.load(); }
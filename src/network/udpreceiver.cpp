@@ -1,5 +1,6 @@
 #include "../../include/network/udpreceiver.h"
 #include "../../include/core/Constants.h"
+#include "../../include/core/trace.h"
 #include "../../include/network/protocolparser.h"
 
 #ifdef _WIN32
@@ -17,13 +18,20 @@
 #include <unistd.h>
 #endif
 
-#include <QDebug>
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
+#include <vector>
 
-UdpReceiver::UdpReceiver(ThreadSafeRingBuffer<DataPoint> *buffer,
+UdpReceiver::UdpReceiver(BroadcastRingBuffer<DataPoint> *buffer,
                          std::function<void(const DataPoint &)> onDataReceived)
-    : m_buffer(buffer), m_onDataReceived(onDataReceived), m_running(false)
+    : m_buffer(buffer), m_onDataReceived(onDataReceived),
+#ifdef __linux__
+      m_batchReceive(true),
+#else
+      m_batchReceive(false),
+#endif
+      m_running(false)
 
 #ifdef _WIN32
 
@@ -37,14 +45,39 @@ UdpReceiver::UdpReceiver(ThreadSafeRingBuffer<DataPoint> *buffer,
 
 #endif
       ,
-      m_packetsReceived(0) {
+      m_receiveTimeoutMs(0), m_packetsReceived(0), m_samplesReceived(0),
+      m_latency(nullptr) {
   if (!m_buffer) {
     throw std::invalid_argument("Buffer cant be null");
   }
+  m_released.reserve(Constants::Network::RECEIVE_BATCH_SIZE *
+                         Constants::Network::MAX_SAMPLES_PER_PACKET +
+                     Constants::Network::MAX_REORDER_PENDING);
+  m_releasedNs.reserve(m_released.capacity());
 }
 
 UdpReceiver::~UdpReceiver() { stop(); }
 
+void UdpReceiver::setLatencyHistogram(LatencyHistogram *socketToRing) {
+  m_latency = socketToRing;
+}
+
+void UdpReceiver::setBatchCallback(
+    std::function<void(const DataPoint *, size_t)> onBatchReceived) {
+  m_onBatchReceived = onBatchReceived;
+}
+
+void UdpReceiver::setBatchReceiveEnabled(bool enabled) {
+#ifdef __linux__
+  m_batchReceive = enabled;
+#else
+  (void)enabled;
+  m_batchReceive = false;
+#endif
+}
+
+bool UdpReceiver::isBatchReceiveEnabled() const { return m_batchReceive; }
+
 bool UdpReceiver::start(const std::string &ip, uint16_t port) {
   if (m_running) {
     return false;
@@ -57,6 +90,10 @@ bool UdpReceiver::start(const std::string &ip, uint16_t port) {
   if (!initializeSocket(ip, port)) {
     return false;
   }
+  m_receiveTimeoutMs = Constants::Network::SOCKET_TIMEOUT_MS;
+  // новая сессия: старые источники и задержанные отсчеты не нужны
+  m_sequenceTracker.clearSources();
+  m_reorderBuffer.clear();
   // запускаем поток
   m_running = true;
   try {
@@ -89,13 +126,162 @@ bool UdpReceiver::isRunning() const { return m_running; }
 
 size_t UdpReceiver::getPacketsReceived() const { return m_packetsReceived; }
 
-void UdpReceiver::resetStatistics() { m_packetsReceived = 0; }
+ReceiverStatistics UdpReceiver::getStatistics() const {
+  ReceiverStatistics stats;
+  stats.packetsReceived = m_packetsReceived.load();
+  stats.samplesReceived = m_samplesReceived.load();
+  stats.lost = m_sequenceTracker.getLost();
+  stats.reordered = m_sequenceTracker.getReordered();
+  stats.duplicated = m_sequenceTracker.getDuplicated();
+  stats.gapEvents = m_sequenceTracker.getGapEvents();
+  stats.lateDropped = m_reorderBuffer.getLateDropped();
+  return stats;
+}
+
+void UdpReceiver::setReorderWindow(uint32_t windowMs) {
+  m_reorderBuffer.setWindow(windowMs);
+}
+
+uint32_t UdpReceiver::getReorderWindow() const {
+  return m_reorderBuffer.getWindow();
+}
+
+void UdpReceiver::resetStatistics() {
+  m_packetsReceived = 0;
+  m_samplesReceived = 0;
+  m_sequenceTracker.resetStatistics();
+  m_reorderBuffer.resetStatistics();
+}
+
+size_t UdpReceiver::acceptPacket(const uint8_t *data, size_t size,
+                                 uint32_t address, uint16_t port,
+                                 DataPoint *out, size_t outCapacity,
+                                 bool &inSequence) {
+  // пакет без отсчетов порядку не мешает
+  inSequence = true;
+
+  // корректный ли пакет (старый 8-байтный или v2)?
+  if (!ProtocolParser::isValidDataPacket(data, size)) {
+    return 0;
+  }
+
+  DataPacketHeader header;
+  size_t count = 0;
+  try {
+    count = ProtocolParser::parseDataPacketBatch(data, size, out, outCapacity,
+                                                 &header);
+  } catch (const std::exception &e) {
+    return 0;
+  }
+
+  m_packetsReceived++;
+
+  // порядковые номера есть только у v2, старый формат всегда идет через
+  // окно
+  inSequence = false;
+  if (header.version >= Constants::Network::DATA_PACKET_V2_VERSION) {
+    uint64_t key =
+        SequenceTracker::makeSourceKey(address, port, header.channel);
+    switch (m_sequenceTracker.track(key, header.sequence)) {
+    case SequenceTracker::Result::Duplicate:
+      inSequence = true;
+      return 0;
+    case SequenceTracker::Result::InOrder:
+      inSequence = true;
+      break;
+    default:
+      break;
+    }
+  }
+
+  return count;
+}
+
+void UdpReceiver::release(const DataPoint *points, size_t count,
+                          uint64_t receivedNs, bool inSequence) {
+  m_released.clear();
+  m_releasedNs.clear();
+  m_reorderBuffer.push(points, count, receivedNs, inSequence, m_released,
+                       m_releasedNs);
+  publish(m_released.data(), m_releasedNs.data(), m_released.size());
+}
+
+void UdpReceiver::flushReorderBuffer() {
+  if (m_reorderBuffer.pending() == 0) {
+    return;
+  }
+  TRACE_SCOPE("UdpReceiver::flushReorderBuffer");
+  m_released.clear();
+  m_releasedNs.clear();
+  m_reorderBuffer.flush(m_released, m_releasedNs);
+  publish(m_released.data(), m_releasedNs.data(), m_released.size());
+}
+
+void UdpReceiver::updateReceiveTimeout() {
+  uint32_t timeoutMs = Constants::Network::SOCKET_TIMEOUT_MS;
+  if (m_reorderBuffer.pending() > 0) {
+    timeoutMs = std::max<uint32_t>(1, m_reorderBuffer.getWindow());
+  }
+  if (timeoutMs != m_receiveTimeoutMs && setReceiveTimeout(timeoutMs)) {
+    m_receiveTimeoutMs = timeoutMs;
+  }
+}
+
+bool UdpReceiver::setReceiveTimeout(uint32_t timeoutMs) {
+#ifdef _WIN32
+  DWORD timeout = timeoutMs;
+  return setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO,
+                    reinterpret_cast<const char *>(&timeout),
+                    sizeof(timeout)) != SOCKET_ERROR;
+#else
+  struct timeval timeout;
+  timeout.tv_sec = timeoutMs / 1000;
+  timeout.tv_usec = (timeoutMs % 1000) * 1000;
+  return setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                    sizeof(timeout)) == 0;
+#endif
+}
+
+void UdpReceiver::publish(const DataPoint *points,
+                          const uint64_t *receivedNs, size_t count) {
+  if (count == 0) {
+    return;
+  }
+
+  m_samplesReceived += count;
+
+  // весь блок одной записью в журнал, читатели заберут его сами
+  m_buffer->pushBulk(points, count, receivedNs);
+
+  if (m_latency) {
+    const uint64_t publishedNs = monotonicNs();
+    for (size_t i = 0; i < count; ++i) {
+      m_latency->recordSince(receivedNs[i], publishedNs);
+    }
+  }
+
+  if (m_onBatchReceived) {
+    m_onBatchReceived(points, count);
+  } else if (m_onDataReceived) {
+    for (size_t i = 0; i < count; ++i) {
+      m_onDataReceived(points[i]);
+    }
+  }
+}
 
 void UdpReceiver::receiveLoop() {
+  Trace::setThreadName("UdpReceiver");
+#ifdef __linux__
+  if (m_batchReceive) {
+    receiveLoopBatched();
+    return;
+  }
+#endif
 
-  int packetCount = 0;
   // буфер для приема данных
   uint8_t buffer[Constants::Network::UDP_BUFFER_SIZE];
+  // отсчеты одного пакета (v2 несет до MAX_SAMPLES_PER_PACKET)
+  DataPoint points[Constants::Network::MAX_SAMPLES_PER_PACKET];
 
   // бесконечный цикл приема данных
   while (m_running) {
@@ -110,6 +296,8 @@ void UdpReceiver::receiveLoop() {
     }
 #endif
 
+    updateReceiveTimeout();
+
     // структура для адреса отправителя
     struct sockaddr_in senderAddr;
     socklen_t senderLen = sizeof(senderAddr);
@@ -136,31 +324,93 @@ void UdpReceiver::receiveLoop() {
         break;
       }
 #endif
+      // пауза в потоке дольше окна: отдаем задержанные в окне отсчеты
+      flushReorderBuffer();
       // чтош, продолжаем цикл
       continue;
     }
+    const uint64_t receivedNs = monotonicNs();
+    TRACE_SCOPE("UdpReceiver::receive");
+
+    bool inSequence = true;
+    size_t count =
+        acceptPacket(buffer, static_cast<size_t>(received),
+                     senderAddr.sin_addr.s_addr, senderAddr.sin_port, points,
+                     Constants::Network::MAX_SAMPLES_PER_PACKET, inSequence);
+    // и без новых отсчетов (дубликат, мусор) выпускаем отлежавшие окно
+    release(points, count, receivedNs, inSequence);
+  }
+}
+
+#ifdef __linux__
+void UdpReceiver::receiveLoopBatched() {
+  constexpr size_t batchSize = Constants::Network::RECEIVE_BATCH_SIZE;
+  constexpr size_t slotSize = Constants::Network::UDP_BUFFER_SIZE;
+  constexpr size_t maxSamples = Constants::Network::MAX_SAMPLES_PER_PACKET;
+
+  // слоты под датаграммы выделяем один раз на весь цикл приема
+  std::vector<uint8_t> storage(batchSize * slotSize);
+  std::vector<struct iovec> iovecs(batchSize);
+  std::vector<struct mmsghdr> messages(batchSize);
+  std::vector<struct sockaddr_in> senders(batchSize);
+  std::vector<DataPoint> points(batchSize * maxSamples);
+
+  for (size_t i = 0; i < batchSize; ++i) {
+    iovecs[i].iov_base = storage.data() + i * slotSize;
+    iovecs[i].iov_len = slotSize;
+    std::memset(&messages[i], 0, sizeof(messages[i]));
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+    messages[i].msg_hdr.msg_name = &senders[i];
+  }
 
-    // правильный ли размер пакета?
-    if (received == Constants::Network::DATA_PACKET_SIZE) {
-      packetCount++;
+  while (m_running) {
+    if (m_socket < 0) {
+      break;
+    }
 
-      try {
-        DataPoint point = ProtocolParser::parseDataPacket(buffer, received);
-        m_buffer->push(point);
+    updateReceiveTimeout();
 
-        if (m_onDataReceived) {
-          m_onDataReceived(point);
-        }
+    // ядро перезаписывает длину адреса, восстанавливаем перед каждым вызовом
+    for (size_t i = 0; i < batchSize; ++i) {
+      messages[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+    }
 
-        // атомарно обновляем статистику
-        m_packetsReceived++;
+    // MSG_WAITFORONE: ждем первую датаграмму (с учетом SO_RCVTIMEO),
+    // остальные забираем только если они уже лежат в очереди сокета
+    int received = recvmmsg(m_socket, messages.data(),
+                            static_cast<unsigned int>(batchSize),
+                            MSG_WAITFORONE, nullptr);
 
-      } catch (const std::exception &e) {
-        continue;
+    if (received <= 0) {
+      if (m_socket < 0 || !m_running) {
+        break;
       }
+      // пауза в потоке дольше окна: отдаем задержанные в окне отсчеты
+      flushReorderBuffer();
+      continue;
+    }
+    // одно время приема на пачку: она пришла одним системным вызовом
+    const uint64_t receivedNs = monotonicNs();
+    TRACE_SCOPE("UdpReceiver::receiveBatch");
+
+    // парсим всю пачку за один проход
+    size_t count = 0;
+    bool inSequence = true;
+    for (int i = 0; i < received; ++i) {
+      const uint8_t *data = storage.data() + static_cast<size_t>(i) * slotSize;
+      bool packetInSequence = true;
+      count += acceptPacket(data, messages[i].msg_len,
+                            senders[i].sin_addr.s_addr, senders[i].sin_port,
+                            points.data() + count, points.size() - count,
+                            packetInSequence);
+      inSequence = inSequence && packetInSequence;
     }
+
+    release(points.data(), count, receivedNs, inSequence);
   }
 }
+#endif
 
 bool UdpReceiver::initializeSocket(const std::string &ip, uint16_t port) {
   // инициализируем сокет
@@ -196,6 +446,11 @@ bool UdpReceiver::initializeSocket(const std::string &ip, uint16_t port) {
     m_socket = INVALID_SOCKET;
     return false;
   }
+  // большая очередь приема - по возможности, без нее сокет тоже работает
+  int receiveBuffer = Constants::Network::SOCKET_RECEIVE_BUFFER_SIZE;
+  setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF,
+             reinterpret_cast<const char *>(&receiveBuffer),
+             sizeof(receiveBuffer));
 #else
   // настройка сокета для линуха
   m_socket = socket(AF_INET, SOCK_DGRAM, 0);
@@ -220,6 +475,11 @@ bool UdpReceiver::initializeSocket(const std::string &ip, uint16_t port) {
     m_socket = -1;
     return false;
   }
+
+  // большая очередь приема - по возможности, без нее сокет тоже работает
+  int receiveBuffer = Constants::Network::SOCKET_RECEIVE_BUFFER_SIZE;
+  setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &receiveBuffer,
+             sizeof(receiveBuffer));
 #endif
 
   // настройка адреса
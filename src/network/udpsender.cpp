@@ -14,7 +14,6 @@
 #include <unistd.h>
 #endif
 
-#include <QDebug>
 #include <cstring>
 
 UdpSender::UdpSender()
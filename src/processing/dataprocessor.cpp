@@ -1,27 +1,27 @@
 #include "../../include/processing/dataprocessor.h"
 #include "../../include/core/Constants.h"
-#include <QDebug>
 #include <algorithm>
 #include <stdexcept>
 
-DataProcessor::DataProcessor() {}
+DataProcessor::DataProcessor() : m_latency(nullptr) {}
 
 DataProcessor::~DataProcessor() { stop(); }
 
-ThreadSafeRingBuffer<DataPoint> *
+BroadcastRingBuffer<DataPoint> *
 DataProcessor::addFilter(IFilter *filter,
-                         ThreadSafeRingBuffer<DataPoint> *inputBuffer,
+                         IBufferReader<DataPoint> *inputBuffer,
                          const std::string &name) {
   if (!filter || !inputBuffer) {
     return nullptr;
   }
 
-  // создаем output buffer для отфильтрованных данных
-  auto outputBuffer = std::make_unique<ThreadSafeRingBuffer<DataPoint>>(
-      Constants::DEFAULT_BUFFER_SIZE);
+  // создаем журнал для отфильтрованных данных: пишет только поток фильтра,
+  // читают график и расчет спектра своими курсорами
+  auto outputBuffer = std::make_unique<BroadcastRingBuffer<DataPoint>>(
+      Constants::FILTER_OUTPUT_CAPACITY);
 
   // сохраняем указатель на output buffer
-  ThreadSafeRingBuffer<DataPoint> *outputBufferPtr = outputBuffer.get();
+  BroadcastRingBuffer<DataPoint> *outputBufferPtr = outputBuffer.get();
 
   // FilterThread. для каждого фильтра свой входной буфер
   std::string filterName = name.empty() ? filter->getName() : name;
@@ -31,6 +31,7 @@ DataProcessor::addFilter(IFilter *filter,
                                      outputBufferPtr,   // выходной буфер
                                      filterName.c_str() // имя фильтра
       );
+  thread->setLatencyHistogram(m_latency);
 
   // создаем FilterInfo и сохраняем
   auto filterInfo = std::make_unique<FilterInfo>(
@@ -63,7 +64,7 @@ bool DataProcessor::removeFilter(const std::string &name) {
   return false;
 }
 
-ThreadSafeRingBuffer<DataPoint> *
+BroadcastRingBuffer<DataPoint> *
 DataProcessor::getFilterOutputBuffer(const std::string &name) const {
 
   auto it = std::find_if(m_filters.begin(), m_filters.end(),
@@ -154,3 +155,12 @@ size_t DataProcessor::getFilterProcessedCount(const std::string &name) const {
 
   return 0;
 }
+
+void DataProcessor::setLatencyHistogram(LatencyHistogram *ringToFilter) {
+  m_latency = ringToFilter;
+  for (auto &filterInfo : m_filters) {
+    if (filterInfo->thread) {
+      filterInfo->thread->setLatencyHistogram(ringToFilter);
+    }
+  }
+}
@@ -1,4 +1,7 @@
 #include "../../include/processing/filterthread.h"
+#include "../../include/core/Constants.h"
+#include "../../include/core/trace.h"
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <mutex>
@@ -6,12 +9,17 @@
 #include <thread>
 
 FilterThread::FilterThread(IFilter *filter,
-                           ThreadSafeRingBuffer<DataPoint> *inputBuffer,
-                           ThreadSafeRingBuffer<DataPoint> *outputBuffer,
+                           IBufferReader<DataPoint> *inputBuffer,
+                           BroadcastRingBuffer<DataPoint> *outputBuffer,
                            const char *name)
     : m_filter(filter), m_inputBuffer(inputBuffer),
-      m_outputBuffer(outputBuffer), m_running(false), m_processedCount(0),
-      m_name(name ? name : "FilterThread") {
+      m_outputBuffer(outputBuffer),
+      m_inputBlock(Constants::FILTER_INPUT_BLOCK_SIZE),
+      m_outputBlock(Constants::FILTER_INPUT_BLOCK_SIZE),
+      m_inputStamps(Constants::FILTER_INPUT_BLOCK_SIZE),
+      m_outputReceivedNs(Constants::FILTER_INPUT_BLOCK_SIZE),
+      m_latency(nullptr), m_running(false),
+      m_processedCount(0), m_name(name ? name : "FilterThread") {
   // конструктор вызывается из GUI потока
   if (!m_filter) {
     throw std::invalid_argument("Filter cannot be nullptr");
@@ -27,7 +35,7 @@ FilterThread::FilterThread(IFilter *filter,
 FilterThread::~FilterThread() { stop(); }
 
 void FilterThread::start() {
-  // start() вызывается из GUI потока, можно использовать qDebug
+  // start() вызывается из управляющего потока (GUI или pidheadless)
   if (m_running.load()) {
     return; // Уже запущен
   }
@@ -43,13 +51,18 @@ void FilterThread::start() {
 }
 
 void FilterThread::stop() {
-  // stop() вызывается из GUI потока, можно использовать qDebug
+  // stop() вызывается из управляющего потока (GUI или pidheadless)
   if (!m_running.load()) {
     return; // Уже остановлен
   }
 
   m_running.store(false);
 
+  // поток может спать в ожидании данных - будим, чтобы не ждать таймаута
+  if (m_inputBuffer) {
+    m_inputBuffer->wakeWaiters();
+  }
+
   if (m_thread.joinable()) {
     m_thread.join(); // Ждем завершения потока
   }
@@ -63,8 +76,13 @@ size_t FilterThread::getProcessedCount() const {
   return m_processedCount.load();
 }
 
+void FilterThread::setLatencyHistogram(LatencyHistogram *ringToFilter) {
+  m_latency.store(ringToFilter);
+}
+
 void FilterThread::run() {
   // run() выполняется в отдельном потоке
+  Trace::setThreadName("Filter " + m_name);
   int iteration = 0;
 
   while (m_running.load()) {
@@ -75,40 +93,56 @@ void FilterThread::run() {
       continue;
     }
 
-    // читаем все доступные данные из входного буфера
-    std::vector<DataPoint> inputData;
+    // забираем блок данных во внутренний массив, без выделения памяти
+    size_t count = 0;
     try {
-      inputData = m_inputBuffer->popAll();
+      count = m_inputBuffer->popBulkStamped(
+          m_inputBlock.data(), m_inputStamps.data(), m_inputBlock.size());
     } catch (...) {
 
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
       continue;
     }
 
-    if (inputData.empty()) {
-      // если данных нет, то засыпаем на 100 мс
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-
+    if (count == 0) {
+      // если данных нет, то спим, пока писатель не опубликует новый блок
+      m_inputBuffer->waitForData(
+          std::chrono::milliseconds(Constants::FILTER_WAIT_TIMEOUT_MS));
       continue;
     }
 
-    // обрабатываем все полученные данные
-    for (const auto &point : inputData) {
-      if (!m_running.load()) {
-        break; // если поток остановлен, то прерываем обработку
-      }
-      processPoint(point);
-    }
+    // обрабатываем все полученные данные одним блоком
+    TRACE_SCOPE("FilterThread::processBlock");
+    processBlock(count);
   }
 }
 
-void FilterThread::processPoint(const DataPoint &point) {
-  // применяем фильтр к точке данных и сохраняем результат
-  DataPoint filtered = m_filter->filter(point);
+void FilterThread::processBlock(size_t count) {
+  // фильтр пишет в m_outputBlock только результаты, на которых он готов
+  size_t produced =
+      m_filter->processBlock(m_inputBlock.data(), count, m_outputBlock.data());
+
+  if (produced == 0) {
+    return;
+  }
 
-  // если фильтр готов (накопил достаточно данных), то сохраняем результат
-  if (m_filter->isReady()) {
-    m_outputBuffer->push(filtered);
-    m_processedCount.fetch_add(1);
+  // результаты относятся к последним produced входным отсчетам
+  const size_t first = count - std::min(produced, count);
+  for (size_t i = 0; i < produced; ++i) {
+    m_outputReceivedNs[i] = m_inputStamps[std::min(first + i, count - 1)]
+                                .receivedNs;
+  }
+  m_outputBuffer->pushBulk(m_outputBlock.data(), produced,
+                           m_outputReceivedNs.data());
+  m_processedCount.fetch_add(produced);
+
+  LatencyHistogram *latency = m_latency.load(std::memory_order_relaxed);
+  if (latency) {
+    const uint64_t publishedNs = monotonicNs();
+    for (size_t i = 0; i < produced; ++i) {
+      latency->recordSince(
+          m_inputStamps[std::min(first + i, count - 1)].publishedNs,
+          publishedNs);
+    }
   }
 }
@@ -0,0 +1,248 @@
+#include "../../include/processing/spectrumanalyzer.h"
+#include "../../include/core/fft.h"
+#include "../../include/core/trace.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+// частота, если по истории оценить не удалось
+constexpr double DEFAULT_SAMPLE_RATE = 50.0;
+// больший интервал между отсчетами - пауза в потоке, а не период
+constexpr uint32_t MAX_SAMPLE_INTERVAL_MS = 10000;
+} // namespace
+
+SpectrumAnalyzer::SpectrumAnalyzer(std::chrono::milliseconds period)
+    : m_period(period), m_drainBlock(Constants::Spectrum::MAX_FFT_SIZE),
+      m_fftInput(Constants::Spectrum::MAX_FFT_SIZE),
+      m_fftSpectrum(Constants::Spectrum::MAX_FFT_SIZE / 2 + 1),
+      m_hasLatest(false), m_running(false), m_computedFrames(0),
+      m_droppedFrames(0) {
+  if (m_period.count() <= 0) {
+    throw std::invalid_argument("Spectrum period must be positive");
+  }
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() { stop(); }
+
+void SpectrumAnalyzer::addSeries(const std::string &name,
+                                 IBufferReader<DataPoint> *reader) {
+  if (!reader) {
+    throw std::invalid_argument("Spectrum series reader cannot be nullptr");
+  }
+  if (m_running.load()) {
+    throw std::runtime_error("Cannot add spectrum series while running");
+  }
+
+  SeriesState state;
+  state.name = name;
+  state.reader = reader;
+  state.history.resize(Constants::Spectrum::MAX_FFT_SIZE);
+  state.head = 0;
+  state.count = 0;
+  m_series.push_back(std::move(state));
+
+  // у каждого кадра по серии на каждую добавленную серию
+  m_work.series.resize(m_series.size());
+  m_work.series.back().name = name;
+}
+
+void SpectrumAnalyzer::start() {
+  if (m_running.load()) {
+    return;
+  }
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  // спектр после перезапуска не должен смешивать старые и новые данные
+  for (SeriesState &state : m_series) {
+    state.head = 0;
+    state.count = 0;
+  }
+
+  m_running.store(true);
+  m_thread = std::thread(&SpectrumAnalyzer::run, this);
+}
+
+void SpectrumAnalyzer::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_stopMutex);
+    if (!m_running.load()) {
+      return;
+    }
+    m_running.store(false);
+  }
+  m_stopCondition.notify_all();
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+bool SpectrumAnalyzer::isRunning() const { return m_running.load(); }
+
+bool SpectrumAnalyzer::takeLatest(SpectrumFrame &frame) {
+  std::lock_guard<std::mutex> lock(m_frameMutex);
+  if (!m_hasLatest) {
+    return false;
+  }
+  std::swap(frame, m_latest);
+  m_hasLatest = false;
+  return true;
+}
+
+uint64_t SpectrumAnalyzer::getComputedFrames() const {
+  return m_computedFrames.load();
+}
+
+uint64_t SpectrumAnalyzer::getDroppedFrames() const {
+  return m_droppedFrames.load();
+}
+
+void SpectrumAnalyzer::run() {
+  // run() выполняется в отдельном потоке
+  Trace::setThreadName("SpectrumAnalyzer");
+  auto next = std::chrono::steady_clock::now() + m_period;
+
+  while (m_running.load()) {
+    {
+      std::unique_lock<std::mutex> lock(m_stopMutex);
+      m_stopCondition.wait_until(lock, next,
+                                 [this] { return !m_running.load(); });
+    }
+    if (!m_running.load()) {
+      break;
+    }
+    next += m_period;
+
+    // не догоняем пропущенные периоды, если расчет затянулся
+    auto now = std::chrono::steady_clock::now();
+    if (next < now) {
+      next = now + m_period;
+    }
+
+    try {
+      TRACE_SCOPE("SpectrumAnalyzer::frame");
+      for (size_t i = 0; i < m_series.size(); ++i) {
+        drain(m_series[i]);
+        TRACE_SCOPE("SpectrumAnalyzer::computeSeries");
+        computeSeries(m_series[i], m_work.series[i]);
+      }
+    } catch (...) {
+      // кадр не получился, следующий попробуем через период
+      continue;
+    }
+
+    publish();
+  }
+}
+
+void SpectrumAnalyzer::drain(SeriesState &state) {
+  const size_t capacity = state.history.size();
+
+  // не больше одного буфера за раз, чтобы быстрый писатель не задержал кадр
+  size_t budget = state.reader->capacity();
+  while (budget > 0) {
+    size_t count = state.reader->popBulk(
+        m_drainBlock.data(), std::min(budget, m_drainBlock.size()));
+    if (count == 0) {
+      break;
+    }
+    budget -= count;
+
+    for (size_t i = 0; i < count; ++i) {
+      state.history[state.head] = m_drainBlock[i];
+      state.head = (state.head + 1) % capacity;
+    }
+    state.count = std::min(capacity, state.count + count);
+  }
+}
+
+void SpectrumAnalyzer::computeSeries(const SeriesState &state,
+                                     SpectrumSeries &out) {
+  if (state.count < Constants::Spectrum::MIN_FFT_SIZE) {
+    out.valid = false;
+    return;
+  }
+
+  // последние count отсчетов в хронологическом порядке
+  const size_t capacity = state.history.size();
+  const size_t count = state.count;
+  size_t index = (state.head + capacity - count) % capacity;
+  for (size_t i = 0; i < count; ++i) {
+    m_fftInput[i] = state.history[index].value;
+    index = (index + 1) % capacity;
+  }
+
+  out.sampleRate = estimateSampleRate(state);
+
+  // план на размер берется из кэша, результаты пишутся в буферы кадра
+  const size_t fftSize = FFT::nextPowerOfTwo(count);
+  FFT::getPlan(fftSize)->forward(m_fftInput.data(), count,
+                                 m_fftSpectrum.data());
+
+  // бины от 0 до Найквиста не включительно
+  const size_t spectrumSize = fftSize / 2;
+  out.amplitudes.resize(spectrumSize);
+  out.frequencies.resize(spectrumSize);
+  FFT::computeAmplitudes(m_fftSpectrum.data(), spectrumSize,
+                         out.amplitudes.data());
+  FFT::computeFrequencies(fftSize, out.sampleRate, out.frequencies.data(),
+                          spectrumSize);
+  out.valid = true;
+}
+
+double SpectrumAnalyzer::estimateSampleRate(const SeriesState &state) {
+  const size_t capacity = state.history.size();
+  size_t index = (state.head + capacity - state.count) % capacity;
+
+  // частота по всему окну: (число интервалов) / (время между первым и
+  // последним). timestamp в мс, а отсчетов бывает много на одну мс, так
+  // что интервалы 0 тоже в счет. выпадают только разрывы и скачки назад
+  // (перезапуск источника), они не часть шага дискретизации
+  uint64_t totalTime = 0;
+  size_t validPairs = 0;
+  uint32_t previous = state.history[index].timestamp;
+  for (size_t i = 1; i < state.count; ++i) {
+    index = (index + 1) % capacity;
+    uint32_t current = state.history[index].timestamp;
+    uint32_t dt = current - previous;
+    if (dt < MAX_SAMPLE_INTERVAL_MS) {
+      totalTime += dt;
+      ++validPairs;
+    }
+    previous = current;
+  }
+
+  if (validPairs == 0) {
+    return DEFAULT_SAMPLE_RATE;
+  }
+  // все окно уложилось в одну мс: частота не меньше, чем за 1 мс
+  totalTime = std::max<uint64_t>(totalTime, 1);
+
+  double avgIntervalMs =
+      static_cast<double>(totalTime) / static_cast<double>(validPairs);
+  return 1000.0 / avgIntervalMs;
+}
+
+void SpectrumAnalyzer::publish() {
+  uint64_t sequence = m_computedFrames.fetch_add(1) + 1;
+  m_work.sequence = sequence;
+
+  {
+    std::lock_guard<std::mutex> lock(m_frameMutex);
+    if (m_hasLatest) {
+      // GUI не забрал прошлый кадр - он устарел
+      m_droppedFrames.fetch_add(1);
+    }
+    std::swap(m_work, m_latest);
+    m_hasLatest = true;
+  }
+
+  // в m_work теперь старый кадр (или кадр, отданный GUI): имена серий
+  // должны совпадать с текущим набором
+  m_work.series.resize(m_series.size());
+  for (size_t i = 0; i < m_series.size(); ++i) {
+    m_work.series[i].name = m_series[i].name;
+  }
+}
@@ -0,0 +1,99 @@
+#include "../../include/simulator/impairment.h"
+#include <algorithm>
+
+namespace {
+
+// std::push_heap строит max-кучу: "меньше" - у более позднего срока
+struct LaterFirst {
+  template <typename T> bool operator()(const T &a, const T &b) const {
+    return a.due != b.due ? a.due > b.due : a.order > b.order;
+  }
+};
+
+} // namespace
+
+NetworkImpairment::NetworkImpairment(const ImpairmentConfig &config)
+    : m_config(config), m_random(config.seed), m_unit(0.0, 1.0),
+      m_burst(false), m_order(0) {}
+
+void NetworkImpairment::submit(Packet packet, Clock::time_point now) {
+  ++m_stats.submitted;
+
+  // состояние цепочки меняется на каждом пакете, в том числе потерянном
+  if (m_burst) {
+    if (m_unit(m_random) < m_config.burstExit) {
+      m_burst = false;
+    }
+  } else if (m_config.burstEnter > 0.0 &&
+             m_unit(m_random) < m_config.burstEnter) {
+    m_burst = true;
+  }
+
+  // пакет, пришедший от источника, продвигает задержанные
+  std::vector<Packet> due;
+  for (size_t i = 0; i < m_held.size();) {
+    if (--m_held[i].remaining == 0) {
+      due.push_back(std::move(m_held[i].packet));
+      m_held.erase(m_held.begin() + static_cast<std::ptrdiff_t>(i));
+    } else {
+      ++i;
+    }
+  }
+
+  const double loss = m_burst ? m_config.burstLoss : m_config.loss;
+  if (loss > 0.0 && m_unit(m_random) < loss) {
+    ++m_stats.dropped;
+    if (m_burst) {
+      ++m_stats.burstDrops;
+    }
+  } else if (m_config.reorder > 0.0 && m_config.reorderDepth > 0 &&
+             m_unit(m_random) < m_config.reorder) {
+    ++m_stats.reordered;
+    m_held.push_back({m_config.reorderDepth, std::move(packet)});
+  } else {
+    if (m_config.duplicate > 0.0 && m_unit(m_random) < m_config.duplicate) {
+      ++m_stats.duplicated;
+      schedule(packet, now);
+    }
+    schedule(std::move(packet), now);
+  }
+
+  // задержанные уходят после текущего пакета
+  for (Packet &held : due) {
+    schedule(std::move(held), now);
+  }
+}
+
+void NetworkImpairment::release(
+    Clock::time_point now, const std::function<void(const Packet &)> &send) {
+  while (!m_queue.empty() && m_queue.front().due <= now) {
+    std::pop_heap(m_queue.begin(), m_queue.end(), LaterFirst());
+    ++m_stats.delivered;
+    send(m_queue.back().packet);
+    m_queue.pop_back();
+  }
+}
+
+void NetworkImpairment::flush(
+    const std::function<void(const Packet &)> &send) {
+  for (Held &held : m_held) {
+    schedule(std::move(held.packet), Clock::time_point::min());
+  }
+  m_held.clear();
+  release(Clock::time_point::max(), send);
+}
+
+NetworkImpairment::Clock::time_point NetworkImpairment::nextDue() const {
+  return m_queue.empty() ? Clock::time_point::max() : m_queue.front().due;
+}
+
+void NetworkImpairment::schedule(Packet packet, Clock::time_point now) {
+  Clock::time_point due = now;
+  if (m_config.jitterMs > 0.0 && now != Clock::time_point::min()) {
+    due += std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(m_unit(m_random) *
+                                                  m_config.jitterMs));
+  }
+  m_queue.push_back({due, m_order++, std::move(packet)});
+  std::push_heap(m_queue.begin(), m_queue.end(), LaterFirst());
+}
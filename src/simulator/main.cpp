@@ -0,0 +1,128 @@
+/*
+ * pidsim: локальная модель PID вместо PIDemulator/model.py
+ *
+ * запуск: pidsim [ключ=значение ...]
+ *
+ * ключи - см. SimulatorConfig::set, плюс duration_s (сколько работать,
+ * 0 - до Ctrl+C) и stats_interval_ms. раз в интервал в stderr
+ * печатается, сколько ушло отсчетов и пакетов и худшее опоздание темпа,
+ * а если включены искажения - сколько пакетов они выбросили, переставили
+ * и повторили
+ */
+
+#include "../../include/core/keyvalue.h"
+#include "../../include/simulator/plantsimulator.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+std::atomic<bool> stopRequested(false);
+
+void onSignal(int) { stopRequested.store(true); }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  using Clock = std::chrono::steady_clock;
+
+  SimulatorConfig config;
+  double durationSeconds = 0.0;
+  long statsIntervalMs = 1000;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      const std::string argument = argv[i];
+      size_t equals = argument.find('=');
+      if (equals == std::string::npos) {
+        throw std::invalid_argument("expected key=value: " + argument);
+      }
+      const std::string key = argument.substr(0, equals);
+      const std::string value = argument.substr(equals + 1);
+      if (key == "duration_s") {
+        durationSeconds = KeyValue::parseNumber(key, value, 0.0, 1e9);
+      } else if (key == "stats_interval_ms") {
+        statsIntervalMs = static_cast<long>(
+            KeyValue::parseUnsigned(key, value, 10, 3600000));
+      } else {
+        config.set(key, value);
+      }
+    }
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "%s\nusage: pidsim [key=value ...]\n", e.what());
+    return 2;
+  }
+
+  std::signal(SIGINT, onSignal);
+  std::signal(SIGTERM, onSignal);
+
+  PlantSimulator simulator(config);
+  if (!simulator.start()) {
+    std::fprintf(stderr,
+                 "failed to open sockets (commands %s:%u, data %s:%u)\n",
+                 config.commandIp.c_str(),
+                 static_cast<unsigned>(config.commandPort),
+                 config.dataIp.c_str(), static_cast<unsigned>(config.dataPort));
+    return 1;
+  }
+  std::fprintf(stderr,
+               "pidsim: %.0f Hz, %zu samples/packet (%s) -> %s:%u, "
+               "commands on %s:%u\n",
+               config.rateHz, config.samplesPerPacket(),
+               config.legacyFormat ? "legacy" : "v2", config.dataIp.c_str(),
+               static_cast<unsigned>(config.dataPort),
+               config.commandIp.c_str(),
+               static_cast<unsigned>(config.commandPort));
+
+  const Clock::time_point started = Clock::now();
+  Clock::time_point lastReport = started;
+  SimulatorStatistics last = simulator.getStatistics();
+  while (!stopRequested.load()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const Clock::time_point now = Clock::now();
+    const double elapsed =
+        std::chrono::duration<double>(now - started).count();
+    const bool finished = durationSeconds > 0.0 && elapsed >= durationSeconds;
+
+    if (now - lastReport >= std::chrono::milliseconds(statsIntervalMs) ||
+        finished) {
+      const double seconds =
+          std::chrono::duration<double>(now - lastReport).count();
+      const SimulatorStatistics stats = simulator.getStatistics();
+      std::fprintf(stderr,
+                   "tx %.0f pt/s %.0f pkt/s errors %llu | setpoint %.3f "
+                   "commands %llu | lateness max %.1f us resyncs %llu\n",
+                   (stats.samplesSent - last.samplesSent) / seconds,
+                   (stats.packetsSent - last.packetsSent) / seconds,
+                   static_cast<unsigned long long>(stats.sendErrors),
+                   stats.setpoint,
+                   static_cast<unsigned long long>(stats.commandsReceived),
+                   stats.maxLatenessUs,
+                   static_cast<unsigned long long>(stats.resyncs));
+      if (config.impairment.enabled()) {
+        const ImpairmentStatistics &impaired = stats.impairment;
+        std::fprintf(stderr,
+                     "    impairment: dropped %llu (burst %llu) "
+                     "reordered %llu duplicated %llu\n",
+                     static_cast<unsigned long long>(impaired.dropped),
+                     static_cast<unsigned long long>(impaired.burstDrops),
+                     static_cast<unsigned long long>(impaired.reordered),
+                     static_cast<unsigned long long>(impaired.duplicated));
+      }
+      last = stats;
+      lastReport = now;
+    }
+    if (finished) {
+      break;
+    }
+  }
+
+  simulator.stop();
+  return 0;
+}
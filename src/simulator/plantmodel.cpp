@@ -0,0 +1,64 @@
+#include "../../include/simulator/plantmodel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+PlantModel::PlantModel(const PlantParameters &parameters)
+    : m_parameters(parameters), m_value(0.0), m_integral(0.0),
+      m_previousError(0.0), m_outlierRemaining(0.0), m_outlierValue(0.0),
+      m_random(parameters.seed) {}
+
+float PlantModel::sample(double setpoint, double period) {
+  // крупный период между отсчетами режем на шаги не больше MAX_STEP,
+  // иначе на 1 гц явный Эйлер с kp = 1.5 раскачивается
+  const size_t steps =
+      std::max<size_t>(1, static_cast<size_t>(std::ceil(period / MAX_STEP)));
+  const double dt = period / static_cast<double>(steps);
+  for (size_t i = 0; i < steps; ++i) {
+    step(setpoint, dt);
+  }
+
+  double value = m_value;
+  switch (m_parameters.noise) {
+  case PlantParameters::Noise::Gaussian:
+    value += std::normal_distribution<double>(
+        0.0, m_parameters.noiseAmplitude)(m_random);
+    break;
+  case PlantParameters::Noise::Uniform:
+    value += std::uniform_real_distribution<double>(
+        -m_parameters.noiseAmplitude, m_parameters.noiseAmplitude)(m_random);
+    break;
+  case PlantParameters::Noise::None:
+    break;
+  }
+
+  if (m_parameters.outlierFrequency > 0.0) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    if (m_outlierRemaining <= 0.0 &&
+        unit(m_random) < m_parameters.outlierFrequency * period) {
+      m_outlierRemaining =
+          0.001 + unit(m_random) *
+                      std::max(0.0, m_parameters.outlierMaxDuration - 0.001);
+      m_outlierValue = (unit(m_random) * 2.0 - 1.0) *
+                       m_parameters.outlierAmplitude;
+    }
+    if (m_outlierRemaining > 0.0) {
+      value += m_outlierValue;
+      m_outlierRemaining -= period;
+    }
+  }
+  return static_cast<float>(value);
+}
+
+void PlantModel::step(double setpoint, double dt) {
+  const double error = setpoint - m_value;
+  m_integral = std::clamp(m_integral + error * dt, -m_parameters.integralLimit,
+                          m_parameters.integralLimit);
+  const double derivative = (error - m_previousError) / dt;
+  m_previousError = error;
+
+  const double correction = m_parameters.kp * error +
+                            m_parameters.ki * m_integral +
+                            m_parameters.kd * derivative;
+  m_value += correction * dt;
+}
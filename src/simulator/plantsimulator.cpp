@@ -0,0 +1,377 @@
+#include "../../include/simulator/plantsimulator.h"
+#include "../../include/core/datapoint.h"
+#include "../../include/core/keyvalue.h"
+#include "../../include/network/protocolparser.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+#ifdef _WIN32
+const SocketHandle NO_SOCKET = INVALID_SOCKET;
+#else
+const SocketHandle NO_SOCKET = -1;
+#endif
+
+bool makeAddress(const std::string &ip, uint16_t port, sockaddr_in &addr) {
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = inet_addr(ip.c_str());
+  return addr.sin_addr.s_addr != INADDR_NONE;
+}
+
+SocketHandle openSocket() {
+#ifdef _WIN32
+  static bool winsockInitialized = false;
+  if (!winsockInitialized) {
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+      return NO_SOCKET;
+    }
+    winsockInitialized = true;
+  }
+  return socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#else
+  return socket(AF_INET, SOCK_DGRAM, 0);
+#endif
+}
+
+void closeSocketHandle(SocketHandle &handle) {
+  if (handle == NO_SOCKET) {
+    return;
+  }
+#ifdef _WIN32
+  closesocket(handle);
+#else
+  close(handle);
+#endif
+  handle = NO_SOCKET;
+}
+
+// спать до deadline - SPIN_MARGIN, остаток дождаться активно
+void waitUntil(Clock::time_point deadline) {
+  const auto margin = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(PlantSimulator::SPIN_MARGIN_SECONDS));
+  if (Clock::now() < deadline - margin) {
+    std::this_thread::sleep_until(deadline - margin);
+  }
+  while (Clock::now() < deadline) {
+  }
+}
+
+} // namespace
+
+void SimulatorConfig::set(const std::string &key, const std::string &value) {
+  using namespace KeyValue;
+
+  if (key == "command_ip") {
+    commandIp = value;
+  } else if (key == "command_port") {
+    commandPort = static_cast<uint16_t>(parseUnsigned(key, value, 1, 65535));
+  } else if (key == "data_ip") {
+    dataIp = value;
+  } else if (key == "data_port") {
+    dataPort = static_cast<uint16_t>(parseUnsigned(key, value, 1, 65535));
+  } else if (key == "rate_hz") {
+    rateHz = parseNumber(key, value, 1.0, 100000.0);
+  } else if (key == "batch") {
+    batch = parseUnsigned(key, value, 0,
+                         Constants::Network::MAX_SAMPLES_PER_PACKET);
+  } else if (key == "format") {
+    if (value != "v2" && value != "legacy") {
+      throw std::invalid_argument(key + ": expected v2 or legacy");
+    }
+    legacyFormat = value == "legacy";
+  } else if (key == "channel") {
+    channel = static_cast<uint8_t>(parseUnsigned(key, value, 0, 255));
+  } else if (key == "setpoint") {
+    setpoint = parseNumber(key, value, -1e6, 1e6);
+  } else if (key == "kp") {
+    plant.kp = parseNumber(key, value, 0.0, 1e6);
+  } else if (key == "ki") {
+    plant.ki = parseNumber(key, value, 0.0, 1e6);
+  } else if (key == "kd") {
+    plant.kd = parseNumber(key, value, 0.0, 1e6);
+  } else if (key == "noise") {
+    if (value == "gaussian") {
+      plant.noise = PlantParameters::Noise::Gaussian;
+    } else if (value == "uniform") {
+      plant.noise = PlantParameters::Noise::Uniform;
+    } else if (value == "none") {
+      plant.noise = PlantParameters::Noise::None;
+    } else {
+      throw std::invalid_argument(key + ": expected gaussian, uniform or none");
+    }
+  } else if (key == "noise_amplitude") {
+    plant.noiseAmplitude = parseNumber(key, value, 0.0, 1e6);
+  } else if (key == "outlier_frequency_hz") {
+    plant.outlierFrequency = parseNumber(key, value, 0.0, 1e6);
+  } else if (key == "outlier_max_duration_s") {
+    plant.outlierMaxDuration = parseNumber(key, value, 0.0, 3600.0);
+  } else if (key == "outlier_amplitude") {
+    plant.outlierAmplitude = parseNumber(key, value, 0.0, 1e6);
+  } else if (key == "seed") {
+    plant.seed =
+        static_cast<uint32_t>(parseUnsigned(key, value, 0, UINT32_MAX));
+  } else if (key == "loss") {
+    impairment.loss = parseNumber(key, value, 0.0, 1.0);
+  } else if (key == "burst_enter") {
+    impairment.burstEnter = parseNumber(key, value, 0.0, 1.0);
+  } else if (key == "burst_exit") {
+    impairment.burstExit = parseNumber(key, value, 0.0, 1.0);
+  } else if (key == "burst_loss") {
+    impairment.burstLoss = parseNumber(key, value, 0.0, 1.0);
+  } else if (key == "reorder") {
+    impairment.reorder = parseNumber(key, value, 0.0, 1.0);
+  } else if (key == "reorder_depth") {
+    impairment.reorderDepth = parseUnsigned(key, value, 1, 512);
+  } else if (key == "jitter_ms") {
+    impairment.jitterMs = parseNumber(key, value, 0.0, 10000.0);
+  } else if (key == "duplicate") {
+    impairment.duplicate = parseNumber(key, value, 0.0, 1.0);
+  } else if (key == "impairment_seed") {
+    impairment.seed =
+        static_cast<uint32_t>(parseUnsigned(key, value, 0, UINT32_MAX));
+  } else {
+    throw std::invalid_argument("unknown key " + key);
+  }
+}
+
+size_t SimulatorConfig::samplesPerPacket() const {
+  if (legacyFormat) {
+    return 1;
+  }
+  if (batch > 0) {
+    return batch;
+  }
+  const size_t perMillisecond = static_cast<size_t>(std::ceil(rateHz / 1000));
+  return std::clamp<size_t>(perMillisecond, 1,
+                            Constants::Network::MAX_SAMPLES_PER_PACKET);
+}
+
+PlantSimulator::PlantSimulator(const SimulatorConfig &config)
+    : m_config(config), m_running(false), m_setpoint(config.setpoint),
+      m_dataSocket(NO_SOCKET), m_commandSocket(NO_SOCKET), m_packetsSent(0),
+      m_samplesSent(0), m_sendErrors(0), m_commandsReceived(0), m_resyncs(0),
+      m_maxLatenessNs(0) {}
+
+PlantSimulator::~PlantSimulator() { stop(); }
+
+bool PlantSimulator::start() {
+  if (m_running.load()) {
+    return true;
+  }
+
+  sockaddr_in commandAddr;
+  sockaddr_in dataAddr;
+  if (!makeAddress(m_config.commandIp, m_config.commandPort, commandAddr) ||
+      !makeAddress(m_config.dataIp, m_config.dataPort, dataAddr)) {
+    return false;
+  }
+
+  m_dataSocket = openSocket();
+  m_commandSocket = openSocket();
+  if (m_dataSocket == NO_SOCKET || m_commandSocket == NO_SOCKET) {
+    closeSocketHandle(m_dataSocket);
+    closeSocketHandle(m_commandSocket);
+    return false;
+  }
+
+  // таймаут приема команд, чтобы поток замечал остановку
+#ifdef _WIN32
+  DWORD timeoutMs = Constants::Network::SOCKET_TIMEOUT_MS;
+  setsockopt(m_commandSocket, SOL_SOCKET, SO_RCVTIMEO,
+             reinterpret_cast<const char *>(&timeoutMs), sizeof(timeoutMs));
+#else
+  struct timeval timeout;
+  timeout.tv_sec = 0;
+  timeout.tv_usec = Constants::Network::SOCKET_TIMEOUT_MS * 1000;
+  setsockopt(m_commandSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+             sizeof(timeout));
+#endif
+  if (bind(m_commandSocket, reinterpret_cast<sockaddr *>(&commandAddr),
+           sizeof(commandAddr)) < 0 ||
+      connect(m_dataSocket, reinterpret_cast<sockaddr *>(&dataAddr),
+              sizeof(dataAddr)) < 0) {
+    closeSocketHandle(m_dataSocket);
+    closeSocketHandle(m_commandSocket);
+    return false;
+  }
+
+  m_running.store(true);
+  m_paceThread = std::thread(&PlantSimulator::paceLoop, this);
+  m_commandThread = std::thread(&PlantSimulator::commandLoop, this);
+  return true;
+}
+
+void PlantSimulator::stop() {
+  m_running.store(false);
+  if (m_paceThread.joinable()) {
+    m_paceThread.join();
+  }
+  if (m_commandThread.joinable()) {
+    m_commandThread.join();
+  }
+  closeSocketHandle(m_dataSocket);
+  closeSocketHandle(m_commandSocket);
+}
+
+SimulatorStatistics PlantSimulator::getStatistics() {
+  SimulatorStatistics stats;
+  stats.packetsSent = m_packetsSent.load();
+  stats.samplesSent = m_samplesSent.load();
+  stats.sendErrors = m_sendErrors.load();
+  stats.commandsReceived = m_commandsReceived.load();
+  stats.resyncs = m_resyncs.load();
+  stats.maxLatenessUs = m_maxLatenessNs.exchange(0) / 1000.0;
+  stats.setpoint = m_setpoint.load();
+  std::lock_guard<std::mutex> lock(m_impairmentMutex);
+  stats.impairment = m_impairmentStats;
+  return stats;
+}
+
+void PlantSimulator::paceLoop() {
+  const size_t perPacket = m_config.samplesPerPacket();
+  const double period = 1.0 / m_config.rateHz;
+  const uint64_t rateMilli =
+      static_cast<uint64_t>(std::llround(m_config.rateHz * 1000.0));
+
+  PlantModel model(m_config.plant);
+  std::vector<DataPoint> points(perPacket);
+  uint32_t sequence = 0;
+  uint64_t sample = 0; // номер следующего отсчета
+
+  const bool impaired = m_config.impairment.enabled();
+  NetworkImpairment impairment(m_config.impairment);
+  const auto send = [this](const std::vector<uint8_t> &packet) {
+    sendPacket(packet);
+  };
+
+  // расписание: отсчет scheduleBase уходит в момент scheduleStart
+  Clock::time_point scheduleStart = Clock::now();
+  uint64_t scheduleBase = 0;
+
+  while (m_running.load(std::memory_order_relaxed)) {
+    const Clock::time_point deadline =
+        scheduleStart + std::chrono::duration_cast<Clock::duration>(
+                            std::chrono::duration<double>(
+                                (sample + perPacket - scheduleBase) * period));
+
+    // пока ждем следующий пакет, задержанные уходят в свой срок
+    while (impaired && impairment.nextDue() < deadline &&
+           m_running.load(std::memory_order_relaxed)) {
+      waitUntil(impairment.nextDue());
+      impairment.release(Clock::now(), send);
+    }
+    waitUntil(deadline);
+
+    const double lateness =
+        std::chrono::duration<double>(Clock::now() - deadline).count();
+    if (lateness > MAX_LAG_SECONDS) {
+      ++m_resyncs;
+      scheduleStart = Clock::now();
+      scheduleBase = sample + perPacket;
+    }
+    const uint64_t latenessNs = static_cast<uint64_t>(lateness * 1e9);
+    if (latenessNs > m_maxLatenessNs.load(std::memory_order_relaxed)) {
+      m_maxLatenessNs.store(latenessNs, std::memory_order_relaxed);
+    }
+
+    const double setpoint = m_setpoint.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < perPacket; ++i, ++sample) {
+      // время модели в мс без накопления ошибки: sample * 1000 / rate
+      points[i].timestamp =
+          static_cast<uint32_t>(sample * 1000000 / rateMilli);
+      points[i].value = model.sample(setpoint, period);
+    }
+
+    std::vector<uint8_t> packet;
+    if (m_config.legacyFormat) {
+      packet.resize(Constants::Network::DATA_PACKET_SIZE);
+      std::memcpy(packet.data(), &points[0].timestamp, 4);
+      std::memcpy(packet.data() + 4, &points[0].value, 4);
+    } else {
+      packet = ProtocolParser::createDataPacket(m_config.channel, sequence++,
+                                                points.data(), perPacket);
+    }
+
+    if (!impaired) {
+      sendPacket(packet);
+      continue;
+    }
+    impairment.submit(std::move(packet), Clock::now());
+    impairment.release(Clock::now(), send);
+    std::lock_guard<std::mutex> lock(m_impairmentMutex);
+    m_impairmentStats = impairment.getStatistics();
+  }
+
+  if (impaired) {
+    impairment.flush(send);
+    std::lock_guard<std::mutex> lock(m_impairmentMutex);
+    m_impairmentStats = impairment.getStatistics();
+  }
+}
+
+void PlantSimulator::sendPacket(const std::vector<uint8_t> &packet) {
+#ifdef _WIN32
+  int sent = send(m_dataSocket, reinterpret_cast<const char *>(packet.data()),
+                  static_cast<int>(packet.size()), 0);
+#else
+  ssize_t sent = send(m_dataSocket, packet.data(), packet.size(), 0);
+#endif
+  if (sent != static_cast<decltype(sent)>(packet.size())) {
+    // ECONNREFUSED, пока визуализатор не слушает, - не ошибка модели
+    ++m_sendErrors;
+    return;
+  }
+
+  ++m_packetsSent;
+  if (packet.size() == Constants::Network::DATA_PACKET_SIZE) {
+    ++m_samplesSent;
+  } else {
+    m_samplesSent += (packet.size() -
+                      Constants::Network::DATA_PACKET_V2_HEADER_SIZE) /
+                     Constants::Network::DATA_PACKET_V2_SAMPLE_SIZE;
+  }
+}
+
+void PlantSimulator::commandLoop() {
+  uint8_t buffer[Constants::Network::UDP_BUFFER_SIZE];
+  while (m_running.load(std::memory_order_relaxed)) {
+#ifdef _WIN32
+    int received = recv(m_commandSocket, reinterpret_cast<char *>(buffer),
+                        sizeof(buffer), 0);
+#else
+    ssize_t received = recv(m_commandSocket, buffer, sizeof(buffer), 0);
+#endif
+    if (received <= 0 || !ProtocolParser::isValidCommandPacketSize(
+                             static_cast<size_t>(received))) {
+      continue;
+    }
+    const float setpoint = ProtocolParser::parseCommandPacket(
+        buffer, static_cast<size_t>(received));
+    m_setpoint.store(setpoint, std::memory_order_relaxed);
+    ++m_commandsReceived;
+  }
+}
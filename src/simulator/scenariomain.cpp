@@ -0,0 +1,53 @@
+/*
+ * pidscenario: сценарии искажений сети по loopback
+ *
+ * запуск: pidscenario <файл.scenario> [...]
+ *
+ * каждый сценарий прогоняет модель с искажениями через прием и фильтры
+ * (см. runScenario), печатает метрики и проваленные проверки. код
+ * возврата 1, если провалился хоть один сценарий
+ */
+
+#include "../../include/simulator/scenariorunner.h"
+
+#include <cstdio>
+#include <exception>
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: pidscenario <file.scenario> [...]\n");
+    return 2;
+  }
+
+  int failed = 0;
+  for (int i = 1; i < argc; ++i) {
+    try {
+      const Scenario scenario = Scenario::load(argv[i]);
+      std::printf("== %s (%.0f Hz, %zu samples/packet, %.1f s)\n",
+                  scenario.name.c_str(), scenario.simulator.rateHz,
+                  scenario.simulator.samplesPerPacket(),
+                  scenario.durationSeconds);
+      std::fflush(stdout);
+
+      const ScenarioResult result = runScenario(scenario);
+      for (const auto &metric : result.metrics) {
+        std::printf("   %-24s %.6g\n", metric.first.c_str(), metric.second);
+      }
+      for (const std::string &failure : result.failures) {
+        std::printf("   FAIL %s\n", failure.c_str());
+      }
+      std::printf("%s %s\n", result.passed() ? "PASS" : "FAIL",
+                  scenario.name.c_str());
+      if (!result.passed()) {
+        ++failed;
+      }
+    } catch (const std::exception &e) {
+      std::printf("FAIL %s: %s\n", argv[i], e.what());
+      ++failed;
+    }
+    std::fflush(stdout);
+  }
+
+  std::printf("%d of %d scenarios passed\n", argc - 1 - failed, argc - 1);
+  return failed == 0 ? 0 : 1;
+}
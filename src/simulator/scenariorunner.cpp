@@ -0,0 +1,252 @@
+#include "../../include/simulator/scenariorunner.h"
+#include "../../include/core/broadcastringbuffer.h"
+#include "../../include/core/datapoint.h"
+#include "../../include/core/keyvalue.h"
+#include "../../include/filters/exponentialfilter.h"
+#include "../../include/filters/kalmanfilter.h"
+#include "../../include/filters/medianfilter.h"
+#include "../../include/filters/movingaveragefilter.h"
+#include "../../include/network/networkcontroller.h"
+#include "../../include/processing/dataprocessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// после остановки источника: опоздавшие пакеты, таймаут сокета, после
+// которого UdpReceiver выпускает окно переупорядочивания
+constexpr std::chrono::milliseconds SETTLE_TIME(
+    Constants::Network::SOCKET_TIMEOUT_MS * 3);
+constexpr std::chrono::milliseconds POLL_INTERVAL(1);
+constexpr size_t BLOCK_SIZE = 4096;
+
+// "min..max" или одно значение
+ScenarioExpectation parseExpectation(const std::string &metric,
+                                     const std::string &value) {
+  using namespace KeyValue;
+
+  size_t range = value.find("..");
+  if (range == std::string::npos) {
+    double exact = parseNumber(metric, value);
+    return {metric, exact, exact};
+  }
+  return {metric, parseNumber(metric, trim(value.substr(0, range))),
+          parseNumber(metric, trim(value.substr(range + 2)))};
+}
+
+/**
+ * @brief читатель одного потока отсчетов с проверкой непрерывности
+ */
+struct Stream {
+  std::string name;
+  BroadcastRingBuffer<DataPoint>::Reader *reader;
+  uint64_t read = 0;
+  uint64_t backwardSteps = 0;
+  uint32_t maxGap = 0;
+  bool hasLast = false;
+  uint32_t last = 0;
+
+  void drain(std::vector<DataPoint> &block) {
+    for (;;) {
+      size_t count = reader->popBulk(block.data(), block.size());
+      if (count == 0) {
+        return;
+      }
+      for (size_t i = 0; i < count; ++i) {
+        const uint32_t timestamp = block[i].timestamp;
+        if (hasLast) {
+          if (timestamp < last) {
+            ++backwardSteps;
+          } else {
+            maxGap = std::max(maxGap, timestamp - last);
+          }
+        }
+        last = timestamp;
+        hasLast = true;
+      }
+      read += count;
+    }
+  }
+};
+
+double difference(uint64_t a, uint64_t b) {
+  return static_cast<double>(a > b ? a - b : b - a);
+}
+
+} // namespace
+
+Scenario::Scenario() {
+  simulator.dataPort = DEFAULT_DATA_PORT;
+  simulator.commandPort = DEFAULT_COMMAND_PORT;
+}
+
+Scenario Scenario::load(const std::string &path) {
+  using namespace KeyValue;
+
+  Scenario scenario;
+  size_t slash = path.find_last_of("/\\");
+  scenario.name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+  readFile(path, [&scenario](const std::string &key,
+                             const std::string &value) {
+    if (key == "name") {
+      scenario.name = value;
+    } else if (key == "duration_s") {
+      scenario.durationSeconds = parseNumber(key, value, 0.0, 1e9);
+    } else if (key == "reorder_window_ms") {
+      scenario.reorderWindowMs = static_cast<uint32_t>(parseUnsigned(
+          key, value, 0, Constants::Network::MAX_REORDER_WINDOW_MS));
+    } else if (key.compare(0, 7, "expect_") == 0) {
+      scenario.expectations.push_back(parseExpectation(key.substr(7), value));
+    } else {
+      scenario.simulator.set(key, value);
+    }
+  });
+  return scenario;
+}
+
+ScenarioResult runScenario(const Scenario &scenario) {
+  const SimulatorConfig &config = scenario.simulator;
+
+  // прием и фильтры - как в GUI и pidheadless
+  BroadcastRingBuffer<DataPoint> rawStream(Constants::RAW_STREAM_CAPACITY);
+  NetworkController network;
+  network.initialize(&rawStream, nullptr);
+  network.setReorderWindow(scenario.reorderWindowMs);
+
+  std::vector<std::unique_ptr<IFilter>> filters;
+  filters.push_back(std::make_unique<MovingAverageFilter>());
+  filters.push_back(std::make_unique<MedianFilter>());
+  filters.push_back(std::make_unique<ExponentialFilter>());
+  filters.push_back(std::make_unique<KalmanFilter>());
+  const char *names[] = {"MovingAverage", "Median", "Exponential", "Kalman"};
+
+  DataProcessor processor;
+  std::vector<Stream> streams;
+  std::vector<BroadcastRingBuffer<DataPoint>::Reader *> inputs;
+  streams.push_back({"Raw", rawStream.createReader()});
+  for (size_t i = 0; i < filters.size(); ++i) {
+    inputs.push_back(rawStream.createReader());
+    BroadcastRingBuffer<DataPoint> *output =
+        processor.addFilter(filters[i].get(), inputs.back(), names[i]);
+    streams.push_back({names[i], output->createReader()});
+  }
+
+  processor.start();
+  if (!network.startReceiver(config.dataIp, config.dataPort)) {
+    throw std::runtime_error("Failed to start receiver on port " +
+                             std::to_string(config.dataPort));
+  }
+  PlantSimulator simulator(config);
+  if (!simulator.start()) {
+    network.stopReceiver();
+    throw std::runtime_error("Failed to start simulator on port " +
+                             std::to_string(config.commandPort));
+  }
+
+  std::vector<DataPoint> block(BLOCK_SIZE);
+  const auto drainAll = [&] {
+    for (Stream &stream : streams) {
+      stream.drain(block);
+    }
+  };
+
+  const Clock::time_point started = Clock::now();
+  const auto duration = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(scenario.durationSeconds));
+  while (Clock::now() - started < duration) {
+    std::this_thread::sleep_for(POLL_INTERVAL);
+    drainAll();
+  }
+  const double elapsed =
+      std::chrono::duration<double>(Clock::now() - started).count();
+
+  // источник отдает задержанные пакеты, прием выпускает окно, фильтры
+  // дочитывают свои входы
+  simulator.stop();
+  const Clock::time_point settleUntil = Clock::now() + SETTLE_TIME;
+  while (Clock::now() < settleUntil) {
+    std::this_thread::sleep_for(POLL_INTERVAL);
+    drainAll();
+  }
+  network.stopReceiver();
+  while (std::any_of(inputs.begin(), inputs.end(),
+                     [](BroadcastRingBuffer<DataPoint>::Reader *input) {
+                       return input->size() > 0;
+                     })) {
+    std::this_thread::sleep_for(POLL_INTERVAL);
+    drainAll();
+  }
+  processor.stop();
+  drainAll();
+
+  const SimulatorStatistics sent = simulator.getStatistics();
+  const ReceiverStatistics received = network.getReceiverStatistics();
+  const uint64_t sourcePackets = config.impairment.enabled()
+                                     ? sent.impairment.submitted
+                                     : sent.packetsSent;
+
+  ScenarioResult result;
+  std::map<std::string, double> &m = result.metrics;
+  m["source_packets"] = static_cast<double>(sourcePackets);
+  m["packets_sent"] = static_cast<double>(sent.packetsSent);
+  m["packet_rate"] = sourcePackets / elapsed;
+  m["dropped"] = static_cast<double>(sent.impairment.dropped);
+  m["injected_duplicates"] = static_cast<double>(sent.impairment.duplicated);
+  m["injected_reorders"] = static_cast<double>(sent.impairment.reordered);
+  m["packets_received"] = static_cast<double>(received.packetsReceived);
+  m["lost"] = static_cast<double>(received.lost);
+  m["reordered"] = static_cast<double>(received.reordered);
+  m["duplicated"] = static_cast<double>(received.duplicated);
+  m["gap_events"] = static_cast<double>(received.gapEvents);
+  m["late"] = static_cast<double>(received.lateDropped);
+  m["network_lost"] = difference(sent.packetsSent, received.packetsReceived);
+  m["lost_mismatch"] = difference(received.lost, sent.impairment.dropped);
+  m["duplicate_mismatch"] =
+      difference(received.duplicated, sent.impairment.duplicated);
+  m["loss_share"] =
+      sourcePackets > 0 ? static_cast<double>(received.lost) / sourcePackets
+                        : 0.0;
+  m["samples_published"] = static_cast<double>(received.samplesReceived);
+  m["max_gap_ms"] = static_cast<double>(streams.front().maxGap);
+
+  uint64_t backward = 0;
+  uint64_t outputSkipped = 0;
+  for (const Stream &stream : streams) {
+    backward += stream.backwardSteps;
+    outputSkipped += stream.reader->getSkipped();
+  }
+  uint64_t inputSkipped = 0;
+  for (BroadcastRingBuffer<DataPoint>::Reader *input : inputs) {
+    inputSkipped += input->getSkipped();
+  }
+  m["backward_steps"] = static_cast<double>(backward);
+  m["filter_input_skipped"] = static_cast<double>(inputSkipped);
+  m["filter_output_skipped"] = static_cast<double>(outputSkipped);
+
+  // непрерывность выхода фильтров проверяется всегда
+  std::vector<ScenarioExpectation> checks = {
+      {"backward_steps", 0, 0},
+      {"filter_input_skipped", 0, 0},
+      {"filter_output_skipped", 0, 0}};
+  checks.insert(checks.end(), scenario.expectations.begin(),
+                scenario.expectations.end());
+  for (const ScenarioExpectation &check : checks) {
+    auto found = m.find(check.metric);
+    if (found == m.end()) {
+      result.failures.push_back("unknown metric " + check.metric);
+    } else if (!(found->second >= check.min && found->second <= check.max)) {
+      result.failures.push_back(
+          check.metric + " = " + std::to_string(found->second) +
+          ", expected " + std::to_string(check.min) + ".." +
+          std::to_string(check.max));
+    }
+  }
+  return result;
+}
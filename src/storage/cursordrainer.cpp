@@ -0,0 +1,128 @@
+#include "../../include/storage/cursordrainer.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+// сколько отсчетов забирать из курсора за один popBulk
+constexpr size_t DRAIN_BLOCK_SIZE = 4096;
+} // namespace
+
+CursorDrainer::CursorDrainer(std::chrono::milliseconds period)
+    : m_period(period), m_block(DRAIN_BLOCK_SIZE), m_running(false),
+      m_failed(false) {
+  if (m_period.count() <= 0) {
+    throw std::invalid_argument("Drain period must be positive");
+  }
+}
+
+CursorDrainer::~CursorDrainer() { stop(); }
+
+size_t CursorDrainer::addReader(IBufferReader<DataPoint> *reader) {
+  if (!reader) {
+    throw std::invalid_argument("Series reader cannot be nullptr");
+  }
+  if (m_running.load()) {
+    throw std::runtime_error("Cannot add series reader while running");
+  }
+
+  m_readers.push_back(reader);
+  return m_readers.size() - 1;
+}
+
+void CursorDrainer::start(Consumer consume,
+                          std::function<void(size_t series)> seriesDone,
+                          std::function<void()> finish) {
+  if (m_running.load()) {
+    return;
+  }
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  // то, что накопилось в курсоре до старта, к новой сессии не относится
+  for (IBufferReader<DataPoint> *reader : m_readers) {
+    while (reader->popBulk(m_block.data(), m_block.size()) > 0) {
+    }
+  }
+
+  m_consume = std::move(consume);
+  m_seriesDone = std::move(seriesDone);
+  m_finish = std::move(finish);
+  m_failed.store(false);
+
+  m_running.store(true);
+  m_thread = std::thread(&CursorDrainer::run, this);
+}
+
+void CursorDrainer::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_stopMutex);
+    if (!m_running.load()) {
+      return;
+    }
+    m_running.store(false);
+  }
+  m_stopCondition.notify_all();
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+bool CursorDrainer::isRunning() const { return m_running.load(); }
+
+bool CursorDrainer::hasFailed() const { return m_failed.load(); }
+
+void CursorDrainer::run() {
+  // run() выполняется в отдельном потоке
+  auto next = std::chrono::steady_clock::now() + m_period;
+
+  try {
+    while (m_running.load()) {
+      {
+        std::unique_lock<std::mutex> lock(m_stopMutex);
+        m_stopCondition.wait_until(lock, next,
+                                   [this] { return !m_running.load(); });
+      }
+      next += m_period;
+
+      // не догоняем пропущенные периоды, если обработка затянулась
+      auto now = std::chrono::steady_clock::now();
+      if (next < now) {
+        next = now + m_period;
+      }
+
+      // после stop() дописываем то, что успело прийти
+      for (size_t i = 0; i < m_readers.size(); ++i) {
+        drain(i);
+      }
+    }
+
+    if (m_finish) {
+      m_finish();
+    }
+  } catch (...) {
+    m_failed.store(true);
+  }
+}
+
+void CursorDrainer::drain(size_t series) {
+  IBufferReader<DataPoint> *reader = m_readers[series];
+
+  // не больше одного буфера за раз, чтобы быстрый писатель не задержал
+  // остальные серии
+  size_t budget = reader->capacity();
+  while (budget > 0) {
+    size_t count =
+        reader->popBulk(m_block.data(), std::min(budget, m_block.size()));
+    if (count == 0) {
+      break;
+    }
+    m_consume(series, m_block.data(), count);
+    budget -= count;
+  }
+
+  if (m_seriesDone) {
+    m_seriesDone(series);
+  }
+}
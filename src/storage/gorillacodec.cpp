@@ -0,0 +1,295 @@
+#include "../../include/storage/gorillacodec.h"
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+// окно "нет окна": ни один ненулевой XOR в него не помещается
+constexpr unsigned NO_WINDOW = 32;
+// новое окно стоит 2 + 5 + 5 бит против 2 у старого: берем его, только
+// если старое шире нового больше чем на эту разницу
+constexpr unsigned WINDOW_HEADER_BITS = 10;
+
+uint32_t floatBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+float bitsFloat(uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// редкие ошибки вынесены из горячих функций чтения, чтобы те встраивались
+[[noreturn]] void throwTruncated() {
+  throw std::runtime_error("Compressed block is truncated");
+}
+
+/**
+ * @brief чтение битов блока от старших
+ *
+ * живет в локальной переменной цикла декодирования: так компилятор держит
+ * его в регистрах, а не перечитывает поля после каждой записи отсчета
+ */
+struct BitReader {
+  const uint8_t *data;
+  const uint8_t *end;
+  uint64_t accumulator; // непрочитанные биты, выровнены к старшему
+  unsigned available;
+
+  // дополнить аккумулятор до 57+ бит (или до конца блока)
+  void refill() {
+    if (available > 56) {
+      return;
+    }
+    if (end - data >= 8) {
+      // восемь байт разом: лишние младшие биты совпадают с битами потока,
+      // следующая подкачка положит на их место те же биты
+      uint64_t word = 0;
+      for (int i = 0; i < 8; ++i) {
+        word = (word << 8) | data[i];
+      }
+      accumulator |= word >> available;
+      const unsigned bytes = (63 - available) >> 3;
+      data += bytes;
+      available += bytes * 8;
+      return;
+    }
+    while (available <= 56 && data < end) {
+      accumulator |= static_cast<uint64_t>(*data++) << (56 - available);
+      available += 8;
+    }
+  }
+
+  // подкачка - забота вызывающего, здесь только проверка конца блока
+  uint32_t read(unsigned bits) {
+    if (available < bits) {
+      throwTruncated();
+    }
+    if (bits == 0) {
+      return 0;
+    }
+    const uint32_t value = static_cast<uint32_t>(accumulator >> (64 - bits));
+    accumulator <<= bits;
+    available -= bits;
+    return value;
+  }
+
+  bool readBit() { return read(1) != 0; }
+};
+
+// x != 0
+unsigned leadingZeros(uint32_t x) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanReverse(&index, x);
+  return 31u - static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_clz(x));
+#endif
+}
+
+// x != 0
+unsigned trailingZeros(uint32_t x) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, x);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(x));
+#endif
+}
+} // namespace
+
+GorillaEncoder::GorillaEncoder() { reset(); }
+
+void GorillaEncoder::reset() {
+  m_bytes.clear();
+  m_accumulator = 0;
+  m_pending = 0;
+  m_count = 0;
+  m_lastTimestamp = 0;
+  m_lastDelta = 0;
+  m_lastValue = 0;
+  m_leading = NO_WINDOW;
+  m_trailing = 0;
+}
+
+void GorillaEncoder::append(const DataPoint &point) {
+  const uint32_t value = floatBits(point.value);
+
+  if (m_count++ == 0) {
+    writeBits(point.timestamp, 32);
+    writeBits(value, 32);
+    m_lastTimestamp = point.timestamp;
+    m_lastValue = value;
+    return;
+  }
+
+  // время: разность второго порядка, при ровном шаге - ноль
+  const uint32_t delta = point.timestamp - m_lastTimestamp;
+  const int32_t dod = static_cast<int32_t>(delta - m_lastDelta);
+  if (dod == 0) {
+    writeBits(0, 1);
+  } else if (dod >= -63 && dod <= 64) {
+    writeBits((0x2u << 7) | static_cast<uint32_t>(dod + 63), 2 + 7);
+  } else if (dod >= -255 && dod <= 256) {
+    writeBits((0x6u << 9) | static_cast<uint32_t>(dod + 255), 3 + 9);
+  } else if (dod >= -2047 && dod <= 2048) {
+    writeBits((0xEu << 12) | static_cast<uint32_t>(dod + 2047), 4 + 12);
+  } else {
+    writeBits((uint64_t(0xF) << 32) | static_cast<uint32_t>(dod), 4 + 32);
+  }
+  m_lastTimestamp = point.timestamp;
+  m_lastDelta = delta;
+
+  // значение: XOR с предыдущим
+  const uint32_t x = value ^ m_lastValue;
+  m_lastValue = value;
+  if (x == 0) {
+    writeBits(0, 1);
+    return;
+  }
+
+  const unsigned leading = leadingZeros(x);
+  const unsigned trailing = trailingZeros(x);
+  const unsigned meaningful = 32 - leading - trailing;
+  if (m_leading != NO_WINDOW && leading >= m_leading &&
+      trailing >= m_trailing &&
+      32 - m_leading - m_trailing <= meaningful + WINDOW_HEADER_BITS) {
+    // значащие биты помещаются в окно прошлого XOR
+    const unsigned window = 32 - m_leading - m_trailing;
+    writeBits((uint64_t(0x2) << window) | (x >> m_trailing), 2 + window);
+    return;
+  }
+
+  writeBits((0x3u << 10) | (leading << 5) | (meaningful - 1), 2 + 5 + 5);
+  writeBits(x >> trailing, meaningful);
+  m_leading = leading;
+  m_trailing = trailing;
+}
+
+void GorillaEncoder::append(const DataPoint *points, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    append(points[i]);
+  }
+}
+
+size_t GorillaEncoder::count() const { return m_count; }
+
+const std::vector<uint8_t> &GorillaEncoder::finish() {
+  if (m_pending > 0) {
+    writeBits(0, 8 - m_pending);
+  }
+  return m_bytes;
+}
+
+void GorillaEncoder::encode(const DataPoint *points, size_t count,
+                            std::vector<uint8_t> &out) {
+  GorillaEncoder encoder;
+  encoder.m_bytes.swap(out);
+  encoder.reset();
+  encoder.append(points, count);
+  encoder.finish();
+  out.swap(encoder.m_bytes);
+}
+
+void GorillaEncoder::writeBits(uint64_t value, unsigned bits) {
+  // до записи в аккумуляторе меньше байта, за раз пишется не больше 36
+  // бит, так что 64 бит хватает
+  m_accumulator = (m_accumulator << bits) | value;
+  m_pending += bits;
+  while (m_pending >= 8) {
+    m_pending -= 8;
+    m_bytes.push_back(static_cast<uint8_t>(m_accumulator >> m_pending));
+  }
+}
+
+GorillaDecoder::GorillaDecoder(const uint8_t *data, size_t size, size_t count)
+    : m_data(data), m_end(data + size), m_accumulator(0), m_available(0),
+      m_remaining(count), m_started(false), m_lastTimestamp(0),
+      m_lastDelta(0), m_lastValue(0), m_leading(0), m_trailing(0) {
+  if (!data && size > 0) {
+    throw std::invalid_argument("Compressed block data cannot be nullptr");
+  }
+}
+
+size_t GorillaDecoder::remaining() const { return m_remaining; }
+
+size_t GorillaDecoder::decode(DataPoint *out, size_t maxCount) {
+  const size_t count = maxCount < m_remaining ? maxCount : m_remaining;
+  BitReader bits = {m_data, m_end, m_accumulator, m_available};
+  uint32_t timestamp = m_lastTimestamp;
+  uint32_t delta = m_lastDelta;
+  uint32_t value = m_lastValue;
+  unsigned leading = m_leading;
+  unsigned trailing = m_trailing;
+  size_t i = 0;
+
+  if (count > 0 && !m_started) {
+    bits.refill();
+    timestamp = bits.read(32);
+    bits.refill();
+    value = bits.read(32);
+    out[i++] = DataPoint(timestamp, bitsFloat(value));
+    m_started = true;
+  }
+
+  // на отсчет уходит не больше 36 бит времени и 44 бит значения: перед
+  // каждой половиной в аккумуляторе подкачано не меньше 57 бит (или весь
+  // остаток блока)
+  for (; i < count; ++i) {
+    bits.refill();
+    uint32_t dod = 0;
+    if (bits.readBit()) {
+      if (!bits.readBit()) {
+        dod = bits.read(7) - 63u;
+      } else if (!bits.readBit()) {
+        dod = bits.read(9) - 255u;
+      } else if (!bits.readBit()) {
+        dod = bits.read(12) - 2047u;
+      } else {
+        dod = bits.read(32);
+      }
+    }
+    delta += dod;
+    timestamp += delta;
+
+    bits.refill();
+    if (bits.readBit()) {
+      if (bits.readBit()) {
+        leading = bits.read(5);
+        const unsigned meaningful = bits.read(5) + 1;
+        if (leading + meaningful > 32) {
+          throw std::runtime_error("Compressed block is corrupted");
+        }
+        trailing = 32 - leading - meaningful;
+      }
+      value ^= bits.read(32 - leading - trailing) << trailing;
+    }
+
+    out[i] = DataPoint(timestamp, bitsFloat(value));
+  }
+
+  m_data = bits.data;
+  m_accumulator = bits.accumulator;
+  m_available = bits.available;
+  m_lastTimestamp = timestamp;
+  m_lastDelta = delta;
+  m_lastValue = value;
+  m_leading = leading;
+  m_trailing = trailing;
+  m_remaining -= count;
+  return count;
+}
+
+void GorillaDecoder::decode(const uint8_t *data, size_t size, size_t count,
+                            DataPoint *out) {
+  GorillaDecoder decoder(data, size, count);
+  decoder.decode(out, count);
+}
@@ -0,0 +1,487 @@
+#include "../../include/storage/historystore.h"
+#include "../../include/core/Constants.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+// "PIDH" - метка файла-чанка истории
+constexpr uint32_t CHUNK_MAGIC = 0x48444950;
+constexpr const char *CHUNK_EXTENSION = ".chunk";
+} // namespace
+
+constexpr size_t HistoryStore::CHUNK_SAMPLES;
+constexpr size_t HistoryStore::SUMMARY_BLOCK;
+constexpr size_t HistoryStore::MAX_MAPPED_CHUNKS;
+
+namespace {
+constexpr size_t SAMPLES_OFFSET = 16; // sizeof(ChunkHeader)
+constexpr size_t BLOCKS_OFFSET =
+    SAMPLES_OFFSET + HistoryStore::CHUNK_SAMPLES * sizeof(DataPoint);
+constexpr size_t BLOCK_COUNT =
+    HistoryStore::CHUNK_SAMPLES / HistoryStore::SUMMARY_BLOCK;
+} // namespace
+
+HistoryStore::HistoryStore(const std::string &directory,
+                           std::chrono::milliseconds period)
+    : m_directory(directory), m_useCounter(0), m_drainer(period),
+      m_writtenSamples(0), m_droppedSamples(0), m_diskUsage(0) {
+  static_assert(sizeof(ChunkHeader) == SAMPLES_OFFSET,
+                "Chunk header layout changed");
+  static_assert(CHUNK_SAMPLES % SUMMARY_BLOCK == 0,
+                "Chunk must hold whole summary blocks");
+  if (m_directory.empty()) {
+    throw std::invalid_argument("History directory cannot be empty");
+  }
+}
+
+HistoryStore::~HistoryStore() { stop(); }
+
+size_t HistoryStore::addSeries(const std::string &name,
+                               IBufferReader<DataPoint> *reader) {
+  m_drainer.addReader(reader);
+
+  SeriesState state;
+  state.name = name;
+  state.current = ChunkInfo();
+  state.block = Summary();
+  state.nextFileNumber = 0;
+  state.lastKey = 0;
+  state.hasLast = false;
+  state.hasCurrent = false;
+  m_series.push_back(std::move(state));
+  return m_series.size() - 1;
+}
+
+int HistoryStore::findSeries(const std::string &name) const {
+  for (size_t i = 0; i < m_series.size(); ++i) {
+    if (m_series[i].name == name) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void HistoryStore::start() {
+  if (m_drainer.isRunning()) {
+    return;
+  }
+
+  // отображения прошлой сессии снимаются до удаления ее файлов
+  m_mapped.clear();
+  removeChunkFiles();
+
+  {
+    std::lock_guard<std::mutex> lock(m_indexMutex);
+    for (SeriesState &state : m_series) {
+      state.chunks.clear();
+    }
+  }
+
+  for (SeriesState &state : m_series) {
+    state.writeFile.close();
+    state.hasCurrent = false;
+    state.hasLast = false;
+    state.nextFileNumber = 0;
+  }
+
+  m_writtenSamples.store(0);
+  m_droppedSamples.store(0);
+  m_diskUsage.store(0);
+
+  // не создался или не отобразился чанк: поток останавливается, уже
+  // записанное остается доступным
+  m_drainer.start(
+      [this](size_t series, const DataPoint *points, size_t count) {
+        consume(series, points, count);
+      },
+      [this](size_t series) { publish(m_series[series]); }, nullptr);
+}
+
+void HistoryStore::stop() {
+  if (!m_drainer.isRunning()) {
+    return;
+  }
+  m_drainer.stop();
+
+  for (SeriesState &state : m_series) {
+    state.writeFile.flush();
+    state.writeFile.close();
+    state.hasCurrent = false;
+  }
+}
+
+bool HistoryStore::isRunning() const { return m_drainer.isRunning(); }
+
+bool HistoryStore::keyRange(size_t series, double &firstKey,
+                            double &lastKey) const {
+  if (series >= m_series.size()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_indexMutex);
+  const std::vector<ChunkInfo> &chunks = m_series[series].chunks;
+  if (chunks.empty() || chunks.front().count == 0) {
+    return false;
+  }
+  firstKey = chunks.front().firstKey;
+  lastKey = chunks.back().lastKey;
+  return true;
+}
+
+size_t HistoryStore::query(size_t series, double keyLower, double keyUpper,
+                           size_t columns, double *outKeys,
+                           double *outValues) {
+  if (series >= m_series.size() || columns == 0) {
+    return 0;
+  }
+
+  // снимок оглавления: дальше поток записи только дописывает за его
+  // пределами, так что отсчеты снимка читаются без блокировки
+  QueryView &view = m_view;
+  view.series = series;
+  {
+    std::lock_guard<std::mutex> lock(m_indexMutex);
+    view.chunks = m_series[series].chunks;
+  }
+  if (view.chunks.empty()) {
+    return 0;
+  }
+  view.total = static_cast<uint64_t>(view.chunks.size() - 1) * CHUNK_SAMPLES +
+               view.chunks.back().count;
+  if (view.total == 0) {
+    return 0;
+  }
+
+  const uint64_t begin = lowerBound(view, keyLower, 0, view.total);
+  const uint64_t end = upperBound(view, keyUpper, begin, view.total);
+
+  // границы столбцов те же, что у MinMaxDecimator
+  return MinMaxDecimator::decimateColumns(
+      0, view.total, begin, end, keyLower, keyUpper, columns,
+      [this, &view](uint64_t index) { return sampleAt(view, index); },
+      [this, &view](double key, uint64_t first, uint64_t last) {
+        return lowerBound(view, key, first, last);
+      },
+      [this, &view](uint64_t first, uint64_t last) {
+        return aggregate(view, first, last);
+      },
+      outKeys, outValues);
+}
+
+uint64_t HistoryStore::getWrittenSamples() const {
+  return m_writtenSamples.load();
+}
+
+uint64_t HistoryStore::getDroppedSamples() const {
+  return m_droppedSamples.load();
+}
+
+uint64_t HistoryStore::getDiskUsage() const { return m_diskUsage.load(); }
+
+bool HistoryStore::hasFailed() const { return m_drainer.hasFailed(); }
+
+size_t HistoryStore::chunkFileSize() {
+  return BLOCKS_OFFSET + BLOCK_COUNT * sizeof(Summary);
+}
+
+std::string HistoryStore::chunkPath(size_t series,
+                                    uint64_t fileNumber) const {
+  // имя серии может содержать что угодно, в имени файла только номера
+  return (std::filesystem::path(m_directory) /
+          (std::to_string(series) + "_" + std::to_string(fileNumber) +
+           CHUNK_EXTENSION))
+      .string();
+}
+
+void HistoryStore::removeChunkFiles() {
+  std::error_code error;
+  std::filesystem::create_directories(m_directory, error);
+  if (error) {
+    throw std::runtime_error("Failed to create history directory: " +
+                             m_directory);
+  }
+
+  // удаляем только свои файлы, остальное в каталоге не трогаем
+  for (const auto &entry :
+       std::filesystem::directory_iterator(m_directory, error)) {
+    if (entry.path().extension() == CHUNK_EXTENSION) {
+      std::error_code removeError;
+      std::filesystem::remove(entry.path(), removeError);
+    }
+  }
+}
+
+void HistoryStore::consume(size_t series, const DataPoint *points,
+                           size_t count) {
+  SeriesState &state = m_series[series];
+  for (size_t i = 0; i < count; ++i) {
+    append(state, points[i]);
+  }
+  m_writtenSamples.fetch_add(count);
+}
+
+void HistoryStore::append(SeriesState &state, const DataPoint &point) {
+  if (state.hasLast) {
+    uint32_t last = state.lastKey;
+    if (point.timestamp < last) {
+      if (last - point.timestamp > Constants::RESTART_GAP_MS) {
+        // время источника пошло заново, старая история не продолжается
+        restartSeries(state);
+      } else {
+        m_droppedSamples.fetch_add(1);
+        return;
+      }
+    }
+  }
+
+  if (!state.hasCurrent || state.current.count == CHUNK_SAMPLES) {
+    openChunk(state);
+  }
+
+  ChunkInfo &chunk = state.current;
+  uint8_t *data = state.writeFile.data();
+  const uint32_t index = chunk.count;
+
+  std::memcpy(data + SAMPLES_OFFSET + index * sizeof(DataPoint), &point,
+              sizeof(DataPoint));
+
+  const Summary single = MinMaxDecimator::makeMinMax(point);
+  if (index % SUMMARY_BLOCK == 0) {
+    state.block = single;
+  } else {
+    MinMaxDecimator::merge(state.block, single);
+  }
+  if (index == 0) {
+    chunk.summary = single;
+    chunk.firstKey = point.timestamp;
+  } else {
+    MinMaxDecimator::merge(chunk.summary, single);
+  }
+  chunk.lastKey = point.timestamp;
+  chunk.count = index + 1;
+  state.lastKey = point.timestamp;
+  state.hasLast = true;
+
+  // блок готов: его сводка ложится на диск рядом с отсчетами
+  if (chunk.count % SUMMARY_BLOCK == 0) {
+    std::memcpy(data + BLOCKS_OFFSET +
+                    (chunk.count / SUMMARY_BLOCK - 1) * sizeof(Summary),
+                &state.block, sizeof(Summary));
+  }
+}
+
+void HistoryStore::openChunk(SeriesState &state) {
+  // заполненный чанк публикуется целиком, со сводкой
+  publish(state);
+
+  const size_t series = static_cast<size_t>(&state - m_series.data());
+  const uint64_t fileNumber = state.nextFileNumber++;
+  state.writeFile.open(chunkPath(series, fileNumber), chunkFileSize(),
+                       MappedFile::Mode::ReadWrite);
+  m_diskUsage.fetch_add(chunkFileSize());
+
+  ChunkHeader header = {CHUNK_MAGIC, 0, 0, 0};
+  std::memcpy(state.writeFile.data(), &header, sizeof(header));
+
+  state.current = ChunkInfo();
+  state.current.fileNumber = fileNumber;
+  state.current.count = 0;
+  state.hasCurrent = true;
+}
+
+void HistoryStore::restartSeries(SeriesState &state) {
+  // текущий чанк тоже попадает в оглавление, чтобы удалиться вместе с ним
+  publish(state);
+  state.writeFile.close();
+  state.hasCurrent = false;
+  state.hasLast = false;
+
+  std::vector<ChunkInfo> dropped;
+  {
+    std::lock_guard<std::mutex> lock(m_indexMutex);
+    dropped.swap(state.chunks);
+  }
+
+  // файлы старой истории больше не нужны. у читателя они могут быть еще
+  // отображены - это не мешает, номера файлов не повторяются
+  const size_t series = static_cast<size_t>(&state - m_series.data());
+  for (const ChunkInfo &chunk : dropped) {
+    std::error_code error;
+    if (std::filesystem::remove(chunkPath(series, chunk.fileNumber), error)) {
+      m_diskUsage.fetch_sub(chunkFileSize());
+    }
+  }
+}
+
+void HistoryStore::publish(SeriesState &state) {
+  if (!state.hasCurrent) {
+    return;
+  }
+
+  // заголовок на диске нужен, чтобы чанк читался и без оглавления
+  const ChunkInfo &chunk = state.current;
+  ChunkHeader header = {CHUNK_MAGIC, chunk.count, chunk.firstKey,
+                        chunk.lastKey};
+  std::memcpy(state.writeFile.data(), &header, sizeof(header));
+
+  // отсчеты уже в отображении: после разблокировки их увидит query()
+  std::lock_guard<std::mutex> lock(m_indexMutex);
+  if (state.chunks.empty() ||
+      state.chunks.back().fileNumber != chunk.fileNumber) {
+    state.chunks.push_back(chunk);
+  } else {
+    state.chunks.back() = chunk;
+  }
+}
+
+const uint8_t *HistoryStore::mapChunk(size_t series, uint64_t fileNumber) {
+  for (MappedChunk &mapped : m_mapped) {
+    if (mapped.series == series && mapped.fileNumber == fileNumber) {
+      mapped.lastUse = ++m_useCounter;
+      return mapped.file.data();
+    }
+  }
+
+  // промах: занимаем свободное место или вытесняем самый давний чанк
+  MappedChunk *slot = nullptr;
+  if (m_mapped.size() < MAX_MAPPED_CHUNKS) {
+    m_mapped.emplace_back();
+    slot = &m_mapped.back();
+  } else {
+    slot = &*std::min_element(m_mapped.begin(), m_mapped.end(),
+                              [](const MappedChunk &a, const MappedChunk &b) {
+                                return a.lastUse < b.lastUse;
+                              });
+  }
+
+  slot->series = series;
+  slot->fileNumber = fileNumber;
+  slot->lastUse = ++m_useCounter;
+  try {
+    slot->file.open(chunkPath(series, fileNumber), chunkFileSize(),
+                    MappedFile::Mode::ReadOnly);
+  } catch (...) {
+    // пустой слот не должен находиться по номеру файла
+    slot->fileNumber = UINT64_MAX;
+    throw;
+  }
+  return slot->file.data();
+}
+
+const DataPoint *HistoryStore::chunkSamples(const QueryView &view,
+                                            size_t chunk) {
+  const uint8_t *data = mapChunk(view.series, view.chunks[chunk].fileNumber);
+  return reinterpret_cast<const DataPoint *>(data + SAMPLES_OFFSET);
+}
+
+const HistoryStore::Summary *
+HistoryStore::chunkBlocks(const QueryView &view, size_t chunk) {
+  const uint8_t *data = mapChunk(view.series, view.chunks[chunk].fileNumber);
+  return reinterpret_cast<const Summary *>(data + BLOCKS_OFFSET);
+}
+
+DataPoint HistoryStore::sampleAt(const QueryView &view, uint64_t index) {
+  const size_t chunk = static_cast<size_t>(index / CHUNK_SAMPLES);
+  return chunkSamples(view, chunk)[index % CHUNK_SAMPLES];
+}
+
+uint64_t HistoryStore::lowerBound(const QueryView &view, double key,
+                                  uint64_t first, uint64_t last) {
+  if (first >= last) {
+    return last;
+  }
+
+  // сначала чанк по оглавлению в памяти, потом отсчет внутри чанка
+  const size_t chunkFirst = static_cast<size_t>(first / CHUNK_SAMPLES);
+  const size_t chunkLast = static_cast<size_t>((last - 1) / CHUNK_SAMPLES);
+  auto found = std::lower_bound(
+      view.chunks.begin() + static_cast<std::ptrdiff_t>(chunkFirst),
+      view.chunks.begin() + static_cast<std::ptrdiff_t>(chunkLast) + 1, key,
+      [](const ChunkInfo &chunk, double k) { return chunk.lastKey < k; });
+  if (found == view.chunks.begin() + static_cast<std::ptrdiff_t>(chunkLast) +
+                   1) {
+    return last;
+  }
+
+  const size_t chunk = static_cast<size_t>(found - view.chunks.begin());
+  const uint64_t base = static_cast<uint64_t>(chunk) * CHUNK_SAMPLES;
+  const uint64_t from = std::max(first, base);
+  const uint64_t to = std::min(last, base + found->count);
+  const DataPoint *samples = chunkSamples(view, chunk);
+  const DataPoint *position = std::lower_bound(
+      samples + (from - base), samples + (to - base), key,
+      [](const DataPoint &point, double k) { return point.timestamp < k; });
+  return base + static_cast<uint64_t>(position - samples);
+}
+
+uint64_t HistoryStore::upperBound(const QueryView &view, double key,
+                                  uint64_t first, uint64_t last) {
+  if (first >= last) {
+    return last;
+  }
+
+  const size_t chunkFirst = static_cast<size_t>(first / CHUNK_SAMPLES);
+  const size_t chunkLast = static_cast<size_t>((last - 1) / CHUNK_SAMPLES);
+  auto found = std::upper_bound(
+      view.chunks.begin() + static_cast<std::ptrdiff_t>(chunkFirst),
+      view.chunks.begin() + static_cast<std::ptrdiff_t>(chunkLast) + 1, key,
+      [](double k, const ChunkInfo &chunk) { return k < chunk.lastKey; });
+  if (found == view.chunks.begin() + static_cast<std::ptrdiff_t>(chunkLast) +
+                   1) {
+    return last;
+  }
+
+  const size_t chunk = static_cast<size_t>(found - view.chunks.begin());
+  const uint64_t base = static_cast<uint64_t>(chunk) * CHUNK_SAMPLES;
+  const uint64_t from = std::max(first, base);
+  const uint64_t to = std::min(last, base + found->count);
+  const DataPoint *samples = chunkSamples(view, chunk);
+  const DataPoint *position = std::upper_bound(
+      samples + (from - base), samples + (to - base), key,
+      [](double k, const DataPoint &point) { return k < point.timestamp; });
+  return base + static_cast<uint64_t>(position - samples);
+}
+
+HistoryStore::Summary HistoryStore::aggregate(const QueryView &view,
+                                              uint64_t first, uint64_t last) {
+  Summary result = MinMaxDecimator::makeMinMax(sampleAt(view, first));
+  uint64_t index = first + 1;
+
+  while (index < last) {
+    const size_t chunk = static_cast<size_t>(index / CHUNK_SAMPLES);
+    const uint64_t base = static_cast<uint64_t>(chunk) * CHUNK_SAMPLES;
+    const uint64_t segmentEnd = std::min(last, base + CHUNK_SAMPLES);
+
+    // заполненный чанк целиком в диапазоне: сводка из оглавления, файл
+    // не трогаем
+    if (index == base && segmentEnd == base + CHUNK_SAMPLES &&
+        view.chunks[chunk].count == CHUNK_SAMPLES) {
+      MinMaxDecimator::merge(result, view.chunks[chunk].summary);
+      index = segmentEnd;
+      continue;
+    }
+
+    // отсчеты и сводки блоков из одного отображения чанка
+    const DataPoint *samples = chunkSamples(view, chunk);
+    const Summary *blocks = chunkBlocks(view, chunk);
+
+    while (index < segmentEnd) {
+      const uint64_t offset = index - base;
+      if (offset % SUMMARY_BLOCK == 0 &&
+          index + SUMMARY_BLOCK <= segmentEnd) {
+        // блок целиком в диапазоне и уже записан, раз записан его конец
+        MinMaxDecimator::merge(result, blocks[offset / SUMMARY_BLOCK]);
+        index += SUMMARY_BLOCK;
+      } else {
+        MinMaxDecimator::merge(result,
+                               MinMaxDecimator::makeMinMax(samples[offset]));
+        ++index;
+      }
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,159 @@
+#include "../../include/storage/mappedfile.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : m_data(nullptr), m_size(0),
+#ifdef _WIN32
+      m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr)
+#else
+      m_fd(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept : MappedFile() {
+  swap(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    close();
+    swap(other);
+  }
+  return *this;
+}
+
+void MappedFile::swap(MappedFile &other) noexcept {
+  std::swap(m_data, other.m_data);
+  std::swap(m_size, other.m_size);
+#ifdef _WIN32
+  std::swap(m_file, other.m_file);
+  std::swap(m_mapping, other.m_mapping);
+#else
+  std::swap(m_fd, other.m_fd);
+#endif
+}
+
+void MappedFile::open(const std::string &path, size_t size, Mode mode) {
+  close();
+  if (size == 0) {
+    throw std::invalid_argument("Mapped file size must be positive");
+  }
+
+  const bool writable = mode == Mode::ReadWrite;
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(
+      path.c_str(), writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+      writable ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+      nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("Failed to open mapped file: " + path);
+  }
+
+  // для записи размер задает само отображение, файл растет до него
+  const ULONGLONG mappingSize = static_cast<ULONGLONG>(size);
+  HANDLE mapping = CreateFileMappingA(
+      file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+      static_cast<DWORD>(mappingSize >> 32),
+      static_cast<DWORD>(mappingSize & 0xFFFFFFFFu), nullptr);
+  if (!mapping) {
+    CloseHandle(file);
+    throw std::runtime_error("Failed to create file mapping: " + path);
+  }
+
+  void *view = MapViewOfFile(mapping,
+                             writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0,
+                             size);
+  if (!view) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    throw std::runtime_error("Failed to map file: " + path);
+  }
+
+  m_file = file;
+  m_mapping = mapping;
+  m_data = static_cast<uint8_t *>(view);
+#else
+  int fd = ::open(path.c_str(), writable ? (O_RDWR | O_CREAT | O_TRUNC)
+                                         : O_RDONLY,
+                  0644);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open mapped file: " + path);
+  }
+
+  if (writable) {
+#ifdef __linux__
+    // место выделяется сразу: нехватка диска - исключение здесь, а не
+    // SIGBUS при записи в отображение
+    const bool resized =
+        ::posix_fallocate(fd, 0, static_cast<off_t>(size)) == 0;
+#else
+    const bool resized = ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+#endif
+    if (!resized) {
+      ::close(fd);
+      throw std::runtime_error("Failed to resize mapped file: " + path);
+    }
+  }
+
+  void *view = ::mmap(nullptr, size,
+                      writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                      MAP_SHARED, fd, 0);
+  if (view == MAP_FAILED) {
+    ::close(fd);
+    throw std::runtime_error("Failed to map file: " + path);
+  }
+
+  m_fd = fd;
+  m_data = static_cast<uint8_t *>(view);
+#endif
+
+  m_size = size;
+}
+
+void MappedFile::close() {
+  if (!m_data) {
+    return;
+  }
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_data);
+  CloseHandle(static_cast<HANDLE>(m_mapping));
+  CloseHandle(static_cast<HANDLE>(m_file));
+  m_mapping = nullptr;
+  m_file = INVALID_HANDLE_VALUE;
+#else
+  ::munmap(m_data, m_size);
+  ::close(m_fd);
+  m_fd = -1;
+#endif
+
+  m_data = nullptr;
+  m_size = 0;
+}
+
+void MappedFile::flush() {
+  if (!m_data) {
+    return;
+  }
+
+#ifdef _WIN32
+  FlushViewOfFile(m_data, 0);
+#else
+  ::msync(m_data, m_size, MS_ASYNC);
+#endif
+}
@@ -0,0 +1,305 @@
+#include "../../include/storage/replaysource.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+// потребитель, чье отставание не менялось столько времени, не читает
+// (его фильтр выключен) и писатель его больше не ждет
+constexpr std::chrono::milliseconds STALL_TIMEOUT(200);
+// пауза между проверками отставания потребителей
+constexpr std::chrono::microseconds CONSUMER_POLL_INTERVAL(50);
+} // namespace
+
+ReplaySource::ReplaySource(BroadcastRingBuffer<DataPoint> *buffer)
+    : m_buffer(buffer), m_series(0), m_totalSamples(0),
+      m_pacing(Pacing::RealTime), m_speed(1.0), m_running(false),
+      m_finished(false), m_samplesReplayed(0) {
+  if (!m_buffer) {
+    throw std::invalid_argument("Replay buffer cannot be nullptr");
+  }
+}
+
+ReplaySource::~ReplaySource() { stop(); }
+
+void ReplaySource::open(const std::string &path, const std::string &series) {
+  if (m_running.load()) {
+    throw std::runtime_error("Cannot open recording while replaying");
+  }
+
+  m_reader.open(path);
+  int index = m_reader.findSeries(series);
+  if (index < 0) {
+    m_reader.close();
+    throw std::runtime_error("Recording has no series " + series);
+  }
+
+  m_series = static_cast<size_t>(index);
+  m_totalSamples = m_reader.sampleCount(m_series);
+}
+
+void ReplaySource::addConsumer(const std::string &name,
+                               const IBufferReader<DataPoint> *reader) {
+  if (!reader) {
+    throw std::invalid_argument("Replay consumer reader cannot be nullptr");
+  }
+  if (m_running.load()) {
+    throw std::runtime_error("Cannot add replay consumer while replaying");
+  }
+
+  Consumer consumer;
+  consumer.name = name;
+  consumer.reader = reader;
+  consumer.lastBacklog = 0;
+  consumer.stalled = false;
+  m_consumers.push_back(consumer);
+}
+
+void ReplaySource::clearConsumers() {
+  if (m_running.load()) {
+    throw std::runtime_error("Cannot remove replay consumers while replaying");
+  }
+  m_consumers.clear();
+}
+
+bool ReplaySource::start(Pacing pacing, double speed) {
+  if (m_running.load() || !m_reader.isOpen()) {
+    return false;
+  }
+  if (pacing == Pacing::Scaled && !(speed > 0.0)) {
+    throw std::invalid_argument("Replay speed must be positive");
+  }
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  m_pacing = pacing;
+  m_speed = pacing == Pacing::Scaled ? speed : 1.0;
+  m_samplesReplayed.store(0);
+  m_finished.store(false);
+  {
+    std::lock_guard<std::mutex> lock(m_reportMutex);
+    m_reports.clear();
+    m_error.clear();
+  }
+
+  m_running.store(true);
+  m_thread = std::thread(&ReplaySource::run, this);
+  return true;
+}
+
+void ReplaySource::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_stopMutex);
+    m_running.store(false);
+  }
+  m_stopCondition.notify_all();
+
+  // поток мог закончиться сам, когда кончилась запись
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+bool ReplaySource::isRunning() const {
+  return m_running.load() && !m_finished.load();
+}
+
+bool ReplaySource::isFinished() const { return m_finished.load(); }
+
+uint64_t ReplaySource::getSamplesReplayed() const {
+  return m_samplesReplayed.load();
+}
+
+uint64_t ReplaySource::getTotalSamples() const { return m_totalSamples; }
+
+std::vector<ReplaySource::ConsumerReport>
+ReplaySource::getConsumerReports() const {
+  std::lock_guard<std::mutex> lock(m_reportMutex);
+  return m_reports;
+}
+
+std::string ReplaySource::getError() const {
+  std::lock_guard<std::mutex> lock(m_reportMutex);
+  return m_error;
+}
+
+void ReplaySource::run() {
+  // run() выполняется в отдельном потоке
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point started = Clock::now();
+
+  for (Consumer &consumer : m_consumers) {
+    consumer.lastBacklog = consumer.reader->size();
+    consumer.moved = started;
+    consumer.stalled = false;
+  }
+
+  // опорная точка темпа: timestamp записи, соответствующий моменту base
+  bool haveBase = false;
+  uint32_t baseTimestamp = 0;
+  uint32_t lastTimestamp = 0;
+  Clock::time_point baseTime = started;
+  auto dueTime = [&](uint32_t timestamp) {
+    std::chrono::duration<double, std::milli> offset(
+        static_cast<double>(timestamp - baseTimestamp) / m_speed);
+    return baseTime +
+           std::chrono::duration_cast<Clock::duration>(offset);
+  };
+
+  std::vector<DataPoint> chunk;
+  const size_t chunkCount = m_reader.chunks(m_series).size();
+  size_t c = 0;
+
+  try {
+    for (; c < chunkCount && m_running.load(); ++c) {
+      m_reader.readChunk(m_series, c, chunk);
+
+      if (m_pacing == Pacing::AsFastAsPossible) {
+        publish(chunk.data(), chunk.size());
+        continue;
+      }
+
+      size_t i = 0;
+      while (i < chunk.size() && m_running.load()) {
+        // время записи пошло назад (перезапуск источника) - новая опора
+        if (!haveBase || chunk[i].timestamp < lastTimestamp) {
+          haveBase = true;
+          baseTimestamp = chunk[i].timestamp;
+          baseTime = Clock::now();
+        }
+        if (!sleepUntil(dueTime(chunk[i].timestamp))) {
+          break;
+        }
+
+        // все отсчеты, чье время уже наступило, уходят одним блоком
+        const Clock::time_point now = Clock::now();
+        size_t end = i + 1;
+        lastTimestamp = chunk[i].timestamp;
+        while (end < chunk.size() && chunk[end].timestamp >= lastTimestamp &&
+               dueTime(chunk[end].timestamp) <= now) {
+          lastTimestamp = chunk[end].timestamp;
+          ++end;
+        }
+        publish(chunk.data() + i, end - i);
+        i = end;
+      }
+    }
+  } catch (const std::exception &e) {
+    // поврежденный чанк: воспроизводим то, что успели прочитать, и
+    // сообщаем, что запись оборвалась
+    std::lock_guard<std::mutex> lock(m_reportMutex);
+    m_error = "chunk " + std::to_string(c + 1) + " of " +
+              std::to_string(chunkCount) + ": " + e.what();
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(m_reportMutex);
+    m_error = "chunk " + std::to_string(c + 1) + " of " +
+              std::to_string(chunkCount) + ": unknown error";
+  }
+
+  if (!m_running.load()) {
+    return;
+  }
+
+  // ждем, пока потребители дочитают, и запоминаем, когда это случилось
+  std::vector<ConsumerReport> reports(m_consumers.size());
+  std::vector<bool> done(m_consumers.size(), false);
+  size_t remaining = m_consumers.size();
+  while (remaining > 0 && m_running.load()) {
+    const Clock::time_point now = Clock::now();
+    for (size_t i = 0; i < m_consumers.size(); ++i) {
+      if (done[i]) {
+        continue;
+      }
+      Consumer &consumer = m_consumers[i];
+      size_t backlog = consumer.reader->size();
+      if (backlog != consumer.lastBacklog) {
+        consumer.lastBacklog = backlog;
+        consumer.moved = now;
+      } else if (backlog > 0 && now - consumer.moved > STALL_TIMEOUT) {
+        consumer.stalled = true;
+      }
+      if (backlog == 0 || consumer.stalled) {
+        ConsumerReport &report = reports[i];
+        report.name = consumer.name;
+        report.stalled = consumer.stalled;
+        // застрявший прочитал не все: опубликованное минус отставание, а
+        // его скорость не замер пропускной способности
+        const uint64_t published = m_samplesReplayed.load();
+        report.samples = published - std::min<uint64_t>(backlog, published);
+        report.seconds =
+            std::chrono::duration<double>(consumer.moved - started).count();
+        if (!report.stalled && report.seconds > 0.0) {
+          report.samplesPerSecond =
+              static_cast<double>(report.samples) / report.seconds;
+        }
+        done[i] = true;
+        --remaining;
+      }
+    }
+    std::this_thread::sleep_for(CONSUMER_POLL_INTERVAL);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_reportMutex);
+    m_reports.swap(reports);
+  }
+  m_finished.store(true);
+}
+
+void ReplaySource::publish(const DataPoint *points, size_t count) {
+  if (m_pacing != Pacing::AsFastAsPossible) {
+    // как живой прием: журнал не ждет отстающих
+    m_buffer->pushBulk(points, count);
+    m_samplesReplayed.fetch_add(count);
+    return;
+  }
+
+  // не больше четверти журнала за раз, чтобы потребители читали, пока
+  // пишется следующий блок
+  const size_t block = std::max<size_t>(1, m_buffer->capacity() / 4);
+  while (count > 0) {
+    size_t n = std::min(count, block);
+    if (!waitForConsumers(m_buffer->capacity() - n)) {
+      return;
+    }
+    m_buffer->pushBulk(points, n);
+    m_samplesReplayed.fetch_add(n);
+    points += n;
+    count -= n;
+  }
+}
+
+bool ReplaySource::waitForConsumers(size_t backlog) {
+  while (m_running.load()) {
+    const auto now = std::chrono::steady_clock::now();
+    bool ready = true;
+    for (Consumer &consumer : m_consumers) {
+      if (consumer.stalled) {
+        continue;
+      }
+      size_t current = consumer.reader->size();
+      if (current != consumer.lastBacklog) {
+        consumer.lastBacklog = current;
+        consumer.moved = now;
+      } else if (current > 0 && now - consumer.moved > STALL_TIMEOUT) {
+        consumer.stalled = true;
+        continue;
+      }
+      if (current > backlog) {
+        ready = false;
+      }
+    }
+    if (ready) {
+      return true;
+    }
+    std::this_thread::sleep_for(CONSUMER_POLL_INTERVAL);
+  }
+  return false;
+}
+
+bool ReplaySource::sleepUntil(std::chrono::steady_clock::time_point deadline) {
+  std::unique_lock<std::mutex> lock(m_stopMutex);
+  m_stopCondition.wait_until(lock, deadline,
+                             [this] { return !m_running.load(); });
+  return m_running.load();
+}
@@ -0,0 +1,282 @@
+#include "../../include/storage/sessionreader.h"
+#include "../../include/storage/gorillacodec.h"
+#include <algorithm>
+#include <stdexcept>
+
+SessionReader::SessionReader() : m_version(0), m_recovered(false) {}
+
+void SessionReader::open(const std::string &path) {
+  close();
+
+  m_file.open(path, std::ios::binary);
+  if (!m_file.is_open()) {
+    throw std::runtime_error("Failed to open recording: " + path);
+  }
+
+  try {
+    m_file.seekg(0, std::ios::end);
+    const uint64_t fileSize = static_cast<uint64_t>(m_file.tellg());
+    m_file.seekg(0, std::ios::beg);
+
+    SessionFormat::FileHeader header;
+    read(&header, sizeof(header));
+    if (header.magic != SessionFormat::FILE_MAGIC) {
+      throw std::runtime_error("Not a recording file: " + path);
+    }
+    if (header.version == 0 || header.version > SessionFormat::VERSION) {
+      throw std::runtime_error("Unsupported recording version: " + path);
+    }
+    m_version = header.version;
+
+    for (uint16_t i = 0; i < header.seriesCount; ++i) {
+      uint16_t length = 0;
+      read(&length, sizeof(length));
+      std::string name(length, '\0');
+      read(&name[0], length);
+      m_names.push_back(name);
+    }
+    m_chunks.resize(m_names.size());
+    m_segments.resize(m_names.size());
+
+    const uint64_t dataBegin = static_cast<uint64_t>(m_file.tellg());
+    if (!readFooter(fileSize)) {
+      rebuildIndex(dataBegin, fileSize);
+    }
+  } catch (...) {
+    close();
+    throw;
+  }
+}
+
+void SessionReader::close() {
+  m_file.close();
+  m_file.clear();
+  m_version = 0;
+  m_recovered = false;
+  m_names.clear();
+  m_chunks.clear();
+  m_segments.clear();
+}
+
+bool SessionReader::isOpen() const { return m_file.is_open(); }
+
+bool SessionReader::wasRecovered() const { return m_recovered; }
+
+size_t SessionReader::seriesCount() const { return m_names.size(); }
+
+const std::string &SessionReader::seriesName(size_t series) const {
+  return m_names.at(series);
+}
+
+int SessionReader::findSeries(const std::string &name) const {
+  for (size_t i = 0; i < m_names.size(); ++i) {
+    if (m_names[i] == name) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+const std::vector<SessionFormat::IndexEntry> &
+SessionReader::chunks(size_t series) const {
+  return m_chunks.at(series);
+}
+
+uint64_t SessionReader::sampleCount(size_t series) const {
+  uint64_t total = 0;
+  for (const SessionFormat::IndexEntry &entry : m_chunks.at(series)) {
+    total += entry.count;
+  }
+  return total;
+}
+
+size_t SessionReader::segmentCount(size_t series) const {
+  return m_segments.at(series).size();
+}
+
+void SessionReader::segmentChunks(size_t series, size_t segment,
+                                  size_t &first, size_t &last) const {
+  const std::vector<size_t> &starts = m_segments.at(series);
+  first = starts.at(segment);
+  last = segment + 1 < starts.size() ? starts[segment + 1]
+                                     : m_chunks[series].size();
+}
+
+size_t SessionReader::findChunk(size_t series, size_t segment,
+                                uint32_t timestamp) const {
+  size_t first = 0;
+  size_t last = 0;
+  segmentChunks(series, segment, first, last);
+
+  // в пределах участка lastTimestamp чанков не убывает
+  const std::vector<SessionFormat::IndexEntry> &entries = m_chunks[series];
+  auto found = std::lower_bound(
+      entries.begin() + static_cast<std::ptrdiff_t>(first),
+      entries.begin() + static_cast<std::ptrdiff_t>(last), timestamp,
+      [](const SessionFormat::IndexEntry &entry, uint32_t value) {
+        return entry.lastTimestamp < value;
+      });
+  return static_cast<size_t>(found - entries.begin());
+}
+
+void SessionReader::readChunk(size_t series, size_t chunk,
+                              std::vector<DataPoint> &out) {
+  const SessionFormat::IndexEntry &entry = m_chunks.at(series).at(chunk);
+
+  m_file.clear();
+  m_file.seekg(static_cast<std::streamoff>(entry.offset), std::ios::beg);
+
+  SessionFormat::ChunkHeader header;
+  if (!readChunkHeader(header) || header.series != entry.series ||
+      header.count != entry.count) {
+    throw std::runtime_error("Recording chunk is corrupted");
+  }
+
+  out.resize(header.count);
+  if (header.encoding == SessionFormat::ENCODING_GORILLA) {
+    m_encoded.resize(header.size);
+    read(m_encoded.data(), header.size);
+    GorillaDecoder::decode(m_encoded.data(), m_encoded.size(), header.count,
+                           out.data());
+    return;
+  }
+
+  m_timestamps.resize(header.count);
+  m_values.resize(header.count);
+  read(m_timestamps.data(), header.count * sizeof(uint32_t));
+  read(m_values.data(), header.count * sizeof(float));
+  for (uint32_t i = 0; i < header.count; ++i) {
+    out[i] = DataPoint(m_timestamps[i], m_values[i]);
+  }
+}
+
+bool SessionReader::readChunkHeader(SessionFormat::ChunkHeader &header) {
+  header = SessionFormat::ChunkHeader();
+  m_file.read(reinterpret_cast<char *>(&header),
+              SessionFormat::chunkHeaderSize(m_version));
+  if (!m_file || header.magic != SessionFormat::CHUNK_MAGIC) {
+    return false;
+  }
+
+  const uint64_t rawSize =
+      static_cast<uint64_t>(header.count) * (sizeof(uint32_t) + sizeof(float));
+  if (m_version < 2) {
+    header.encoding = SessionFormat::ENCODING_RAW;
+    header.size = static_cast<uint32_t>(rawSize);
+  }
+
+  switch (header.encoding) {
+  case SessionFormat::ENCODING_RAW:
+    return header.size == rawSize;
+  case SessionFormat::ENCODING_GORILLA:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void SessionReader::read(void *data, size_t size) {
+  if (size == 0) {
+    return;
+  }
+  m_file.read(static_cast<char *>(data), static_cast<std::streamsize>(size));
+  if (!m_file) {
+    throw std::runtime_error("Unexpected end of recording file");
+  }
+}
+
+bool SessionReader::readFooter(uint64_t fileSize) {
+  if (fileSize < sizeof(SessionFormat::FileHeader) +
+                     sizeof(SessionFormat::FooterTail)) {
+    return false;
+  }
+
+  SessionFormat::FooterTail tail;
+  m_file.clear();
+  m_file.seekg(
+      static_cast<std::streamoff>(fileSize - sizeof(SessionFormat::FooterTail)),
+      std::ios::beg);
+  m_file.read(reinterpret_cast<char *>(&tail), sizeof(tail));
+  if (!m_file || tail.magic != SessionFormat::FOOTER_MAGIC) {
+    return false;
+  }
+
+  // оглавление должно заканчиваться ровно перед хвостом
+  const uint64_t indexSize = static_cast<uint64_t>(tail.entryCount) *
+                             sizeof(SessionFormat::IndexEntry);
+  if (tail.indexOffset + indexSize + sizeof(tail) != fileSize) {
+    return false;
+  }
+
+  std::vector<SessionFormat::IndexEntry> entries(tail.entryCount);
+  m_file.seekg(static_cast<std::streamoff>(tail.indexOffset), std::ios::beg);
+  read(entries.data(), indexSize);
+  for (const SessionFormat::IndexEntry &entry : entries) {
+    addEntry(entry);
+  }
+  return true;
+}
+
+void SessionReader::rebuildIndex(uint64_t dataBegin, uint64_t fileSize) {
+  m_recovered = true;
+  for (auto &entries : m_chunks) {
+    entries.clear();
+  }
+  for (auto &starts : m_segments) {
+    starts.clear();
+  }
+
+  // идем по заголовкам чанков, пока они целые
+  uint64_t offset = dataBegin;
+  while (offset + SessionFormat::chunkHeaderSize(m_version) <= fileSize) {
+    SessionFormat::ChunkHeader header;
+    m_file.clear();
+    m_file.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+    if (!readChunkHeader(header) || header.series >= m_names.size()) {
+      break;
+    }
+
+    const uint64_t size = SessionFormat::chunkHeaderSize(m_version) +
+                          static_cast<uint64_t>(header.size);
+    if (offset + size > fileSize) {
+      break; // оборванный последний чанк
+    }
+
+    // в заголовке чанка участка нет: чанк продолжает участок предыдущего,
+    // новый начинает addEntry() по скачку времени назад
+    const std::vector<SessionFormat::IndexEntry> &entries =
+        m_chunks[header.series];
+    const uint16_t segment = entries.empty() ? 0 : entries.back().segment;
+    SessionFormat::IndexEntry entry = {offset,
+                                       header.series,
+                                       segment,
+                                       header.count,
+                                       header.firstTimestamp,
+                                       header.lastTimestamp};
+    addEntry(entry);
+    offset += size;
+  }
+}
+
+void SessionReader::addEntry(SessionFormat::IndexEntry entry) {
+  if (entry.series >= m_chunks.size()) {
+    throw std::runtime_error("Recording index refers to unknown series");
+  }
+
+  std::vector<SessionFormat::IndexEntry> &entries = m_chunks[entry.series];
+  if (entries.empty()) {
+    m_segments[entry.series].push_back(0);
+  } else {
+    // записи до появления участков их не знают: скачок времени назад
+    // между чанками тоже начинает участок
+    const SessionFormat::IndexEntry &previous = entries.back();
+    if (entry.segment == previous.segment &&
+        entry.firstTimestamp < previous.lastTimestamp) {
+      entry.segment = static_cast<uint16_t>(previous.segment + 1);
+    }
+    if (entry.segment != previous.segment) {
+      m_segments[entry.series].push_back(entries.size());
+    }
+  }
+  entries.push_back(entry);
+}
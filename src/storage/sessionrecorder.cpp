@@ -0,0 +1,204 @@
+#include "../../include/storage/sessionrecorder.h"
+#include "../../include/core/Constants.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+constexpr size_t SessionRecorder::CHUNK_SAMPLES;
+
+SessionRecorder::SessionRecorder(std::chrono::milliseconds period)
+    : m_drainer(period), m_recordedSamples(0), m_droppedSamples(0),
+      m_bytesWritten(0), m_chunkBytes(0) {}
+
+SessionRecorder::~SessionRecorder() { stop(); }
+
+void SessionRecorder::addSeries(const std::string &name,
+                                IBufferReader<DataPoint> *reader) {
+  if (m_series.size() >= std::numeric_limits<uint16_t>::max() ||
+      name.size() > std::numeric_limits<uint16_t>::max()) {
+    throw std::invalid_argument("Too many series or series name too long");
+  }
+
+  m_drainer.addReader(reader);
+
+  SeriesState state;
+  state.name = name;
+  state.firstTimestamp = 0;
+  state.lastTimestamp = 0;
+  state.segment = 0;
+  state.hasLast = false;
+  m_series.push_back(std::move(state));
+}
+
+void SessionRecorder::start(const std::string &path) {
+  if (m_drainer.isRunning()) {
+    return;
+  }
+
+  m_file.close();
+  m_file.clear();
+  m_file.open(path, std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open()) {
+    throw std::runtime_error("Failed to open recording file: " + path);
+  }
+
+  m_index.clear();
+  m_recordedSamples.store(0);
+  m_droppedSamples.store(0);
+  m_bytesWritten.store(0);
+  m_chunkBytes.store(0);
+
+  try {
+    SessionFormat::FileHeader header = {
+        SessionFormat::FILE_MAGIC, SessionFormat::VERSION,
+        static_cast<uint16_t>(m_series.size())};
+    write(&header, sizeof(header));
+    for (const SeriesState &state : m_series) {
+      uint16_t length = static_cast<uint16_t>(state.name.size());
+      write(&length, sizeof(length));
+      write(state.name.data(), state.name.size());
+    }
+  } catch (...) {
+    m_file.close();
+    throw;
+  }
+
+  for (SeriesState &state : m_series) {
+    state.encoder.reset();
+    state.segment = 0;
+    state.hasLast = false;
+  }
+
+  // при ошибке файл остается без оглавления, он все равно читается с
+  // восстановлением
+  m_drainer.start(
+      [this](size_t series, const DataPoint *points, size_t count) {
+        consume(series, points, count);
+      },
+      nullptr, [this] { finish(); });
+}
+
+void SessionRecorder::stop() {
+  if (!m_drainer.isRunning()) {
+    return;
+  }
+  m_drainer.stop();
+  m_file.close();
+}
+
+bool SessionRecorder::isRunning() const { return m_drainer.isRunning(); }
+
+bool SessionRecorder::hasFailed() const { return m_drainer.hasFailed(); }
+
+uint64_t SessionRecorder::getRecordedSamples() const {
+  return m_recordedSamples.load();
+}
+
+uint64_t SessionRecorder::getDroppedSamples() const {
+  return m_droppedSamples.load();
+}
+
+uint64_t SessionRecorder::getBytesWritten() const {
+  return m_bytesWritten.load();
+}
+
+double SessionRecorder::getCompressionRatio() const {
+  const uint64_t bytes = m_chunkBytes.load();
+  if (bytes == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(m_recordedSamples.load() * sizeof(DataPoint)) /
+         static_cast<double>(bytes);
+}
+
+void SessionRecorder::consume(size_t series, const DataPoint *points,
+                              size_t count) {
+  SeriesState &state = m_series[series];
+  for (size_t i = 0; i < count; ++i) {
+    const DataPoint &point = points[i];
+    if (state.hasLast && point.timestamp < state.lastTimestamp) {
+      if (state.lastTimestamp - point.timestamp > Constants::RESTART_GAP_MS) {
+        // время источника пошло заново: старый участок закрывается,
+        // чтобы время в оглавлении участка только росло
+        writeChunk(series);
+        ++state.segment;
+      } else {
+        m_droppedSamples.fetch_add(1);
+        continue;
+      }
+    }
+
+    if (state.encoder.count() == 0) {
+      state.firstTimestamp = point.timestamp;
+    }
+    state.lastTimestamp = point.timestamp;
+    state.hasLast = true;
+    state.encoder.append(point);
+    if (state.encoder.count() == CHUNK_SAMPLES) {
+      writeChunk(series);
+    }
+  }
+}
+
+void SessionRecorder::finish() {
+  for (size_t i = 0; i < m_series.size(); ++i) {
+    writeChunk(i);
+  }
+  writeFooter();
+}
+
+void SessionRecorder::writeChunk(size_t series) {
+  SeriesState &state = m_series[series];
+  if (state.encoder.count() == 0) {
+    return;
+  }
+
+  const uint32_t count = static_cast<uint32_t>(state.encoder.count());
+  const std::vector<uint8_t> &data = state.encoder.finish();
+  SessionFormat::ChunkHeader header = {SessionFormat::CHUNK_MAGIC,
+                                       static_cast<uint16_t>(series),
+                                       SessionFormat::ENCODING_GORILLA,
+                                       count,
+                                       state.firstTimestamp,
+                                       state.lastTimestamp,
+                                       static_cast<uint32_t>(data.size())};
+
+  SessionFormat::IndexEntry entry = {m_bytesWritten.load(),
+                                     header.series,
+                                     state.segment,
+                                     count,
+                                     header.firstTimestamp,
+                                     header.lastTimestamp};
+
+  write(&header, sizeof(header));
+  write(data.data(), data.size());
+
+  m_index.push_back(entry);
+  m_recordedSamples.fetch_add(count);
+  m_chunkBytes.fetch_add(sizeof(header) + data.size());
+  state.encoder.reset();
+}
+
+void SessionRecorder::writeFooter() {
+  SessionFormat::FooterTail tail = {
+      m_bytesWritten.load(), static_cast<uint32_t>(m_index.size()),
+      SessionFormat::FOOTER_MAGIC};
+  write(m_index.data(), m_index.size() * sizeof(SessionFormat::IndexEntry));
+  write(&tail, sizeof(tail));
+  m_file.flush();
+  if (!m_file) {
+    throw std::runtime_error("Failed to flush recording file");
+  }
+}
+
+void SessionRecorder::write(const void *data, size_t size) {
+  if (size == 0) {
+    return;
+  }
+  m_file.write(static_cast<const char *>(data),
+               static_cast<std::streamsize>(size));
+  if (!m_file) {
+    throw std::runtime_error("Failed to write recording file");
+  }
+  m_bytesWritten.fetch_add(size);
+}
@@ -1,6 +1,6 @@
 #include "../../include/ui/cyclictargetcontroller.h"
 #include "../../include/core/Constants.h"
-#include "../../include/ui/networkcontroller.h"
+#include "../../include/network/networkcontroller.h"
 
 #include <QCheckBox>
 #include <QComboBox>
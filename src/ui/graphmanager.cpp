@@ -1,5 +1,7 @@
 #include "../../include/ui/graphmanager.h"
-#include "../../include/core/fft.h"
+#include "../../include/core/Constants.h"
+#include "../../include/core/minmaxdecimator.h"
+#include "../../include/core/trace.h"
 #include <QColor>
 #include <QDebug>
 #include <QFont>
@@ -9,13 +11,21 @@
 #include <algorithm>
 #include <cmath>
 
+namespace {
+// сколько точек забирать из буфера за один popBulk
+constexpr size_t READ_BLOCK_SIZE = 4096;
+} // namespace
+
 GraphManager::GraphManager(QWidget *parent)
     : QObject(parent), m_plot(nullptr), m_spectrumPlot(nullptr),
       m_tabWidget(nullptr), m_rawDataGraph(nullptr), m_movingAvgGraph(nullptr),
       m_medianGraph(nullptr), m_exponentialGraph(nullptr),
       m_kalmanGraph(nullptr), m_rawSpectrumGraph(nullptr),
       m_movingAvgSpectrumGraph(nullptr), m_medianSpectrumGraph(nullptr),
-      m_exponentialSpectrumGraph(nullptr), m_kalmanSpectrumGraph(nullptr) {}
+      m_exponentialSpectrumGraph(nullptr), m_kalmanSpectrumGraph(nullptr),
+      m_historyStore(nullptr), m_readBlock(READ_BLOCK_SIZE),
+      m_readStamps(READ_BLOCK_SIZE), m_latency(nullptr),
+      m_followingRange(false), m_followLatest(true) {}
 
 GraphManager::~GraphManager() {}
 
@@ -77,6 +87,24 @@ void GraphManager::setupGraphs(QWidget *containerWidget) {
   m_plot->xAxis->setRange(0, 1000);
   m_plot->yAxis->setRange(-10, 10);
 
+  // история каждой серии; первая (сырые данные) задает окно по времени
+  m_histories.clear();
+  m_histories.emplace_back(m_rawDataGraph, Constants::DISPLAY_HISTORY_SAMPLES,
+                           "Raw");
+  m_histories.emplace_back(m_movingAvgGraph,
+                           Constants::DISPLAY_HISTORY_SAMPLES, "MovingAverage");
+  m_histories.emplace_back(m_medianGraph, Constants::DISPLAY_HISTORY_SAMPLES,
+                           "Median");
+  m_histories.emplace_back(m_exponentialGraph,
+                           Constants::DISPLAY_HISTORY_SAMPLES, "Exponential");
+  m_histories.emplace_back(m_kalmanGraph, Constants::DISPLAY_HISTORY_SAMPLES,
+                           "Kalman");
+
+  // при перетаскивании и масштабировании прореживание пересчитывается
+  connect(m_plot->xAxis,
+          QOverload<const QCPRange &>::of(&QCPAxis::rangeChanged), this,
+          &GraphManager::onSignalRangeChanged);
+
   m_tabWidget->addTab(m_plot, "Сигнал");
 
   m_plot->setVisible(true);
@@ -131,6 +159,7 @@ void GraphManager::updateGraph(const std::vector<GraphSeries> &series,
   if (!m_plot) {
     return;
   }
+  TRACE_SCOPE("GraphManager::updateGraph");
 
   // проверяем валидность всех графиков и буферов
   bool allValid = true;
@@ -146,25 +175,33 @@ void GraphManager::updateGraph(const std::vector<GraphSeries> &series,
   }
 
   try {
-    // читаем данные из буферов и добавляем на графики
-    for (const auto &s : series) {
-      std::vector<DataPoint> data;
-      if (readBufferData(s.buffer, data)) {
-        addPointsToGraph(s.graph, data);
+    // новые точки копятся в истории серий, на графики они не идут
+    {
+      TRACE_SCOPE("GraphManager::appendFromBuffer");
+      for (const auto &s : series) {
+        SeriesHistory *history = findHistory(s.graph);
+        if (history) {
+          appendFromBuffer(*history, s.buffer);
+        }
       }
     }
 
-    // собираем все графики для удаления старых точек
-    std::vector<QCPGraph *> allGraphs;
-    for (const auto &s : series) {
-      if (s.graph) {
-        allGraphs.push_back(s.graph);
-      }
+    // пока пользователь не увел окно в прошлое, оно едет за новыми данными
+    if (m_followLatest) {
+      followLastSamples(maxSamples);
     }
 
-    removeOldPoints(allGraphs, maxSamples);
-    m_plot->rescaleAxes();
-    m_plot->replot();
+    // на графики уходит только прореженная видимая часть истории
+    {
+      TRACE_SCOPE("GraphManager::rebuildLevelOfDetail");
+      rebuildLevelOfDetail(m_followLatest);
+    }
+    {
+      TRACE_SCOPE("QCustomPlot::replot");
+      m_plot->replot();
+    }
+
+    recordFrameLatency();
   } catch (const std::exception &e) {
     qWarning() << "[GraphManager::updateGraph] - ошибка:" << e.what();
   } catch (...) {
@@ -172,100 +209,68 @@ void GraphManager::updateGraph(const std::vector<GraphSeries> &series,
   }
 }
 
-void GraphManager::updateSpectrum(const std::vector<GraphSeries> &series,
-                                  bool isRunning) {
-  if (!m_spectrumPlot || !isRunning || !m_rawDataGraph) {
+void GraphManager::drawSpectrum(const SpectrumFrame &frame) {
+  if (!m_spectrumPlot) {
     return;
   }
+  TRACE_SCOPE("GraphManager::drawSpectrum");
 
-  constexpr size_t MIN_FFT_SIZE = 64;
-  constexpr size_t MAX_FFT_SIZE = 1024;
-
-  // оценка частоты дискретизации по данным на графике
-  double sampleRate = 50.0;
-  {
-    auto rawData = m_rawDataGraph->data();
-    if (rawData && rawData->size() >= 2) {
-      uint32_t totalTime = 0;
-      int validPairs = 0;
-
-      auto itPrev = rawData->constBegin();
-      for (auto it = rawData->constBegin() + 1; it != rawData->constEnd();
-           ++it) {
-        uint32_t tsPrev = static_cast<uint32_t>(itPrev->key);
-        uint32_t tsCur = static_cast<uint32_t>(it->key);
-        uint32_t dt = tsCur - tsPrev;
-        if (dt > 0 && dt < 10000) {
-          totalTime += dt;
-          ++validPairs;
-        }
-        itPrev = it;
-      }
-
-      if (validPairs > 0 && totalTime > 0) {
-        double avgIntervalMs = static_cast<double>(totalTime) / validPairs;
-        if (avgIntervalMs > 0.0) {
-          sampleRate = 1000.0 / avgIntervalMs;
-        }
-      }
-    }
-  }
-
-  // вычисление спектра одного сигнала по данным из графика
-  auto computeAndPlotSpectrumFromGraph = [&](QCPGraph *sourceGraph,
-                                             QCPGraph *spectrumGraph) {
-    if (!sourceGraph || !spectrumGraph) {
-      return;
+  // спектры уже посчитаны в потоке анализа, здесь только перенос точек
+  for (const SpectrumSeries &series : frame.series) {
+    QCPGraph *spectrumGraph = getSpectrumGraph(series.name);
+    if (!spectrumGraph || !series.valid) {
+      continue;
     }
 
-    auto data = sourceGraph->data();
-    if (!data || data->size() < MIN_FFT_SIZE) {
-      return;
-    }
-
-    const int count =
-        static_cast<int>(std::min<size_t>(MAX_FFT_SIZE, data->size()));
-
-    std::vector<float> values;
-    values.reserve(count);
-    auto it = data->constEnd();
-    for (int i = 0; i < count; ++i) {
-      --it;
-      values.push_back(static_cast<float>(it->value));
-      if (it == data->constBegin()) {
-        break;
+    const size_t spectrumSize = series.amplitudes.size();
+    auto spectrumData = spectrumGraph->data();
+    if (static_cast<size_t>(spectrumData->size()) == spectrumSize) {
+      // размер не изменился: переписываем точки на месте, без выделений.
+      // частоты растут с индексом, порядок ключей сохраняется
+      size_t i = 0;
+      for (auto point = spectrumData->begin(); point != spectrumData->end();
+           ++point, ++i) {
+        point->key = series.frequencies[i];
+        point->value = series.amplitudes[i];
+      }
+    } else {
+      spectrumData->clear();
+      for (size_t i = 0; i < spectrumSize; ++i) {
+        spectrumGraph->addData(series.frequencies[i], series.amplitudes[i]);
       }
     }
+  }
 
-    if (values.size() < MIN_FFT_SIZE) {
-      return;
-    }
-
-    // вычисляем амплитудный спектр
-    std::vector<double> amplitudes = FFT::computeAmplitudeSpectrum(values);
-    std::vector<double> frequencies =
-        FFT::computeFrequencies(amplitudes.size(), sampleRate);
-
-    // очищаем старые данные спектра
-    spectrumGraph->data()->clear();
+  m_spectrumPlot->rescaleAxes();
+  TRACE_SCOPE("QCustomPlot::replot spectrum");
+  m_spectrumPlot->replot();
+}
 
-    // добавляем только первую половину спектра
-    size_t spectrumSize = amplitudes.size() / 2;
-    for (size_t i = 0; i < spectrumSize; ++i) {
-      spectrumGraph->addData(frequencies[i], amplitudes[i]);
-    }
-  };
+void GraphManager::setHistoryStore(HistoryStore *store) {
+  m_historyStore = store;
+}
 
-  // вычисляем спектр для всех серий
-  computeAndPlotSpectrumFromGraph(m_rawDataGraph, m_rawSpectrumGraph);
-  computeAndPlotSpectrumFromGraph(m_movingAvgGraph, m_movingAvgSpectrumGraph);
-  computeAndPlotSpectrumFromGraph(m_medianGraph, m_medianSpectrumGraph);
-  computeAndPlotSpectrumFromGraph(m_exponentialGraph,
-                                  m_exponentialSpectrumGraph);
-  computeAndPlotSpectrumFromGraph(m_kalmanGraph, m_kalmanSpectrumGraph);
+void GraphManager::setLatency(PipelineLatency *latency) {
+  m_latency = latency;
+}
 
-  m_spectrumPlot->rescaleAxes();
-  m_spectrumPlot->replot();
+QCPGraph *GraphManager::getSpectrumGraph(const std::string &name) const {
+  if (name == "Raw") {
+    return m_rawSpectrumGraph;
+  }
+  if (name == "MovingAverage") {
+    return m_movingAvgSpectrumGraph;
+  }
+  if (name == "Median") {
+    return m_medianSpectrumGraph;
+  }
+  if (name == "Exponential") {
+    return m_exponentialSpectrumGraph;
+  }
+  if (name == "Kalman") {
+    return m_kalmanSpectrumGraph;
+  }
+  return nullptr;
 }
 
 void GraphManager::setSeriesVisible(const QString &name, bool visible) {
@@ -294,48 +299,177 @@ void GraphManager::setSeriesVisible(const QString &name, bool visible) {
   }
 }
 
-bool GraphManager::readBufferData(ThreadSafeRingBuffer<DataPoint> *buffer,
-                                  std::vector<DataPoint> &data) {
+GraphManager::SeriesHistory *GraphManager::findHistory(QCPGraph *graph) {
+  for (SeriesHistory &history : m_histories) {
+    if (history.graph == graph) {
+      return &history;
+    }
+  }
+  return nullptr;
+}
+
+void GraphManager::appendFromBuffer(SeriesHistory &history,
+                                    IBufferReader<DataPoint> *buffer) {
   if (!buffer) {
-    return false;
+    return;
   }
 
   try {
-    data = buffer->popAll();
-    return true;
-  } catch (const std::exception &e) {
-    return false;
+    size_t count = 0;
+    while ((count = buffer->popBulkStamped(m_readBlock.data(),
+                                           m_readStamps.data(),
+                                           m_readBlock.size())) > 0) {
+      // сводки уровней достраиваются по мере поступления отсчетов
+      history.store.append(m_readBlock.data(), count);
+      history.newest = m_readStamps[count - 1];
+      history.hasNewest = true;
+      if (count < m_readBlock.size()) {
+        break;
+      }
+    }
   } catch (...) {
-    return false;
+    return;
   }
 }
 
-void GraphManager::addPointsToGraph(QCPGraph *graph,
-                                    const std::vector<DataPoint> &data) {
-  if (!graph) {
-    return;
+void GraphManager::recordFrameLatency() {
+  // возраст самой свежей точки на экране: по одному значению на видимую
+  // серию за кадр. если окно увели в прошлое, новых точек на экране нет
+  const bool onScreen = m_latency && m_followLatest;
+  const uint64_t renderedNs = monotonicNs();
+  for (SeriesHistory &history : m_histories) {
+    if (onScreen && history.hasNewest && history.graph->visible()) {
+      m_latency->filterToPlot.recordSince(history.newest.publishedNs,
+                                          renderedNs);
+      m_latency->endToEnd.recordSince(history.newest.receivedNs, renderedNs);
+    }
+    history.hasNewest = false;
   }
+}
 
-  for (const auto &point : data) {
-    graph->addData(point.timestamp, point.value);
+void GraphManager::followLastSamples(size_t maxSamples) {
+  if (m_histories.empty() || m_histories[0].store.empty()) {
+    return;
   }
+
+  // по времени показываем последние maxSamples точек опорной серии
+  const TimeSeriesPyramid &reference = m_histories[0].store;
+  const size_t first =
+      reference.size() > maxSamples ? reference.size() - maxSamples : 0;
+  QCPRange keyRange(reference.keyAt(first), reference.lastKey());
+
+  // изменение диапазона отсюда не должно вызывать лишний пересчет
+  m_followingRange = true;
+  setAxisRange(m_plot->xAxis, keyRange);
+  m_followingRange = false;
 }
 
-void GraphManager::removeOldPoints(const std::vector<QCPGraph *> &graphs,
-                                   size_t maxSamples) {
-  if (graphs.empty() || !graphs[0]) {
+void GraphManager::rebuildLevelOfDetail(bool rescaleValueAxis) {
+  if (!m_plot) {
     return;
   }
 
-  QCPGraph *referenceGraph = graphs[0];
-  if (referenceGraph->dataCount() > maxSamples) {
-    double removeKey =
-        referenceGraph->dataMainKey(referenceGraph->dataCount() - maxSamples);
+  // столбец на пиксель: больше точек на экране все равно не различить
+  const size_t columns =
+      static_cast<size_t>(std::max(1, m_plot->axisRect()->width()));
+  const QCPRange keyRange = m_plot->xAxis->range();
+
+  const size_t capacity = MinMaxDecimator::maxOutputSize(columns);
+  m_lodKeys.resize(capacity);
+  m_lodValues.resize(capacity);
 
-    for (QCPGraph *graph : graphs) {
-      if (graph) {
-        graph->data()->removeBefore(removeKey);
+  QCPRange valueRange;
+  bool haveRange = false;
+
+  for (SeriesHistory &history : m_histories) {
+    if (!history.graph) {
+      continue;
+    }
+
+    // окно любого масштаба собирается из готовых сводок истории
+    size_t count = queryHistory(history, keyRange, columns);
+
+    // пишем прямо в контейнер графика: clear() оставляет память его
+    // вектора, ключи по возрастанию, и add() просто дописывает. set()
+    // делит вектор с контейнером, запись в свой вектор его бы копировала
+    QCPGraphDataContainer *points = history.graph->data().data();
+    points->clear();
+    for (size_t i = 0; i < count; ++i) {
+      points->add(QCPGraphData(m_lodKeys[i], m_lodValues[i]));
+
+      // min/max столбцов сохранены, так что диапазон значений точный.
+      // соседние точки за краями окна в него не входят
+      if (m_lodKeys[i] < keyRange.lower || m_lodKeys[i] > keyRange.upper) {
+        continue;
+      }
+      if (haveRange) {
+        valueRange.expand(m_lodValues[i]);
+      } else {
+        valueRange = QCPRange(m_lodValues[i], m_lodValues[i]);
+        haveRange = true;
       }
     }
   }
+
+  if (rescaleValueAxis && haveRange) {
+    setAxisRange(m_plot->yAxis, valueRange);
+  }
+}
+
+size_t GraphManager::queryHistory(SeriesHistory &history,
+                                  const QCPRange &keyRange, size_t columns) {
+  // окно целиком в памяти - диск не нужен
+  const TimeSeriesPyramid &memory = history.store;
+  const bool inMemory = !memory.empty() && keyRange.lower >= memory.keyAt(0);
+
+  if (m_historyStore && !inMemory) {
+    // окно начинается раньше истории в памяти: подгружаем видимые чанки
+    // с диска. последний период записи там может быть еще не виден
+    int series = m_historyStore->findSeries(history.diskName);
+    if (series >= 0) {
+      try {
+        size_t count = m_historyStore->query(
+            static_cast<size_t>(series), keyRange.lower, keyRange.upper,
+            columns, m_lodKeys.data(), m_lodValues.data());
+        if (count > 0) {
+          return count;
+        }
+      } catch (const std::exception &e) {
+        qWarning() << "[GraphManager] - история на диске недоступна:"
+                   << e.what();
+      }
+    }
+  }
+
+  return memory.query(keyRange.lower, keyRange.upper, columns,
+                      m_lodKeys.data(), m_lodValues.data());
+}
+
+void GraphManager::onSignalRangeChanged(const QCPRange &range) {
+  if (m_followingRange) {
+    return;
+  }
+
+  // пользователь сдвинул или масштабировал график. если правый край ушел
+  // в прошлое, окно перестает ехать за данными, пока его не вернут к
+  // последнему отсчету
+  if (!m_histories.empty() && !m_histories[0].store.empty()) {
+    m_followLatest = range.upper >= m_histories[0].store.lastKey();
+  }
+
+  // пересчитываем прореживание для нового окна, перерисовку QCustomPlot
+  // запланирует сам
+  rebuildLevelOfDetail(false);
+}
+
+void GraphManager::setAxisRange(QCPAxis *axis, const QCPRange &range) {
+  if (QCPRange::validRange(range)) {
+    axis->setRange(range);
+    return;
+  }
+
+  // вырожденный диапазон (одна точка или постоянный сигнал): как
+  // rescaleAxes, центрируем его, сохраняя текущий размер оси
+  double center = (range.lower + range.upper) * 0.5;
+  axis->setRange(center, axis->range().size(), Qt::AlignCenter);
 }
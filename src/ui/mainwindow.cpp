@@ -4,24 +4,32 @@
 #include "../../include/ui/statusbarmanager.h"
 #include "ui_mainwindow.h"
 
+#include "../../include/core/trace.h"
 #include "../../include/filters/exponentialfilter.h"
 #include "../../include/filters/kalmanfilter.h"
 #include "../../include/filters/medianfilter.h"
 #include "../../include/filters/movingaveragefilter.h"
 
 #include <QApplication>
+#include <QDateTime>
 #include <QDebug>
+#include <QDir>
+#include <QFileDialog>
 #include <QGroupBox>
 #include <QHBoxLayout>
 #include <QMessageBox>
+#include <QStandardPaths>
 #include <QTabWidget>
 #include <QVBoxLayout>
 #include <cstdlib>
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), m_movingAvgBuffer(nullptr), m_medianBuffer(nullptr),
+    : QMainWindow(parent), m_rawDataDisplayBuffer(nullptr),
+      m_rawBufferMovingAvg(nullptr), m_rawBufferMedian(nullptr),
+      m_rawBufferExponential(nullptr), m_rawBufferKalman(nullptr),
+      m_movingAvgBuffer(nullptr), m_medianBuffer(nullptr),
       m_exponentialBuffer(nullptr), m_kalmanBuffer(nullptr),
-      m_updateTimer(nullptr), m_isRunning(false),
+      m_isReplaying(false), m_updateTimer(nullptr), m_isRunning(false),
       m_maxSamples(Constants::DEFAULT_DISPLAY_SAMPLES), ui(new Ui::MainWindow) {
   if (!ui) {
     qFatal("Failed to create UI object");
@@ -30,10 +38,27 @@ MainWindow::MainWindow(QWidget *parent)
 
   ui->setupUi(this);
   setWindowTitle("PID Visualizer");
+  Trace::setThreadName("GUI");
   setupComponents();
 }
 
 MainWindow::~MainWindow() {
+  if (m_spectrumAnalyzer) {
+    m_spectrumAnalyzer->stop();
+  }
+
+  if (m_historyStore) {
+    m_historyStore->stop();
+  }
+
+  if (m_sessionRecorder) {
+    m_sessionRecorder->stop();
+  }
+
+  if (m_replaySource) {
+    m_replaySource->stop();
+  }
+
   if (m_dataProcessor && m_dataProcessor->isRunning()) {
     m_dataProcessor->stop();
   }
@@ -51,43 +76,24 @@ MainWindow::~MainWindow() {
 
 void MainWindow::setupComponents() {
   // создаем буферы для данных
-  m_rawDataDisplayBuffer = std::make_unique<ThreadSafeRingBuffer<DataPoint>>(
-      Constants::DEFAULT_BUFFER_SIZE);
-  m_rawBufferMovingAvg = std::make_unique<ThreadSafeRingBuffer<DataPoint>>(
-      Constants::DEFAULT_BUFFER_SIZE);
-  m_rawBufferMedian = std::make_unique<ThreadSafeRingBuffer<DataPoint>>(
-      Constants::DEFAULT_BUFFER_SIZE);
-  m_rawBufferExponential = std::make_unique<ThreadSafeRingBuffer<DataPoint>>(
-      Constants::DEFAULT_BUFFER_SIZE);
-  m_rawBufferKalman = std::make_unique<ThreadSafeRingBuffer<DataPoint>>(
-      Constants::DEFAULT_BUFFER_SIZE);
-
-  // рассылаем каждую точку во все буферы
-  auto fanOutToBuffers = [this](const DataPoint &point) {
-    if (m_rawDataDisplayBuffer) {
-      m_rawDataDisplayBuffer->push(point);
-    }
-    if (m_rawBufferMovingAvg) {
-      m_rawBufferMovingAvg->push(point);
-    }
-    if (m_rawBufferMedian) {
-      m_rawBufferMedian->push(point);
-    }
-    if (m_rawBufferExponential) {
-      m_rawBufferExponential->push(point);
-    }
-    if (m_rawBufferKalman) {
-      m_rawBufferKalman->push(point);
-    }
-  };
+  // один журнал сырых данных на всех: поток приема пишет каждый отсчет
+  // один раз, график и фильтры читают его своими курсорами
+  m_rawStream = std::make_unique<BroadcastRingBuffer<DataPoint>>(
+      Constants::RAW_STREAM_CAPACITY);
+  m_rawDataDisplayBuffer = m_rawStream->createReader();
+  m_rawBufferMovingAvg = m_rawStream->createReader();
+  m_rawBufferMedian = m_rawStream->createReader();
+  m_rawBufferExponential = m_rawStream->createReader();
+  m_rawBufferKalman = m_rawStream->createReader();
 
   // создаем NetworkController
   m_networkController = std::make_unique<NetworkController>();
-  m_networkController->initialize(m_rawDataDisplayBuffer.get(),
-                                  fanOutToBuffers);
+  m_networkController->initialize(m_rawStream.get(), nullptr);
+  m_networkController->setLatencyHistogram(&m_latency.socketToRing);
 
   // создаем GraphManager
   m_graphManager = std::make_unique<GraphManager>(this);
+  m_graphManager->setLatency(&m_latency);
 
   setupFilters();
 
@@ -142,9 +148,10 @@ void MainWindow::setupComponents() {
                                  m_exponentialFilter.get(),
                                  m_kalmanFilter.get());
   m_statusBarManager->setFilterBuffers(
-      m_rawBufferMovingAvg.get(), m_movingAvgBuffer, m_rawBufferMedian.get(),
-      m_medianBuffer, m_rawBufferExponential.get(), m_exponentialBuffer,
-      m_rawBufferKalman.get(), m_kalmanBuffer);
+      m_rawBufferMovingAvg, m_movingAvgBuffer, m_rawBufferMedian,
+      m_medianBuffer, m_rawBufferExponential, m_exponentialBuffer,
+      m_rawBufferKalman, m_kalmanBuffer);
+  m_statusBarManager->setLatency(&m_latency);
 
   setupTimer();
   connectSignals();
@@ -170,6 +177,7 @@ void MainWindow::setupComponents() {
 void MainWindow::setupFilters() {
   // создаем data processor
   m_dataProcessor = std::make_unique<DataProcessor>();
+  m_dataProcessor->setLatencyHistogram(&m_latency.ringToFilter);
 
   // создаем фильтры
   m_movingAvgFilter = std::make_unique<MovingAverageFilter>(
@@ -184,14 +192,57 @@ void MainWindow::setupFilters() {
                                      Constants::Filters::DEFAULT_KALMAN_P);
 
   // добавляем фильтры в data processor
-  m_movingAvgBuffer = m_dataProcessor->addFilter(
-      m_movingAvgFilter.get(), m_rawBufferMovingAvg.get(), "MovingAverage");
-  m_medianBuffer = m_dataProcessor->addFilter(
-      m_medianFilter.get(), m_rawBufferMedian.get(), "Median");
-  m_exponentialBuffer = m_dataProcessor->addFilter(
-      m_exponentialFilter.get(), m_rawBufferExponential.get(), "Exponential");
-  m_kalmanBuffer = m_dataProcessor->addFilter(
-      m_kalmanFilter.get(), m_rawBufferKalman.get(), "Kalman");
+  BroadcastRingBuffer<DataPoint> *movingAvgOutput = m_dataProcessor->addFilter(
+      m_movingAvgFilter.get(), m_rawBufferMovingAvg, "MovingAverage");
+  BroadcastRingBuffer<DataPoint> *medianOutput = m_dataProcessor->addFilter(
+      m_medianFilter.get(), m_rawBufferMedian, "Median");
+  BroadcastRingBuffer<DataPoint> *exponentialOutput =
+      m_dataProcessor->addFilter(m_exponentialFilter.get(),
+                                 m_rawBufferExponential, "Exponential");
+  BroadcastRingBuffer<DataPoint> *kalmanOutput = m_dataProcessor->addFilter(
+      m_kalmanFilter.get(), m_rawBufferKalman, "Kalman");
+
+  // график читает результаты своими курсорами
+  m_movingAvgBuffer = movingAvgOutput->createReader();
+  m_medianBuffer = medianOutput->createReader();
+  m_exponentialBuffer = exponentialOutput->createReader();
+  m_kalmanBuffer = kalmanOutput->createReader();
+
+  // расчет спектров читает те же журналы независимо от графика
+  m_spectrumAnalyzer = std::make_unique<SpectrumAnalyzer>();
+  m_spectrumAnalyzer->addSeries("Raw", m_rawStream->createReader());
+  m_spectrumAnalyzer->addSeries("MovingAverage",
+                                movingAvgOutput->createReader());
+  m_spectrumAnalyzer->addSeries("Median", medianOutput->createReader());
+  m_spectrumAnalyzer->addSeries("Exponential",
+                                exponentialOutput->createReader());
+  m_spectrumAnalyzer->addSeries("Kalman", kalmanOutput->createReader());
+
+  // история на диск: каталог сессии переиспользуется, при каждом старте
+  // записи он очищается
+  QString historyDirectory =
+      QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) +
+      "/history";
+  m_historyStore =
+      std::make_unique<HistoryStore>(historyDirectory.toStdString());
+  m_historyStore->addSeries("Raw", m_rawStream->createReader());
+  m_historyStore->addSeries("MovingAverage", movingAvgOutput->createReader());
+  m_historyStore->addSeries("Median", medianOutput->createReader());
+  m_historyStore->addSeries("Exponential", exponentialOutput->createReader());
+  m_historyStore->addSeries("Kalman", kalmanOutput->createReader());
+  m_graphManager->setHistoryStore(m_historyStore.get());
+
+  // запись сессии: сырые данные и выходы всех фильтров
+  m_sessionRecorder = std::make_unique<SessionRecorder>();
+  m_sessionRecorder->addSeries("Raw", m_rawStream->createReader());
+  m_sessionRecorder->addSeries("MovingAverage",
+                               movingAvgOutput->createReader());
+  m_sessionRecorder->addSeries("Median", medianOutput->createReader());
+  m_sessionRecorder->addSeries("Exponential",
+                               exponentialOutput->createReader());
+  m_sessionRecorder->addSeries("Kalman", kalmanOutput->createReader());
+
+  m_replaySource = std::make_unique<ReplaySource>(m_rawStream.get());
 }
 
 void MainWindow::setupTimer() {
@@ -208,9 +259,40 @@ void MainWindow::connectSignals() {
   connect(ui->pushButton_3, &QPushButton::clicked, this,
           &MainWindow::onStartStopButtonClicked);
 
+  connect(ui->pushButtonReplay, &QPushButton::clicked, this,
+          &MainWindow::onReplayButtonClicked);
+
   connect(ui->spinBox, QOverload<int>::of(&QSpinBox::valueChanged),
           [this](int value) { m_maxSamples = static_cast<size_t>(value); });
 
+  // запись истории на диск: выключение останавливает запись, записанное
+  // остается доступным для просмотра до следующего включения
+  connect(ui->checkBoxHistoryEnable, &QCheckBox::toggled, [this](bool checked) {
+    if (checked && m_isRunning)
+      startHistory();
+    else if (!checked && m_historyStore)
+      m_historyStore->stop();
+  });
+
+  // запись сессии: каждое включение при работающем приеме - новый файл
+  connect(ui->checkBoxRecordEnable, &QCheckBox::toggled, [this](bool checked) {
+    if (checked && m_isRunning)
+      startRecording();
+    else if (!checked && m_sessionRecorder)
+      m_sessionRecorder->stop();
+  });
+
+  // трассировка: включение начинает трассу заново, выключение сохраняет
+  connect(ui->checkBoxTraceEnable, &QCheckBox::toggled, [this](bool checked) {
+    if (checked) {
+      Trace::clear();
+      Trace::setEnabled(true);
+    } else {
+      Trace::setEnabled(false);
+      saveTrace();
+    }
+  });
+
   // включение/выключение фильтров
   connect(ui->checkBoxMovingAverageEnable, &QCheckBox::toggled,
           [this](bool checked) {
@@ -307,6 +389,69 @@ void MainWindow::connectSignals() {
   }
 }
 
+void MainWindow::startHistory() {
+  if (!m_historyStore) {
+    return;
+  }
+
+  try {
+    m_historyStore->start();
+  } catch (const std::exception &e) {
+    QMessageBox::warning(this, "Ошибка",
+                         QString("Не удалось начать запись истории: %1")
+                             .arg(e.what()));
+  }
+}
+
+void MainWindow::startRecording() {
+  if (!m_sessionRecorder) {
+    return;
+  }
+
+  QString directory =
+      QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) +
+      "/recordings";
+  QString path =
+      directory + "/session-" +
+      QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".pidrec";
+
+  try {
+    if (!QDir().mkpath(directory)) {
+      throw std::runtime_error("cannot create " + directory.toStdString());
+    }
+    m_sessionRecorder->start(path.toStdString());
+    qDebug() << "Запись сессии в" << path;
+  } catch (const std::exception &e) {
+    QMessageBox::warning(this, "Ошибка",
+                         QString("Не удалось начать запись сессии: %1")
+                             .arg(e.what()));
+  }
+}
+
+void MainWindow::saveTrace() {
+  QString directory =
+      QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) +
+      "/traces";
+  QString path =
+      directory + "/trace-" +
+      QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".json";
+
+  const size_t events = Trace::eventCount();
+  if (!QDir().mkpath(directory) ||
+      !Trace::writeChromeJson(path.toStdString())) {
+    QMessageBox::warning(this, "Ошибка",
+                         QString("Не удалось сохранить трассу в %1").arg(path));
+    return;
+  }
+  qDebug() << "Трасса сохранена в" << path;
+  QMessageBox::information(
+      this, "Трасса сохранена",
+      QString("%1 событий, откройте файл в chrome://tracing или "
+              "ui.perfetto.dev:\n%2")
+          .arg(events)
+          .arg(path));
+}
+
 void MainWindow::onSendButtonClicked() {
   if (!m_networkController) {
     return;
@@ -350,39 +495,36 @@ void MainWindow::onStartStopButtonClicked() {
     uint16_t port = static_cast<uint16_t>(ui->spinBox_2->value());
 
     if (m_networkController->startReceiver(ip.toStdString(), port)) {
-      if (m_dataProcessor) {
-        if (ui->checkBoxMovingAverageEnable->isChecked())
-          m_dataProcessor->startFilter("MovingAverage");
-        if (ui->checkBoxMedianEnable->isChecked())
-          m_dataProcessor->startFilter("Median");
-        if (ui->checkBoxExponentialEnable->isChecked())
-          m_dataProcessor->startFilter("Exponential");
-        if (ui->checkBoxKalmanEnable && ui->checkBoxKalmanEnable->isChecked())
-          m_dataProcessor->startFilter("Kalman");
-      }
-
-      m_isRunning = true;
-
-      if (m_updateTimer && !m_updateTimer->isActive()) {
-        m_updateTimer->start();
-      }
-
-      ui->pushButton_3->setText("Стоп");
-      if (m_statusBarManager) {
-        m_statusBarManager->updateStatus(m_isRunning);
+      if (ui->checkBoxRecordEnable->isChecked()) {
+        startRecording();
       }
+      startPipeline();
     } else {
       QMessageBox::warning(this, "Ошибка", "Не удалось запустить прием данных");
     }
   } else {
     m_isRunning = false;
+    m_isReplaying = false;
     ui->pushButton_3->setText("Старт");
+    ui->pushButtonReplay->setEnabled(true);
 
     if (m_updateTimer && m_updateTimer->isActive()) {
       m_updateTimer->stop();
     }
 
     QTimer::singleShot(0, this, [this]() {
+      if (m_replaySource) {
+        m_replaySource->stop();
+      }
+      if (m_spectrumAnalyzer) {
+        m_spectrumAnalyzer->stop();
+      }
+      if (m_historyStore) {
+        m_historyStore->stop();
+      }
+      if (m_sessionRecorder) {
+        m_sessionRecorder->stop();
+      }
       if (m_dataProcessor) {
         m_dataProcessor->stop();
       }
@@ -397,10 +539,137 @@ void MainWindow::onStartStopButtonClicked() {
   }
 }
 
+void MainWindow::onReplayButtonClicked() {
+  if (m_isRunning || !m_replaySource) {
+    return;
+  }
+
+  QString directory =
+      QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) +
+      "/recordings";
+  QString path = QFileDialog::getOpenFileName(
+      this, "Воспроизвести запись", directory, "Запись сессии (*.pidrec)");
+  if (path.isEmpty()) {
+    return;
+  }
+
+  try {
+    m_replaySource->open(path.toStdString());
+  } catch (const std::exception &e) {
+    QMessageBox::warning(this, "Ошибка",
+                         QString("Не удалось открыть запись: %1")
+                             .arg(e.what()));
+    return;
+  }
+
+  // в режиме "максимально быстро" воспроизведение ждет только включенные
+  // фильтры, по ним же считается пропускная способность
+  m_replaySource->clearConsumers();
+  if (ui->checkBoxMovingAverageEnable->isChecked())
+    m_replaySource->addConsumer("MovingAverage", m_rawBufferMovingAvg);
+  if (ui->checkBoxMedianEnable->isChecked())
+    m_replaySource->addConsumer("Median", m_rawBufferMedian);
+  if (ui->checkBoxExponentialEnable->isChecked())
+    m_replaySource->addConsumer("Exponential", m_rawBufferExponential);
+  if (ui->checkBoxKalmanEnable->isChecked())
+    m_replaySource->addConsumer("Kalman", m_rawBufferKalman);
+
+  ReplaySource::Pacing pacing = ReplaySource::Pacing::Scaled;
+  double speed = 1.0;
+  switch (ui->comboBoxReplaySpeed->currentIndex()) {
+  case 0:
+    pacing = ReplaySource::Pacing::RealTime;
+    break;
+  case 1:
+    speed = 10.0;
+    break;
+  case 2:
+    speed = 100.0;
+    break;
+  default:
+    pacing = ReplaySource::Pacing::AsFastAsPossible;
+    break;
+  }
+
+  // фильтры должны читать с начала записи: старт до публикации отсчетов
+  startPipeline();
+  if (!m_replaySource->start(pacing, speed)) {
+    onStartStopButtonClicked();
+    QMessageBox::warning(this, "Ошибка", "Не удалось начать воспроизведение");
+    return;
+  }
+  m_isReplaying = true;
+  ui->pushButtonReplay->setEnabled(false);
+}
+
+void MainWindow::startPipeline() {
+  if (m_dataProcessor) {
+    if (ui->checkBoxMovingAverageEnable->isChecked())
+      m_dataProcessor->startFilter("MovingAverage");
+    if (ui->checkBoxMedianEnable->isChecked())
+      m_dataProcessor->startFilter("Median");
+    if (ui->checkBoxExponentialEnable->isChecked())
+      m_dataProcessor->startFilter("Exponential");
+    if (ui->checkBoxKalmanEnable && ui->checkBoxKalmanEnable->isChecked())
+      m_dataProcessor->startFilter("Kalman");
+  }
+
+  if (m_spectrumAnalyzer) {
+    m_spectrumAnalyzer->start();
+  }
+
+  if (ui->checkBoxHistoryEnable->isChecked()) {
+    startHistory();
+  }
+
+  m_isRunning = true;
+
+  if (m_updateTimer && !m_updateTimer->isActive()) {
+    m_updateTimer->start();
+  }
+
+  ui->pushButton_3->setText("Стоп");
+  if (m_statusBarManager) {
+    m_statusBarManager->updateStatus(m_isRunning);
+  }
+}
+
+void MainWindow::reportReplay() {
+  m_isReplaying = false;
+
+  QString report = QString("Воспроизведено отсчетов: %1 из %2\n")
+                       .arg(m_replaySource->getSamplesReplayed())
+                       .arg(m_replaySource->getTotalSamples());
+  const std::string error = m_replaySource->getError();
+  if (!error.empty()) {
+    report += QString("Запись оборвалась: %1\n")
+                  .arg(QString::fromStdString(error));
+    qWarning() << "Воспроизведение:" << QString::fromStdString(error);
+  }
+  for (const ReplaySource::ConsumerReport &consumer :
+       m_replaySource->getConsumerReports()) {
+    QString line = QString("%1: ").arg(QString::fromStdString(consumer.name));
+    if (consumer.stalled) {
+      line += QString("перестал читать после %1 отсч").arg(consumer.samples);
+    } else {
+      line += QString("%1 отсч/с").arg(consumer.samplesPerSecond, 0, 'f', 0);
+    }
+    report += "\n" + line;
+    qDebug() << "Воспроизведение:" << line;
+  }
+
+  if (error.empty()) {
+    QMessageBox::information(this, "Воспроизведение завершено", report);
+  } else {
+    QMessageBox::warning(this, "Воспроизведение прервано", report);
+  }
+}
+
 void MainWindow::updateGraph() {
   if (!m_graphManager || !m_isRunning) {
     return;
   }
+  TRACE_SCOPE("MainWindow::updateGraph");
 
   if (!m_rawDataDisplayBuffer || !m_movingAvgBuffer || !m_medianBuffer ||
       !m_exponentialBuffer || !m_kalmanBuffer) {
@@ -409,7 +678,7 @@ void MainWindow::updateGraph() {
 
   // подготавливаем структуры для работы с графиками и буферами
   std::vector<GraphSeries> graphSeries = {
-      {m_graphManager->getRawDataGraph(), m_rawDataDisplayBuffer.get(), "Raw"},
+      {m_graphManager->getRawDataGraph(), m_rawDataDisplayBuffer, "Raw"},
       {m_graphManager->getMovingAvgGraph(), m_movingAvgBuffer, "MovingAverage"},
       {m_graphManager->getMedianGraph(), m_medianBuffer, "Median"},
       {m_graphManager->getExponentialGraph(), m_exponentialBuffer,
@@ -422,11 +691,14 @@ void MainWindow::updateGraph() {
     m_statusBarManager->updateStatus(m_isRunning);
   }
 
-  // обновляем спектр реже, чем график сигнала
-  static int spectrumUpdateCounter = 0;
-  if (++spectrumUpdateCounter >=
-      Constants::Performance::SPECTRUM_UPDATE_INTERVAL) {
-    spectrumUpdateCounter = 0;
-    m_graphManager->updateSpectrum(graphSeries, m_isRunning);
+  // запись кончилась: график и фильтры продолжают работать до "Стоп"
+  if (m_isReplaying && m_replaySource && m_replaySource->isFinished()) {
+    reportReplay();
+  }
+
+  // спектр считается в SpectrumAnalyzer, здесь рисуем только свежий кадр.
+  // кадры, которые GUI не успел забрать, анализатор выбрасывает сам
+  if (m_spectrumAnalyzer && m_spectrumAnalyzer->takeLatest(m_spectrumFrame)) {
+    m_graphManager->drawSpectrum(m_spectrumFrame);
   }
 }
@@ -1,20 +1,23 @@
 #include "../../include/ui/statusbarmanager.h"
 #include "../../include/core/datapoint.h"
 #include "../../include/core/processmemory.h"
+#include "../../include/core/trace.h"
 #include "../../include/core/threadsaferingbuffer.h"
 #include "../../include/filters/exponentialfilter.h"
 #include "../../include/filters/kalmanfilter.h"
 #include "../../include/filters/medianfilter.h"
 #include "../../include/filters/movingaveragefilter.h"
+#include "../../include/network/networkcontroller.h"
+#include "../../include/core/Constants.h"
 #include "../../include/processing/dataprocessor.h"
-#include "../../include/ui/networkcontroller.h"
 
 #include <QLabel>
 #include <QStatusBar>
 
 StatusBarManager::StatusBarManager(QObject *parent)
     : QObject(parent), m_statusBar(nullptr), m_networkController(nullptr),
-      m_dataProcessor(nullptr), m_movingAvgStatsLabel(nullptr),
+      m_dataProcessor(nullptr), m_latency(nullptr),
+      m_movingAvgStatsLabel(nullptr),
       m_medianStatsLabel(nullptr), m_exponentialStatsLabel(nullptr),
       m_movingAvgMemoryLabel(nullptr), m_medianMemoryLabel(nullptr),
       m_exponentialMemoryLabel(nullptr), m_kalmanMemoryLabel(nullptr),
@@ -64,14 +67,14 @@ void StatusBarManager::setFilters(MovingAverageFilter *movingAvgFilter,
 }
 
 void StatusBarManager::setFilterBuffers(
-    ThreadSafeRingBuffer<DataPoint> *rawBufferMovingAvg,
-    ThreadSafeRingBuffer<DataPoint> *movingAvgBuffer,
-    ThreadSafeRingBuffer<DataPoint> *rawBufferMedian,
-    ThreadSafeRingBuffer<DataPoint> *medianBuffer,
-    ThreadSafeRingBuffer<DataPoint> *rawBufferExponential,
-    ThreadSafeRingBuffer<DataPoint> *exponentialBuffer,
-    ThreadSafeRingBuffer<DataPoint> *rawBufferKalman,
-    ThreadSafeRingBuffer<DataPoint> *kalmanBuffer) {
+    IBufferReader<DataPoint> *rawBufferMovingAvg,
+    IBufferReader<DataPoint> *movingAvgBuffer,
+    IBufferReader<DataPoint> *rawBufferMedian,
+    IBufferReader<DataPoint> *medianBuffer,
+    IBufferReader<DataPoint> *rawBufferExponential,
+    IBufferReader<DataPoint> *exponentialBuffer,
+    IBufferReader<DataPoint> *rawBufferKalman,
+    IBufferReader<DataPoint> *kalmanBuffer) {
   m_rawBufferMovingAvg = rawBufferMovingAvg;
   m_movingAvgBuffer = movingAvgBuffer;
   m_rawBufferMedian = rawBufferMedian;
@@ -82,6 +85,12 @@ void StatusBarManager::setFilterBuffers(
   m_kalmanBuffer = kalmanBuffer;
 }
 
+void StatusBarManager::setLatency(PipelineLatency *latency) {
+  m_latency = latency;
+  m_latencyText.clear();
+  m_latencyTimer.start();
+}
+
 void StatusBarManager::updateStatus(bool isRunning) {
   updateStatusBar(isRunning);
   updateFilterStats();
@@ -103,9 +112,20 @@ void StatusBarManager::updateStatusBar(bool isRunning) {
   if (isRunning) {
     status = "Работает";
     if (m_networkController) {
-      status += QString(" | Пакетов получено: %1")
-                    .arg(m_networkController->getPacketsReceived());
+      ReceiverStatistics stats = m_networkController->getReceiverStatistics();
+      status += QString(" | Пакетов получено: %1").arg(stats.packetsReceived);
+      status += QString(" | Потеряно: %1 | Не по порядку: %2 | Дубли: %3 | "
+                        "Разрывов: %4")
+                    .arg(stats.lost)
+                    .arg(stats.reordered)
+                    .arg(stats.duplicated)
+                    .arg(stats.gapEvents);
+      if (stats.lateDropped > 0) {
+        status += QString(" | Опоздали: %1").arg(stats.lateDropped);
+      }
     }
+    updateLatencyText();
+    status += m_latencyText;
   } else {
     status = "Остановлено";
   }
@@ -115,6 +135,10 @@ void StatusBarManager::updateStatusBar(bool isRunning) {
         QString(" | Отправлено: %1").arg(m_networkController->getPacketsSent());
   }
 
+  if (Trace::isEnabled()) {
+    status += QString(" | Трассировка: %1 событий").arg(Trace::eventCount());
+  }
+
   // память процесса из монитора ОС (фактическая ОЗУ: буферы, расчёты, Qt и
   // т.д.)
   double rssMb = ProcessMemory::getCurrentProcessRSSMegabytes();
@@ -125,6 +149,39 @@ void StatusBarManager::updateStatusBar(bool isRunning) {
   m_statusBar->showMessage(status);
 }
 
+void StatusBarManager::updateLatencyText() {
+  if (!m_latency || m_latencyTimer.elapsed() <
+                        Constants::Performance::LATENCY_REPORT_INTERVAL_MS) {
+    return;
+  }
+  m_latencyTimer.restart();
+
+  // p50/p99/max в мс за интервал: прием и фильтр по всем отсчетам,
+  // график и "всего" - возраст самой свежей точки каждой видимой серии
+  // в момент ее отрисовки
+  const struct {
+    const char *name;
+    LatencyHistogram &histogram;
+  } stages[] = {{"прием", m_latency->socketToRing},
+                {"фильтр", m_latency->ringToFilter},
+                {"график", m_latency->filterToPlot},
+                {"всего", m_latency->endToEnd}};
+  QString text;
+  for (const auto &stage : stages) {
+    const LatencySummary summary = stage.histogram.takeInterval();
+    if (summary.count == 0) {
+      continue;
+    }
+    text += QString(" %1 %2/%3/%4")
+                .arg(QString::fromUtf8(stage.name))
+                .arg(summary.p50Us / 1000.0, 0, 'f', 2)
+                .arg(summary.p99Us / 1000.0, 0, 'f', 2)
+                .arg(summary.maxUs / 1000.0, 0, 'f', 2);
+  }
+  m_latencyText =
+      text.isEmpty() ? QString() : " | Задержка, мс p50/p99/max:" + text;
+}
+
 void StatusBarManager::updateFilterStats() {
   if (!m_dataProcessor) {
     return;
@@ -151,14 +208,15 @@ void StatusBarManager::updateFilterStats() {
 }
 
 void StatusBarManager::updateFilterMemory() {
-  // оценка потребления памяти фильтрами + их буферами
+  // оценка потребления памяти фильтрами + их выходными буферами. входы
+  // фильтров - курсоры общего журнала сырых данных, своей памяти у них нет
 
   // moving average
   if (m_movingAvgMemoryLabel && m_movingAvgFilter && m_rawBufferMovingAvg &&
       m_movingAvgBuffer) {
     size_t bytes = m_movingAvgFilter->getMemoryUsage();
-    bytes += m_rawBufferMovingAvg->capacity() * sizeof(DataPoint);
-    bytes += m_movingAvgBuffer->capacity() * sizeof(DataPoint);
+    bytes += m_movingAvgBuffer->capacity() *
+             (sizeof(DataPoint) + sizeof(SampleStamp));
     m_movingAvgMemoryLabel->setText(QString("Память: %1").arg(formatKb(bytes)));
   }
 
@@ -166,8 +224,8 @@ void StatusBarManager::updateFilterMemory() {
   if (m_medianMemoryLabel && m_medianFilter && m_rawBufferMedian &&
       m_medianBuffer) {
     size_t bytes = m_medianFilter->getMemoryUsage();
-    bytes += m_rawBufferMedian->capacity() * sizeof(DataPoint);
-    bytes += m_medianBuffer->capacity() * sizeof(DataPoint);
+    bytes += m_medianBuffer->capacity() *
+             (sizeof(DataPoint) + sizeof(SampleStamp));
     m_medianMemoryLabel->setText(QString("Память: %1").arg(formatKb(bytes)));
   }
 
@@ -175,8 +233,8 @@ void StatusBarManager::updateFilterMemory() {
   if (m_exponentialMemoryLabel && m_exponentialFilter &&
       m_rawBufferExponential && m_exponentialBuffer) {
     size_t bytes = m_exponentialFilter->getMemoryUsage();
-    bytes += m_rawBufferExponential->capacity() * sizeof(DataPoint);
-    bytes += m_exponentialBuffer->capacity() * sizeof(DataPoint);
+    bytes += m_exponentialBuffer->capacity() *
+             (sizeof(DataPoint) + sizeof(SampleStamp));
     m_exponentialMemoryLabel->setText(
         QString("Память: %1").arg(formatKb(bytes)));
   }
@@ -185,8 +243,8 @@ void StatusBarManager::updateFilterMemory() {
   if (m_kalmanMemoryLabel && m_kalmanFilter && m_rawBufferKalman &&
       m_kalmanBuffer) {
     size_t bytes = m_kalmanFilter->getMemoryUsage();
-    bytes += m_rawBufferKalman->capacity() * sizeof(DataPoint);
-    bytes += m_kalmanBuffer->capacity() * sizeof(DataPoint);
+    bytes += m_kalmanBuffer->capacity() *
+             (sizeof(DataPoint) + sizeof(SampleStamp));
     m_kalmanMemoryLabel->setText(QString("Память: %1").arg(formatKb(bytes)));
   }
 }